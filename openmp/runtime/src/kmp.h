@@ -324,6 +324,7 @@ enum dynamic_mode {
 #endif /* USE_LOAD_BALANCE */
   dynamic_random,
   dynamic_thread_limit,
+  dynamic_thread_budget,
   dynamic_max
 };
 
@@ -1188,6 +1189,7 @@ extern kmp_uint64 __kmp_ticks_per_msec;
 #define KMP_NOW_MSEC() (KMP_NOW() / __kmp_ticks_per_msec)
 #define KMP_BLOCKTIME_INTERVAL(team, tid)                                      \
   (KMP_BLOCKTIME(team, tid) * __kmp_ticks_per_msec)
+#define KMP_NOW_TO_USEC(t) ((t) * 1000 / __kmp_ticks_per_msec)
 #define KMP_BLOCKING(goal, count) ((goal) > KMP_NOW())
 #else
 // System time is retrieved sporadically while blocking.
@@ -1196,6 +1198,7 @@ extern kmp_uint64 __kmp_now_nsec();
 #define KMP_NOW_MSEC() (KMP_NOW() / KMP_USEC_PER_SEC)
 #define KMP_BLOCKTIME_INTERVAL(team, tid)                                      \
   (KMP_BLOCKTIME(team, tid) * KMP_USEC_PER_SEC)
+#define KMP_NOW_TO_USEC(t) ((t) / 1000)
 #define KMP_BLOCKING(goal, count) ((count) % 1000 != 0 || (goal) > KMP_NOW())
 #endif
 #endif // KMP_USE_MONITOR
@@ -1212,6 +1215,8 @@ extern kmp_uint64 __kmp_now_nsec();
 #define KMP_MAX_CHUNK (INT_MAX - 1)
 #define KMP_DEFAULT_CHUNK 1
 
+#define KMP_MAX_DYNAMIC_BATCH 1024
+
 #define KMP_MIN_DISP_NUM_BUFF 1
 #define KMP_DFLT_DISP_NUM_BUFF 7
 #define KMP_MAX_DISP_NUM_BUFF 4096
@@ -1295,7 +1300,8 @@ typedef struct kmp_cpuinfo_flags_t {
   unsigned sse2 : 1; // 0 if SSE2 instructions are not supported, 1 otherwise.
   unsigned rtm : 1; // 0 if RTM instructions are not supported, 1 otherwise.
   unsigned hybrid : 1;
-  unsigned reserved : 29; // Ensure size of 32 bits
+  unsigned cmpxchg16b : 1; // 1 if CMPXCHG16B instruction is supported.
+  unsigned reserved : 28; // Ensure size of 32 bits
 } kmp_cpuinfo_flags_t;
 
 typedef struct kmp_cpuinfo {
@@ -1941,6 +1947,11 @@ typedef struct dispatch_shared_info64 {
   kmp_int64 ordered_dummy[KMP_MAX_ORDERED - 3];
 } dispatch_shared_info64_t;
 
+// Slot of an ordered loop ticket, alone in its cache line
+typedef struct KMP_ALIGN_CACHE kmp_ordered_slot {
+  volatile kmp_uint64 ticket; // last iteration handed over through this slot
+} kmp_ordered_slot_t;
+
 typedef struct dispatch_shared_info {
   union shared_info {
     dispatch_shared_info32_t s32;
@@ -1950,6 +1961,16 @@ typedef struct dispatch_shared_info {
   volatile kmp_int32 doacross_buf_idx; // teamwise index
   volatile kmp_uint32 *doacross_flags; // shared array of iteration flags (0/1)
   kmp_int32 doacross_num_done; // count finished threads
+  // learning auto schedule: candidate schedule used + 1 (0 if not learning),
+  // sum and maximum of the threads' loop times, sum of their chunk counts
+  volatile kmp_int32 auto_arm;
+  volatile kmp_int64 auto_time_sum;
+  volatile kmp_int64 auto_time_max;
+  volatile kmp_int64 auto_chunks;
+  // ordered tickets: the thread waiting for ordered iteration i spins on slot
+  // (i & ordered_slots_mask) instead of on the shared ordered_iteration
+  kmp_ordered_slot_t *ordered_slots;
+  kmp_uint32 ordered_slots_mask;
 #if KMP_USE_HIER_SCHED
   void *hier;
 #endif
@@ -1975,6 +1996,9 @@ typedef struct kmp_disp {
   kmp_int32 th_doacross_buf_idx; // thread's doacross buffer index
   volatile kmp_uint32 *th_doacross_flags; // pointer to shared array of flags
   kmp_int64 *th_doacross_info; // info on loop bounds
+  void *th_auto_entry; // learning auto schedule: entry of the current loop
+  double th_auto_start; // learning auto schedule: current loop start time
+  kmp_int64 th_auto_chunks; // learning auto schedule: chunks taken so far
 #if KMP_USE_INTERNODE_ALIGNMENT
   char more_padding[INTERNODE_CACHE_LINE];
 #endif
@@ -2048,6 +2072,10 @@ typedef enum kmp_bar_pat { /* Barrier communication patterns */
                                                 branching factor 2^n */
                            bp_hierarchical_bar = 3, /* Machine hierarchy tree */
                            bp_dist_bar = 4, /* Distributed barrier */
+                           bp_dissem_bar = 5, /* Dissemination barrier, all
+                                                 threads leave together */
+                           bp_tournament_bar = 6, /* Static tournament */
+                           bp_auto_bar = 7, /* Timed choice among the above */
                            bp_last_bar /* Placeholder to mark the end */
 } kmp_bar_pat_e;
 
@@ -2123,12 +2151,41 @@ union KMP_ALIGN_CACHE kmp_barrier_union {
 
 typedef union kmp_barrier_union kmp_balign_t;
 
+/* Per-round flag of the dissemination and tournament barriers. The flags of
+   a team are indexed by [tid][parity of the barrier][round], each one on its
+   own cache line, and only the thread owning the slot spins on it. */
+typedef struct KMP_ALIGN_CACHE kmp_bar_round {
+  volatile kmp_uint64 flag; // bumped by the partner thread of the round
+  kmp_uint64 seen; // value of flag the owner waited for last time
+  kmp_uint32 need_release; // dissemination: a thread needs the release phase
+} kmp_bar_round_t;
+
+/* Auto pattern state of a team for one barrier type. The first barriers of
+   each team size time the candidate patterns in turn, then the fastest one is
+   locked in. b_cand and b_nproc are read by all threads entering the barrier,
+   they are only written by the primary thread before it releases the team.
+   The rest is private to the primary thread. */
+typedef struct kmp_bar_auto {
+  kmp_uint32 b_cand; // candidate in use, KMP_BAR_AUTO_LOCKED once chosen
+  kmp_uint32 b_nproc; // team size b_cand was chosen for
+  kmp_uint32 b_samples; // barriers released with the candidate
+  kmp_uint32 b_best; // fastest candidate so far
+  kmp_uint64 b_best_ticks; // cost of b_best
+  kmp_uint64 b_gather_ticks; // fastest gather of the candidate
+  kmp_uint64 b_release_ticks; // fastest release of the candidate
+} kmp_bar_auto_t;
+
+#define KMP_BAR_AUTO_LOCKED 0x80000000
+
 /* Team barrier needs only non-volatile arrived counter */
 union KMP_ALIGN_CACHE kmp_barrier_team_union {
   double b_align; /* use worst case alignment */
   char b_pad[CACHE_LINE];
   struct {
     kmp_uint64 b_arrived; /* STATE => task reached synch point. */
+    kmp_bar_round_t *b_rounds; /* flags of dissemination/tournament barriers */
+    kmp_uint32 b_nrounds; /* rounds per thread and parity in b_rounds */
+    kmp_bar_auto_t b_auto; /* auto pattern selection */
 #if USE_DEBUGGER
     // The following two fields are indended for the debugger solely. Only
     // primary thread of the team accesses these fields: the first one is
@@ -2319,12 +2376,22 @@ extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
 extern int __kmp_enable_task_throttling;
+extern int __kmp_task_deque_lockfree;
+extern int __kmp_task_steal_half;
+extern int __kmp_task_steal_hier;
+extern int __kmp_task_alloc_cache;
+extern int __kmp_task_priority_mq;
+extern int __kmp_task_affinity;
+extern int __kmp_task_mtx_tokens;
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
 // Set via OMP_MAX_TASK_PRIORITY if specified, defaults to 0 otherwise
 extern kmp_int32 __kmp_max_task_priority;
 // Set via KMP_TASKLOOP_MIN_TASKS if specified, defaults to 0 otherwise
 extern kmp_uint64 __kmp_taskloop_min_tasks;
+// Set via KMP_TASKLOOP_ADAPTIVE, target duration of taskloop tasks in
+// microseconds (0: grainsize is not adaptive)
+extern kmp_int32 __kmp_taskloop_adaptive;
 
 /* NOTE: kmp_taskdata_t and kmp_task_t structures allocated in single block with
    taskdata first */
@@ -2420,12 +2487,32 @@ struct kmp_depnode_list {
 // Max number of mutexinoutset dependencies per node
 #define MAX_MTX_DEPS 4
 
+// Ownership token of a mutexinoutset set, used instead of a lock if
+// __kmp_task_mtx_tokens is set. A task is queued only once it owns the tokens
+// of all its sets; until then its depnode waits in the FIFO of the first token
+// it could not take, and the owner hands the token over when it completes.
+// The waiters list is only accessed under lock, when the token is contended.
+enum { KMP_MTX_TOKEN_FREE = 0, KMP_MTX_TOKEN_OWNED, KMP_MTX_TOKEN_CONTENDED };
+typedef struct kmp_mtx_token {
+  std::atomic<kmp_int32> state;
+  kmp_bootstrap_lock_t lock;
+  kmp_depnode_t *head; // waiters, linked through mtx_next_waiter
+  kmp_depnode_t *tail;
+} kmp_mtx_token_t;
+
 typedef struct kmp_base_depnode {
   kmp_depnode_list_t *successors; /* used under lock */
   kmp_task_t *task; /* non-NULL if depnode is active, used under lock */
-  kmp_lock_t *mtx_locks[MAX_MTX_DEPS]; /* lock mutexinoutset dependent tasks */
+  union {
+    kmp_lock_t *mtx_locks[MAX_MTX_DEPS]; /* lock mutexinoutset dependent tasks */
+    kmp_mtx_token_t *mtx_tokens[MAX_MTX_DEPS]; // if __kmp_task_mtx_tokens
+  };
   kmp_int32 mtx_num_locks; /* number of locks in mtx_locks array */
+  kmp_int32 mtx_num_tokens; // number of tokens in mtx_tokens array
+  kmp_int32 mtx_num_owned; // number of those tokens owned by the task
+  kmp_depnode_t *mtx_next_waiter; // next depnode waiting for the same token
   kmp_lock_t lock; /* guards shared fields: task, successors */
+  kmp_int32 tg_index; /* index of the task in a recorded task graph */
 #if KMP_SUPPORT_GRAPH_OUTPUT
   kmp_uint32 id;
 #endif
@@ -2445,19 +2532,91 @@ struct kmp_dephash_entry {
   kmp_depnode_list_t *last_set;
   kmp_depnode_list_t *prev_set;
   kmp_uint8 last_flag;
-  kmp_lock_t *mtx_lock; /* is referenced by depnodes w/mutexinoutset dep */
-  kmp_dephash_entry_t *next_in_bucket;
+  union {
+    kmp_lock_t *mtx_lock; /* is referenced by depnodes w/mutexinoutset dep */
+    kmp_mtx_token_t *mtx_token; // if __kmp_task_mtx_tokens
+  };
 };
 
+typedef struct kmp_dephash_slot {
+  kmp_intptr_t addr;
+  kmp_dephash_entry_t *entry; // NULL if the slot is empty
+} kmp_dephash_slot_t;
+
+// Open-addressing (linear probing) table of dependence entries. When the table
+// is resized, the previous slot array is kept in old_slots and its entries are
+// moved into the new one a few at a time by subsequent lookups; slots below
+// old_next have already been moved.
 typedef struct kmp_dephash {
-  kmp_dephash_entry_t **buckets;
-  size_t size;
+  kmp_dephash_slot_t *slots;
+  size_t size; // power of two
   kmp_depnode_t *last_all;
-  size_t generation;
+  kmp_dephash_slot_t *old_slots;
+  size_t old_size;
+  size_t old_next;
   kmp_uint32 nelements;
-  kmp_uint32 nconflicts;
 } kmp_dephash_t;
 
+// Task graph record and replay (kmp_taskgraph_begin / kmp_taskgraph_end).
+// The first execution of a region records, for every task with dependences,
+// the indices of its predecessors among the tasks of the region. Later
+// executions link each task to the depnodes of its recorded predecessors
+// directly, without dephash lookups.
+typedef struct kmp_taskgraph_node {
+  kmp_uint64 sig; // signature of the dependence list of the task
+  kmp_int32 first_pred; // index of the first predecessor in preds
+  kmp_int32 npreds;
+} kmp_taskgraph_node_t;
+
+typedef enum kmp_taskgraph_status {
+  tgs_empty = 0, // nothing recorded yet, or the recording was discarded
+  tgs_ready, // recorded, can be replayed
+  tgs_disabled // cannot be replayed (e.g. uses mutexinoutset dependences)
+} kmp_taskgraph_status_t;
+
+typedef struct kmp_taskgraph {
+  kmp_int32 id;
+  kmp_taskgraph_status_t status;
+  kmp_int32 busy; // a region is currently executing this graph
+  kmp_int32 ntasks;
+  kmp_int32 max_tasks;
+  kmp_int32 npreds;
+  kmp_int32 max_preds;
+  kmp_taskgraph_node_t *nodes;
+  kmp_int32 *preds;
+  struct kmp_taskgraph *next;
+} kmp_taskgraph_t;
+
+typedef enum kmp_taskgraph_mode {
+  tgm_plain = 0, // neither record nor replay, dependences resolved as usual
+  tgm_record,
+  tgm_replay
+} kmp_taskgraph_mode_t;
+
+typedef struct kmp_taskgraph_region {
+  kmp_taskgraph_t *graph; // NULL if the graph is busy in another region
+  kmp_taskgraph_mode_t mode;
+  kmp_int32 next; // index of the next task with dependences
+  kmp_depnode_t **nodes; // depnodes of the tasks created so far
+  kmp_int32 max_nodes; // record: allocated size of nodes
+  struct kmp_taskgraph_region *outer;
+} kmp_taskgraph_region_t;
+
+// Observed cost of the tasks of a taskloop construct, used to choose its
+// grainsize adaptively (KMP_TASKLOOP_ADAPTIVE). The construct is identified by
+// its task routine and loop stride, since the ident_t may be shared by several
+// constructs. The bounds offsets and the stride let the task executing a chunk
+// compute its iteration count; they are set once, before ready.
+typedef struct kmp_taskloop_stats {
+  std::atomic<kmp_routine_entry_t> routine; // NULL if the slot is free
+  kmp_int64 st;
+  size_t lower_offset;
+  size_t upper_offset;
+  std::atomic<kmp_int32> ready; // st and the offsets are set
+  std::atomic<kmp_uint64> iters; // Iterations executed by the measured tasks
+  std::atomic<kmp_uint64> nsec; // Time spent executing them
+} kmp_taskloop_stats_t;
+
 typedef struct kmp_task_affinity_info {
   kmp_intptr_t base_addr;
   size_t len;
@@ -2563,6 +2722,11 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
       *td_dephash; // Dependencies for children tasks are tracked from here
   kmp_depnode_t
       *td_depnode; // Pointer to graph node if this task has dependencies
+  kmp_taskgraph_region_t
+      *td_taskgraph; // Innermost task graph region of the task, if any
+  kmp_taskloop_stats_t
+      *td_taskloop_stats; // Set if the task is an adaptive taskloop chunk
+  kmp_int32 td_numa_node; // NUMA node of the task's affinity data, or -1
   kmp_task_team_t *td_task_team;
   size_t td_size_alloc; // Size of task structure, including shareds etc.
 #if defined(KMP_GOMP_COMPAT)
@@ -2584,6 +2748,24 @@ struct kmp_taskdata { /* aligned during dynamic allocation       */
 // Make sure padding above worked
 KMP_BUILD_ASSERT(sizeof(kmp_taskdata_t) % sizeof(void *) == 0);
 
+// Array backing the lock-free (Chase-Lev) task deque. Indices into tasks are
+// taken modulo size, which is always a power of two. Arrays replaced on growth
+// are chained through prev and freed together with the deque, since thieves
+// may still be reading from them.
+typedef struct kmp_task_deque_array {
+  kmp_int64 size;
+  struct kmp_task_deque_array *prev;
+  std::atomic<kmp_taskdata_t *> *tasks;
+} kmp_task_deque_array_t;
+
+// Entry of a per-thread priority task heap. seq is the push order, used to
+// keep tasks of equal priority in FIFO order.
+typedef struct kmp_task_pri_entry {
+  kmp_taskdata_t *task;
+  kmp_int32 priority;
+  kmp_uint32 seq;
+} kmp_task_pri_entry_t;
+
 // Data for task team but per thread
 typedef struct kmp_base_thread_data {
   kmp_info_p *td_thr; // Pointer back to thread info
@@ -2598,6 +2780,24 @@ typedef struct kmp_base_thread_data {
   kmp_int32 td_deque_ntasks; // Number of tasks in deque
   // GEH: shouldn't this be volatile since used in while-spin?
   kmp_int32 td_deque_last_stolen; // Thread number of last successful steal
+  // Locality level and number of failed attempts at it, for hierarchical
+  // victim selection (KMP_TASK_STEAL_HIER)
+  kmp_int32 td_steal_level;
+  kmp_int32 td_steal_attempts;
+  // Lock-free deque of the owner's own tasks, used if __kmp_task_deque_lockfree
+  // is set. td_deque then only receives tasks given by other threads.
+  std::atomic<kmp_task_deque_array_t *> td_cl_array;
+  std::atomic<kmp_int64> td_cl_bottom; // Written by the owner only
+  KMP_ALIGN_CACHE std::atomic<kmp_int64> td_cl_top; // Thieves CAS here
+  // Binary max-heap of the priority tasks pushed by the owner, used if
+  // __kmp_task_priority_mq is set. td_pri_top is the highest priority queued
+  // (0 if empty) so that other threads can choose a heap without locking it.
+  KMP_ALIGN_CACHE kmp_bootstrap_lock_t td_pri_lock;
+  kmp_task_pri_entry_t *td_pri_heap;
+  kmp_int32 td_pri_heap_size;
+  kmp_int32 td_pri_ntasks;
+  kmp_uint32 td_pri_seq;
+  std::atomic<kmp_int32> td_pri_top;
 #ifdef BUILD_TIED_TASK_STACK
   kmp_task_stack_t td_susp_tied_tasks; // Stack of suspended tied tasks for task
 // scheduling constraint
@@ -2610,6 +2810,10 @@ typedef struct kmp_base_thread_data {
 #define TASK_DEQUE_SIZE(td) ((td).td_deque_size)
 #define TASK_DEQUE_MASK(td) ((td).td_deque_size - 1)
 
+// Locality levels tried in turn by hierarchical victim selection before any
+// other thread: threads sharing a core or L2 cache, then an LLC or NUMA node
+#define KMP_TASK_STEAL_LOCAL_LEVELS 2
+
 typedef union KMP_ALIGN_CACHE kmp_thread_data {
   kmp_base_thread_data_t td;
   double td_align; /* use worst case alignment */
@@ -2647,6 +2851,9 @@ typedef struct kmp_base_task_team {
   // There is hidden helper thread encountered in this task team so that we must
   // wait when waiting on task team
   kmp_int32 tt_hidden_helper_task_encountered;
+  // Locality ids of the threads for hierarchical victim selection, in
+  // KMP_TASK_STEAL_LOCAL_LEVELS consecutive entries per thread
+  kmp_int32 *tt_steal_locality;
 
   KMP_ALIGN_CACHE
   std::atomic<kmp_int32> tt_unfinished_threads; /* #threads still active */
@@ -2673,6 +2880,35 @@ typedef struct kmp_free_list {
   // sync list)
 } kmp_free_list_t;
 #endif
+
+// Task descriptor cache: per-thread size-classed free lists of task descriptor
+// blocks (kmp_taskdata_t + kmp_task_t + shareds) carved from cache-aligned
+// slabs. Class c holds blocks of (c + 1) cache lines.
+#define KMP_TASK_CACHE_NUM_CLASSES 16
+#define KMP_TASK_CACHE_MAX_SIZE (KMP_TASK_CACHE_NUM_CLASSES * CACHE_LINE)
+#define KMP_TASK_CACHE_SLAB_SIZE (16 * 1024)
+// Number of remotely freed blocks collected before returning them to the owner
+#define KMP_TASK_CACHE_BATCH 32
+
+typedef struct kmp_task_cache_class {
+  void *tc_free; // Owner-only LIFO of free blocks
+  void *tc_slabs; // Slabs allocated for this class, freed with the thread
+  char *tc_carve; // Next uncarved block in the newest slab
+  kmp_int32 tc_ncarve; // Number of uncarved blocks left in the newest slab
+  kmp_int32 tc_nremote; // Length of the tc_remote batch
+  void *tc_remote; // Batch of blocks freed here but owned by tc_remote_owner
+  void *tc_remote_tail;
+  struct kmp_task_cache *tc_remote_owner;
+  // Batches of own blocks returned by other threads
+  KMP_ALIGN_CACHE std::atomic<void *> tc_returned;
+} kmp_task_cache_class_t;
+
+typedef struct kmp_task_cache {
+  kmp_task_cache_class_t tc_classes[KMP_TASK_CACHE_NUM_CLASSES];
+  // One reference held by the owner thread and one per pending batch of other
+  // threads naming this cache; the last one frees the cache and its slabs
+  std::atomic<kmp_int32> tc_refs;
+} kmp_task_cache_t;
 #if KMP_NESTED_HOT_TEAMS
 // Hot teams array keeps hot teams and their sizes for given thread. Hot teams
 // are not put in teams pool, and they don't put threads in threads pool.
@@ -2719,6 +2955,8 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   kmp_info_p *th_next_pool; /* next available thread in the pool */
   kmp_disp_t *th_dispatch; /* thread's dispatch data */
   int th_in_pool; /* in thread pool (32 bits for TCR/TCW) */
+  int th_reaped; /* OS thread reaped, kept in the pool (32 bits for TCR/TCW) */
+  double th_pool_time; /* when the thread was put in the thread pool */
 
   /* The following are cached from the team info structure */
   /* TODO use these in more places as determined to be needed via profiling */
@@ -2738,6 +2976,9 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   int th_team_bt_set;
 #else
   kmp_uint64 th_team_bt_intervals;
+  /* KMP_ADAPTIVE_BLOCKTIME: recent wait times of the thread, in KMP_NOW()
+     units, at barriers [0] and between parallel regions [1] */
+  kmp_uint64 th_bt_wait[2];
 #endif
 
 #if KMP_AFFINITY_SUPPORTED
@@ -2762,6 +3003,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   int th_first_place; /* first place in partition */
   int th_last_place; /* last place in partition */
 #endif
+  int th_numa_node; // NUMA node the thread runs on if KMP_TASK_AFFINITY, or -1
   int th_prev_level; /* previous level for affinity format */
   int th_prev_num_threads; /* previous num_threads for affinity format */
 #if USE_ITT_BUILD
@@ -2809,6 +3051,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   /* More stuff for keeping track of active/sleeping threads (this part is
      written by the worker thread) */
   kmp_uint8 th_active_in_pool; // included in count of #active threads in pool
+  kmp_uint8 th_split_arrived; // in a kmp_barrier_arrive/kmp_barrier_wait pair
   int th_active; // ! sleeping; 32 bits for TCR/TCW
   std::atomic<kmp_uint32> th_used_in_team; // Flag indicating use in team
   // 0 = not used in team; 1 = used in team;
@@ -2830,6 +3073,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   kmp_free_list_t th_free_lists[NUM_LISTS]; // Free lists for fast memory
 // allocation routines
 #endif
+  kmp_task_cache_t *th_task_cache; // Task descriptor cache, allocated lazily
 
 #if KMP_OS_WINDOWS
   kmp_win32_cond_t th_suspend_cv;
@@ -2840,6 +3084,9 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   kmp_cond_align_t th_suspend_cv;
   kmp_mutex_align_t th_suspend_mx;
   std::atomic<int> th_suspend_init_count;
+#if KMP_USE_FUTEX
+  std::atomic<kmp_int32> th_suspend_futex; // 1 while suspended on the futex
+#endif
 #endif
 
 #if USE_ITT_BUILD
@@ -2917,10 +3164,21 @@ typedef struct KMP_ALIGN_CACHE kmp_base_team {
   KMP_ALIGN_CACHE int t_master_tid; // tid of primary thread in parent team
   int t_master_this_cons; // "this_construct" single counter of primary thread
   // in parent team
+  kmp_uint8 t_primary_task_state; // task state of the primary thread at join,
+  // restored when the team is reused as a nested hot team
+  int t_budget_nth; // threads charged to the thread budget by this team
   ident_t *t_ident; // if volatile, have to change too much other crud to
   // volatile too
   kmp_team_p *t_parent; // parent team
   kmp_team_p *t_next_pool; // next free team in the team pool
+#if KMP_NESTED_HOT_TEAMS
+  // LRU list of the nested hot teams kept under KMP_HOT_TEAMS_MAX_THREADS
+  kmp_team_p *t_hot_prev; // more recently used nested hot team
+  kmp_team_p *t_hot_next; // less recently used nested hot team
+  kmp_info_p *t_hot_owner; // primary thread keeping the team, NULL if unlisted
+  int t_hot_level; // index of the team in t_hot_owner->th.th_hot_teams
+  int t_hot_busy; // the team is running a parallel region
+#endif
   kmp_disp_t *t_dispatch; // thread's dispatch data
   kmp_task_team_t *t_task_team[2]; // Task team struct; switch between 2
   kmp_proc_bind_t t_proc_bind; // bind type for par region
@@ -3164,6 +3422,7 @@ extern char const *__kmp_barrier_branch_bit_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_env_name[bs_last_barrier];
 extern char const *__kmp_barrier_type_name[bs_last_barrier];
 extern char const *__kmp_barrier_pattern_name[bp_last_bar];
+extern int __kmp_barrier_auto_samples; /* barriers timed per auto candidate */
 
 /* Global Locks */
 extern kmp_bootstrap_lock_t __kmp_initz_lock; /* control initialization */
@@ -3191,6 +3450,10 @@ extern enum sched_type __kmp_guided; /* default guided scheduling method */
 extern enum sched_type __kmp_auto; /* default auto scheduling method */
 extern int __kmp_chunk; /* default runtime chunk size */
 extern int __kmp_force_monotonic; /* whether monotonic scheduling forced */
+extern int __kmp_auto_learn; /* whether auto schedule learns per loop */
+extern int __kmp_auto_learn_report; /* report the learned auto schedules */
+extern int __kmp_dynamic_batch; /* max chunks claimed at once by dynamic */
+extern int __kmp_ordered_tickets; /* ordered waits on per-thread ticket slots */
 
 extern size_t __kmp_stksize; /* stack size per thread         */
 #if KMP_USE_MONITOR
@@ -3225,6 +3488,9 @@ extern size_t __kmp_align_alloc;
 /* following data protected by initialization routines */
 extern int __kmp_xproc; /* number of processors in the system */
 extern int __kmp_avail_proc; /* number of processors available to the process */
+/* max number of threads in active parallel regions of all roots together with
+   KMP_DYNAMIC_MODE=thread_budget (0: __kmp_avail_proc) */
+extern int __kmp_thread_budget;
 extern size_t __kmp_sys_min_stksize; /* system-defined minimum stack size */
 extern int __kmp_sys_max_nth; /* system-imposed maximum number of threads */
 // maximum total number of concurrently-existing threads on device
@@ -3245,6 +3511,13 @@ extern int __kmp_tp_cached; /* whether threadprivate cache has been created
 extern int __kmp_dflt_blocktime; /* number of milliseconds to wait before
                                     blocking (env setting) */
 extern bool __kmp_wpolicy_passive; /* explicitly set passive wait policy */
+#if !KMP_USE_MONITOR
+extern int __kmp_adaptive_blocktime; /* skip the spin before an expected long
+                                        wait (KMP_ADAPTIVE_BLOCKTIME) */
+#endif
+#if KMP_USE_FUTEX
+extern int __kmp_futex_suspend; /* suspend threads on a futex, not a condvar */
+#endif
 #if KMP_USE_MONITOR
 extern int
     __kmp_monitor_wakeups; /* number of times monitor wakes up per second */
@@ -3294,7 +3567,14 @@ extern int __kmp_dispatch_num_buffers; /* max possible dynamic loops in
 #if KMP_NESTED_HOT_TEAMS
 extern int __kmp_hot_teams_mode;
 extern int __kmp_hot_teams_max_level;
+extern int __kmp_hot_teams_max_threads; /* cap on the workers parked in nested
+                                           hot teams, 0 - no cap */
+extern kmp_team_t *__kmp_hot_teams_lru; /* most recently used nested hot team */
+extern kmp_team_t *__kmp_hot_teams_lru_tail; /* least recently used one */
 #endif
+extern int __kmp_hot_teams_fast_fork; /* fork and join the outermost hot team
+                                         without the generic fork logic and
+                                         the global lock when possible */
 
 #if KMP_OS_LINUX
 extern enum clock_function_type __kmp_clock_function;
@@ -3354,6 +3634,10 @@ extern kmp_old_threads_list_t *__kmp_old_threads_list;
 extern volatile kmp_team_t *__kmp_team_pool;
 extern volatile kmp_info_t *__kmp_thread_pool;
 extern kmp_info_t *__kmp_thread_pool_insert_pt;
+extern int __kmp_pool_thread_timeout; /* msec after which idle threads in the
+                                         thread pool are reaped, 0 - never */
+extern std::atomic<double> __kmp_pool_reap_time; /* when the next thread in
+   the pool times out, 0 - none; written under __kmp_forkjoin_lock */
 
 // total num threads reachable from some root thread including all root threads
 extern volatile int __kmp_nth;
@@ -3361,6 +3645,8 @@ extern volatile int __kmp_nth;
    threads, and those in the thread pool */
 extern volatile int __kmp_all_nth;
 extern std::atomic<int> __kmp_thread_pool_active_nth;
+/* number of threads in active parallel regions, for the thread budget */
+extern std::atomic<int> __kmp_thread_budget_nth;
 
 extern kmp_root_t **__kmp_root; /* root of thread hierarchy */
 /* end data protected by fork/join lock */
@@ -3433,6 +3719,12 @@ extern int __kmp_tpause_enabled; // 0 (default), 1 (KMP_TPAUSE is non-zero)
 
 extern kmp_global_t __kmp_global; /* global status */
 
+/* Whether a worker released from the fork barrier has to leave it and exit:
+   at library shutdown, or when it was reaped from the thread pool. */
+static inline bool __kmp_worker_exiting(kmp_info_t *thr) {
+  return TCR_4(__kmp_global.g.g_done) || TCR_4(thr->th.th_reaped);
+}
+
 extern kmp_info_t __kmp_monitor;
 // For Debugging Support Library
 extern std::atomic<kmp_int32> __kmp_team_counter;
@@ -3533,6 +3825,12 @@ extern void __kmp_initialize_fast_memory(kmp_info_t *this_thr);
   ___kmp_fast_free((this_thr), (ptr)KMP_SRC_LOC_CURR)
 #endif
 
+extern void *__kmp_task_cache_allocate(kmp_info_t *this_thr, size_t size);
+extern void __kmp_task_cache_free(kmp_info_t *this_thr, void *ptr, size_t size,
+                                  kmp_info_t *alloc_thr);
+extern void __kmp_task_cache_release(kmp_info_t *this_thr);
+extern void __kmp_trim_thread_memory(kmp_info_t *th);
+
 extern void *___kmp_thread_malloc(kmp_info_t *th, size_t size KMP_SRC_LOC_DECL);
 extern void *___kmp_thread_calloc(kmp_info_t *th, size_t nelem,
                                   size_t elsize KMP_SRC_LOC_DECL);
@@ -3674,6 +3972,7 @@ extern void __kmp_affinity_uninitialize(void);
 extern void __kmp_affinity_set_init_mask(
     int gtid, int isa_root); /* set affinity according to KMP_AFFINITY */
 extern void __kmp_affinity_set_place(int gtid);
+extern int __kmp_affinity_get_locality_id(kmp_info_t *th, kmp_hw_t type);
 extern void __kmp_affinity_determine_capable(const char *env_var);
 extern int __kmp_aux_set_affinity(void **mask);
 extern int __kmp_aux_get_affinity(void **mask);
@@ -3805,6 +4104,10 @@ extern int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
                          size_t reduce_size, void *reduce_data,
                          void (*reduce)(void *, void *));
 extern void __kmp_end_split_barrier(enum barrier_type bt, int gtid);
+extern void __kmp_split_barrier_arrive(int gtid);
+extern void __kmp_split_barrier_wait(int gtid);
+extern void __kmp_barrier_alloc_rounds(kmp_team_t *team, int max_nth);
+extern void __kmp_barrier_free_rounds(kmp_team_t *team);
 extern int __kmp_barrier_gomp_cancel(int gtid);
 
 /*!
@@ -3895,9 +4198,15 @@ extern void __kmp_task_team_wait(kmp_info_t *this_thr, kmp_team_t *team
                                  int wait = 1);
 extern void __kmp_tasking_barrier(kmp_team_t *team, kmp_info_t *thread,
                                   int gtid);
+extern int __kmp_taskgraph_begin(int gtid, int graph_id);
+extern void __kmp_taskgraph_end(int gtid);
+extern void __kmp_taskgraph_cleanup(void);
 
 extern int __kmp_is_address_mapped(void *addr);
+extern int __kmp_get_thread_numa_node(void);
+extern int __kmp_get_address_numa_node(void *addr);
 extern kmp_uint64 __kmp_hardware_timestamp(void);
+extern kmp_uint64 __kmp_now_nsec();
 
 #if KMP_OS_UNIX
 extern int __kmp_read_from_file(char const *path, char const *format, ...);
@@ -2773,6 +2773,61 @@ static void __kmp_dispatch_set_hierarchy_values() {
       nCoresPerPkg * __kmp_nThreadsPerCore;
   __kmp_hier_threads_per[kmp_hier_layer_e::LAYER_LOOP + 1] =
       nPackages * nCoresPerPkg * __kmp_nThreadsPerCore;
+  // Use the cache and NUMA levels of the detected topology when it has them
+  if (__kmp_topology && __kmp_topology->is_uniform()) {
+    static const kmp_hw_t types[] = {KMP_HW_L1, KMP_HW_L2, KMP_HW_L3,
+                                     KMP_HW_NUMA};
+    int depth = __kmp_topology->get_depth();
+    for (int i = 0; i < (int)(sizeof(types) / sizeof(types[0])); ++i) {
+      int level = __kmp_topology->get_level(types[i]);
+      if (level < 0 && types[i] == KMP_HW_L3)
+        level = __kmp_topology->get_level(KMP_HW_LLC);
+      if (level < 0)
+        continue;
+      int index = kmp_hier_layer_e::LAYER_L1 + i + 1;
+      __kmp_hier_max_units[index] = __kmp_topology->get_count(level);
+      __kmp_hier_threads_per[index] =
+          __kmp_topology->calculate_ratio(depth - 1, level);
+    }
+    // A NUMA node smaller than the L3 (or an L3 smaller than the L2) cannot
+    // contain the layer below it, so make it the same size instead
+    for (int i = kmp_hier_layer_e::LAYER_L2 + 1;
+         i <= kmp_hier_layer_e::LAYER_NUMA + 1; ++i) {
+      if (__kmp_hier_threads_per[i] < __kmp_hier_threads_per[i - 1]) {
+        __kmp_hier_threads_per[i] = __kmp_hier_threads_per[i - 1];
+        __kmp_hier_max_units[i] = __kmp_hier_max_units[i - 1];
+      }
+    }
+  }
+}
+
+// OMP_SCHEDULE=hierarchical: add a guided layer for each cache or NUMA level
+// shared by several cores.  The threads of a unit take their dynamic chunks
+// from the range their unit got, so most claims stay within a shared cache and
+// only the refills of the units touch the counter of the whole loop.
+static void __kmp_dispatch_set_auto_hierarchy() {
+  // Layers given explicitly with OMP_SCHEDULE="EXPERIMENTAL ..." take priority
+  if (!__kmp_hier_auto || __kmp_hier_scheds.size > 0)
+    return;
+  int below = (__kmp_nThreadsPerCore > 1) ? __kmp_nThreadsPerCore : 1;
+  kmp_int64 chunk = (__kmp_chunk > 0) ? __kmp_chunk : KMP_DEFAULT_CHUNK;
+  for (int i = kmp_hier_layer_e::LAYER_L1; i <= kmp_hier_layer_e::LAYER_NUMA;
+       ++i) {
+    int threads_per = __kmp_hier_threads_per[i + 1];
+    if (threads_per <= below || __kmp_hier_max_units[i + 1] <= 1)
+      continue;
+    // Give every thread of the unit at least one chunk per refill
+    kmp_int64 layer_chunk = chunk * threads_per;
+    if (layer_chunk > KMP_MAX_CHUNK)
+      layer_chunk = KMP_MAX_CHUNK;
+    KA_TRACE(10, ("__kmp_dispatch_set_auto_hierarchy: layer %s: %d units of "
+                  "%d threads, chunk %d\n",
+                  __kmp_get_hier_str((kmp_hier_layer_e)i),
+                  __kmp_hier_max_units[i + 1], threads_per, (int)layer_chunk));
+    __kmp_hier_scheds.append(kmp_sch_guided_chunked, (kmp_int32)layer_chunk,
+                             (kmp_hier_layer_e)i);
+    below = threads_per;
+  }
 }
 
 // Return the index into the hierarchy for this tid and layer type (L1, L2, etc)
@@ -4438,14 +4493,19 @@ static void __kmp_aux_affinity_initialize(kmp_affinity_t &affinity) {
     }
   }
 
+#if KMP_USE_HIER_SCHED
+  // The scheduling hierarchy follows the machine whatever the affinity type
+  if (is_regular_affinity) {
+    __kmp_dispatch_set_hierarchy_values();
+    __kmp_dispatch_set_auto_hierarchy();
+  }
+#endif
+
   // If KMP_AFFINITY=none, then only create the single "none" place
   // which is the process's initial affinity mask or the number of
   // hardware threads depending on respect,norespect
   if (affinity.type == affinity_none) {
     __kmp_create_affinity_none_places(affinity);
-#if KMP_USE_HIER_SCHED
-    __kmp_dispatch_set_hierarchy_values();
-#endif
     affinity.flags.initialized = TRUE;
     return;
   }
@@ -4822,6 +4882,33 @@ void __kmp_affinity_set_init_mask(int gtid, int isa_root) {
     __kmp_set_system_affinity(th->th.th_affin_mask, TRUE);
 }
 
+// Returns an id, unique across the machine, of the topology unit of the given
+// type (or of its equivalent in the detected topology) the thread is placed in.
+// Returns -1 if that is unknown, or if the thread's place spans several units.
+// The place the thread is about to bind to is used, so that the primary thread
+// can compute the id for the workers of a team before they bind themselves.
+int __kmp_affinity_get_locality_id(kmp_info_t *th, kmp_hw_t type) {
+  if (!KMP_AFFINITY_CAPABLE() || __kmp_topology == NULL)
+    return -1;
+  int level = __kmp_topology->get_level(type);
+  if (level < 0)
+    return -1;
+  const kmp_affinity_ids_t *ids = &th->th.th_topology_ids;
+  int place = KMP_AFFINITY_NON_PROC_BIND ? th->th.th_current_place
+                                         : th->th.th_new_place;
+  if (__kmp_affinity.ids && place >= 0 &&
+      (unsigned)place < __kmp_affinity.num_masks)
+    ids = &__kmp_affinity.ids[place];
+  int id = 0;
+  for (int i = 0; i <= level; ++i) {
+    int sub_id = (*ids)[__kmp_topology->get_type(i)];
+    if (sub_id < 0) // UNKNOWN_ID or MULTIPLE_ID
+      return -1;
+    id = id * __kmp_topology->get_ratio(i) + sub_id;
+  }
+  return id;
+}
+
 void __kmp_affinity_set_place(int gtid) {
   // Hidden helper threads should not be affected by OMP_PLACES/OMP_PROC_BIND
   if (!KMP_AFFINITY_CAPABLE() || KMP_HIDDEN_HELPER_THREAD(gtid)) {
@@ -12,6 +12,7 @@
 
 #include "kmp.h"
 #include "kmp_io.h"
+#include "kmp_stats.h"
 #include "kmp_wrapper_malloc.h"
 
 // Disable bget when it is not used
@@ -998,16 +999,11 @@ void __kmp_initialize_bget(kmp_info_t *th) {
         (bufsize)__kmp_malloc_pool_incr);
 }
 
-void __kmp_finalize_bget(kmp_info_t *th) {
-  thr_data_t *thr;
-  bfhead_t *b;
-
-  KMP_DEBUG_ASSERT(th != 0);
-
+// Release the last pool block of a thread if it is entirely free; brel()
+// keeps it around instead of giving it back to the system.
+static void __kmp_bget_release_last_pool(thr_data_t *thr) {
 #if BufStats
-  thr = (thr_data_t *)th->th.th_local.bget_data;
-  KMP_DEBUG_ASSERT(thr != NULL);
-  b = thr->last_pool;
+  bfhead_t *b = thr->last_pool;
 
   /*  If a block-release function is defined, and this free buffer constitutes
       the entire block, release it. Note that pool_len is defined in such a way
@@ -1030,8 +1026,16 @@ void __kmp_finalize_bget(kmp_info_t *th) {
     thr->numprel++; /* Nr of expansion block releases */
     thr->numpblk--; /* Total number of blocks */
     KMP_DEBUG_ASSERT(thr->numpblk == thr->numpget - thr->numprel);
+    thr->last_pool = 0;
   }
 #endif /* BufStats */
+}
+
+void __kmp_finalize_bget(kmp_info_t *th) {
+  KMP_DEBUG_ASSERT(th != 0);
+  KMP_DEBUG_ASSERT(th->th.th_local.bget_data != NULL);
+
+  __kmp_bget_release_last_pool((thr_data_t *)th->th.th_local.bget_data);
 
   /* Deallocate bget_data */
   if (th->th.th_local.bget_data != NULL) {
@@ -2067,6 +2071,42 @@ void ___kmp_free(void *ptr KMP_SRC_LOC_DECL) {
 // Always use 128 bytes for determining buckets for caching memory blocks
 #define DCACHE_LINE 128
 
+// Return a list of blocks freed by a thread other than the allocating one to
+// the sync free list of the allocating thread.
+static void __kmp_fast_return_list(void *head, int index) {
+  kmp_mem_descr_t *dsc =
+      (kmp_mem_descr_t *)((char *)head - sizeof(kmp_mem_descr_t));
+  // allocating thread, same for all queue nodes
+  kmp_info_t *q_th = (kmp_info_t *)(dsc->ptr_aligned);
+  void *old_ptr;
+  void *tail = head;
+  void *next = *((void **)head);
+  while (next != NULL) {
+    KMP_DEBUG_ASSERT(
+        // queue size should decrease by 1 each step through the list
+        ((kmp_mem_descr_t *)((char *)next - sizeof(kmp_mem_descr_t)))
+                ->size_allocated +
+            1 ==
+        ((kmp_mem_descr_t *)((char *)tail - sizeof(kmp_mem_descr_t)))
+            ->size_allocated);
+    tail = next; // remember tail node
+    next = *((void **)next);
+  }
+  KMP_DEBUG_ASSERT(q_th != NULL);
+  // push block to owner's sync free list
+  old_ptr = TCR_PTR(q_th->th.th_free_lists[index].th_free_list_sync);
+  /* the next pointer must be set before setting free_list to ptr to avoid
+     exposing a broken list to other threads, even for an instant. */
+  *((void **)tail) = old_ptr;
+
+  while (!KMP_COMPARE_AND_STORE_PTR(
+      &q_th->th.th_free_lists[index].th_free_list_sync, old_ptr, head)) {
+    KMP_CPU_PAUSE();
+    old_ptr = TCR_PTR(q_th->th.th_free_lists[index].th_free_list_sync);
+    *((void **)tail) = old_ptr;
+  }
+}
+
 void *___kmp_fast_allocate(kmp_info_t *this_thr, size_t size KMP_SRC_LOC_DECL) {
   void *ptr;
   size_t num_lines, idx;
@@ -2217,33 +2257,7 @@ void ___kmp_fast_free(kmp_info_t *this_thr, void *ptr KMP_SRC_LOC_DECL) {
         // either queue blocks owner is changing or size limit exceeded
         // return old queue to allocating thread (q_th) synchronously,
         // and start new list for alloc_thr's tasks
-        void *old_ptr;
-        void *tail = head;
-        void *next = *((void **)head);
-        while (next != NULL) {
-          KMP_DEBUG_ASSERT(
-              // queue size should decrease by 1 each step through the list
-              ((kmp_mem_descr_t *)((char *)next - sizeof(kmp_mem_descr_t)))
-                      ->size_allocated +
-                  1 ==
-              ((kmp_mem_descr_t *)((char *)tail - sizeof(kmp_mem_descr_t)))
-                  ->size_allocated);
-          tail = next; // remember tail node
-          next = *((void **)next);
-        }
-        KMP_DEBUG_ASSERT(q_th != NULL);
-        // push block to owner's sync free list
-        old_ptr = TCR_PTR(q_th->th.th_free_lists[index].th_free_list_sync);
-        /* the next pointer must be set before setting free_list to ptr to avoid
-           exposing a broken list to other threads, even for an instant. */
-        *((void **)tail) = old_ptr;
-
-        while (!KMP_COMPARE_AND_STORE_PTR(
-            &q_th->th.th_free_lists[index].th_free_list_sync, old_ptr, head)) {
-          KMP_CPU_PAUSE();
-          old_ptr = TCR_PTR(q_th->th.th_free_lists[index].th_free_list_sync);
-          *((void **)tail) = old_ptr;
-        }
+        __kmp_fast_return_list(head, index);
 
         // start new list of not-selt tasks
         this_thr->th.th_free_lists[index].th_free_list_other = ptr;
@@ -2316,3 +2330,198 @@ void __kmp_free_fast_memory(kmp_info_t *th) {
 }
 
 #endif // USE_FAST_MEMORY
+
+// Task descriptor cache.
+// Each thread keeps a free list per size class and carves new blocks from
+// cache-aligned slabs, so a descriptor never straddles cache lines with another
+// one. Blocks freed by a thread other than the allocating one are collected in
+// a per-class batch of the freeing thread and handed back to the owner with a
+// single CAS, either when the batch is full or when a block of another owner
+// shows up. The owner takes all returned blocks with a single exchange when its
+// own free list runs dry. A pending batch holds a reference to the owner's
+// cache, so the slabs are released once the owner is reaped and no other
+// thread still has a batch to hand back.
+
+static inline int __kmp_task_cache_class(size_t size) {
+  KMP_DEBUG_ASSERT(size > 0 && size <= KMP_TASK_CACHE_MAX_SIZE);
+  return (int)((size - 1) / CACHE_LINE);
+}
+
+static kmp_task_cache_t *__kmp_task_cache_get(kmp_info_t *this_thr) {
+  kmp_task_cache_t *cache = this_thr->th.th_task_cache;
+  if (UNLIKELY(cache == NULL)) {
+    cache = (kmp_task_cache_t *)__kmp_allocate(sizeof(kmp_task_cache_t));
+    for (int c = 0; c < KMP_TASK_CACHE_NUM_CLASSES; ++c)
+      cache->tc_classes[c].tc_returned.store(nullptr,
+                                             std::memory_order_relaxed);
+    cache->tc_refs.store(1, std::memory_order_relaxed);
+    this_thr->th.th_task_cache = cache;
+  }
+  return cache;
+}
+
+// Drop a reference to a task descriptor cache, freeing it with the last one
+static void __kmp_task_cache_unref(kmp_task_cache_t *cache) {
+  if (cache->tc_refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return;
+  for (int c = 0; c < KMP_TASK_CACHE_NUM_CLASSES; ++c) {
+    void *slab = cache->tc_classes[c].tc_slabs;
+    while (slab != NULL) {
+      void *next = *(void **)slab;
+      __kmp_free(slab);
+      slab = next;
+    }
+  }
+  __kmp_free(cache);
+}
+
+// Hand the pending batch of remotely freed blocks back to their owner
+static void __kmp_task_cache_flush_remote(kmp_task_cache_class_t *tc, int c) {
+  KMP_DEBUG_ASSERT(tc->tc_remote != NULL && tc->tc_remote_owner != NULL);
+  kmp_task_cache_t *owner = tc->tc_remote_owner;
+  kmp_task_cache_class_t *owner_tc = &owner->tc_classes[c];
+  void *old_head = owner_tc->tc_returned.load(std::memory_order_relaxed);
+  do {
+    *(void **)tc->tc_remote_tail = old_head;
+  } while (!owner_tc->tc_returned.compare_exchange_weak(
+      old_head, tc->tc_remote, std::memory_order_release,
+      std::memory_order_relaxed));
+  tc->tc_remote = tc->tc_remote_tail = NULL;
+  tc->tc_remote_owner = NULL;
+  tc->tc_nremote = 0;
+  __kmp_task_cache_unref(owner);
+}
+
+void *__kmp_task_cache_allocate(kmp_info_t *this_thr, size_t size) {
+  int c = __kmp_task_cache_class(size);
+  kmp_task_cache_class_t *tc = &__kmp_task_cache_get(this_thr)->tc_classes[c];
+  void *ptr = tc->tc_free;
+
+  if (ptr == NULL &&
+      tc->tc_returned.load(std::memory_order_relaxed) != nullptr) {
+    // take everything other threads have returned so far
+    ptr = tc->tc_returned.exchange(nullptr, std::memory_order_acquire);
+  }
+  if (ptr != NULL) {
+    KMP_COUNT_BLOCK(TASK_cache_hit);
+    tc->tc_free = *(void **)ptr;
+    return ptr;
+  }
+
+  KMP_COUNT_BLOCK(TASK_cache_miss);
+  size_t block_size = (size_t)(c + 1) * CACHE_LINE;
+  if (tc->tc_ncarve == 0) {
+    // the first cache line of a slab links it to the previous one
+    char *slab = (char *)__kmp_allocate(KMP_TASK_CACHE_SLAB_SIZE);
+    *(void **)slab = tc->tc_slabs;
+    tc->tc_slabs = slab;
+    tc->tc_carve = slab + CACHE_LINE;
+    tc->tc_ncarve =
+        (kmp_int32)((KMP_TASK_CACHE_SLAB_SIZE - CACHE_LINE) / block_size);
+  }
+  ptr = tc->tc_carve;
+  tc->tc_carve += block_size;
+  tc->tc_ncarve--;
+  KE_TRACE(25, ("__kmp_task_cache_allocate: T#%d class %d block %p\n",
+                __kmp_gtid_from_thread(this_thr), c, ptr));
+  return ptr;
+}
+
+void __kmp_task_cache_free(kmp_info_t *this_thr, void *ptr, size_t size,
+                           kmp_info_t *alloc_thr) {
+  int c = __kmp_task_cache_class(size);
+  kmp_task_cache_class_t *tc = &__kmp_task_cache_get(this_thr)->tc_classes[c];
+
+  KMP_DEBUG_ASSERT(ptr != NULL && alloc_thr != NULL);
+  if (alloc_thr == this_thr) {
+    *(void **)ptr = tc->tc_free;
+    tc->tc_free = ptr;
+    return;
+  }
+
+  KMP_COUNT_BLOCK(TASK_cache_remote_free);
+  kmp_task_cache_t *owner = alloc_thr->th.th_task_cache;
+  KMP_DEBUG_ASSERT(owner != NULL);
+  if (tc->tc_remote != NULL && (tc->tc_remote_owner != owner ||
+                                tc->tc_nremote >= KMP_TASK_CACHE_BATCH))
+    __kmp_task_cache_flush_remote(tc, c);
+  if (tc->tc_remote == NULL) {
+    tc->tc_remote_tail = ptr;
+    tc->tc_remote_owner = owner;
+    owner->tc_refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  *(void **)ptr = tc->tc_remote;
+  tc->tc_remote = ptr;
+  tc->tc_nremote++;
+}
+
+// Release the task descriptor cache of a thread being reaped. Its pending
+// batches are handed back to their owners. Other threads may still hold
+// batches of blocks from its slabs, so the cache is freed by whoever drops the
+// last reference to it.
+void __kmp_task_cache_release(kmp_info_t *this_thr) {
+  kmp_task_cache_t *cache = this_thr->th.th_task_cache;
+  if (cache == NULL)
+    return;
+  KE_TRACE(10, ("__kmp_task_cache_release: T#%d\n",
+                __kmp_gtid_from_thread(this_thr)));
+  for (int c = 0; c < KMP_TASK_CACHE_NUM_CLASSES; ++c) {
+    if (cache->tc_classes[c].tc_remote != NULL)
+      __kmp_task_cache_flush_remote(&cache->tc_classes[c], c);
+  }
+  this_thr->th.th_task_cache = NULL;
+  __kmp_task_cache_unref(cache);
+}
+
+#if USE_FAST_MEMORY == 3
+// Give a list of fast memory blocks allocated by a thread back to bget
+static void __kmp_fast_release_list(kmp_info_t *th, void *ptr) {
+  while (ptr != NULL) {
+    kmp_mem_descr_t *descr =
+        (kmp_mem_descr_t *)((char *)ptr - sizeof(kmp_mem_descr_t));
+    KMP_DEBUG_ASSERT(descr->ptr_aligned == (void *)th);
+    ptr = *((void **)ptr);
+    brel(th, descr->ptr_allocated);
+  }
+}
+#endif
+
+// Give the memory a thread reaped from the thread pool holds on to, but does
+// not use, back to the system: the blocks on its fast memory free lists, the
+// buffers other threads have freed to it, and the pool blocks of bget that are
+// entirely free. Blocks other threads still use and the task descriptor cache
+// slabs are kept until the thread is freed. The caller makes sure the thread
+// does not run.
+void __kmp_trim_thread_memory(kmp_info_t *th) {
+  KE_TRACE(10, ("__kmp_trim_thread_memory: T#%d\n",
+                __kmp_gtid_from_thread(th)));
+#if USE_FAST_MEMORY == 3
+  for (int index = 0; index < NUM_LISTS; ++index) {
+    kmp_free_list_t *list = &th->th.th_free_lists[index];
+    void *ptr;
+
+    if (list->th_free_list_other != NULL) {
+      __kmp_fast_return_list(list->th_free_list_other, index);
+      list->th_free_list_other = NULL;
+    }
+    ptr = TCR_SYNC_PTR(list->th_free_list_sync);
+    while (!KMP_COMPARE_AND_STORE_PTR(&list->th_free_list_sync, ptr,
+                                      nullptr)) {
+      KMP_CPU_PAUSE();
+      ptr = TCR_SYNC_PTR(list->th_free_list_sync);
+    }
+    __kmp_fast_release_list(th, ptr);
+    __kmp_fast_release_list(th, list->th_free_list_self);
+    list->th_free_list_self = NULL;
+  }
+#endif
+  kmp_task_cache_t *cache = th->th.th_task_cache;
+  if (cache != NULL) {
+    for (int c = 0; c < KMP_TASK_CACHE_NUM_CLASSES; ++c) {
+      if (cache->tc_classes[c].tc_remote != NULL)
+        __kmp_task_cache_flush_remote(&cache->tc_classes[c], c);
+    }
+  }
+  __kmp_bget_dequeue(th); // Release any queued buffers
+  __kmp_bget_release_last_pool(get_thr_data(th));
+}
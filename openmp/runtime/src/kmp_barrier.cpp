@@ -411,7 +411,7 @@ static void __kmp_dist_barrier_release(
           // Cancel wait on previous parallel region...
           __kmp_itt_task_starting(itt_sync_obj);
 
-          if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+          if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
             return;
 
           itt_sync_obj = __kmp_itt_barrier_object(gtid, bs_forkjoin_barrier);
@@ -420,13 +420,13 @@ static void __kmp_dist_barrier_release(
             __kmp_itt_task_finished(itt_sync_obj);
         } else
 #endif /* USE_ITT_BUILD && USE_ITT_NOTIFY */
-            if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+            if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
           return;
       }
       if (this_thr->th.th_used_in_team.load() != 1 &&
           this_thr->th.th_used_in_team.load() != 3) // spurious wake-up?
         continue;
-      if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+      if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
         return;
 
       // At this point, the thread thinks it is in use in a team, or in
@@ -457,7 +457,7 @@ static void __kmp_dist_barrier_release(
         KMP_DEBUG_ASSERT(b->sleep[tid].sleep == false);
       }
 
-      if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+      if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
         return;
       // At this point, the thread's go location was set. This means the primary
       // thread is safely in the barrier, and so this thread's data is
@@ -468,7 +468,7 @@ static void __kmp_dist_barrier_release(
         break;
     } while (1);
 
-    if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+    if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
       return;
 
     group_leader = ((tid % b->threads_per_group) == 0);
@@ -731,7 +731,7 @@ static bool __kmp_linear_barrier_release_template(
       // Cancel wait on previous parallel region...
       __kmp_itt_task_starting(itt_sync_obj);
 
-      if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+      if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
         return false;
 
       itt_sync_obj = __kmp_itt_barrier_object(gtid, bs_forkjoin_barrier);
@@ -741,7 +741,7 @@ static bool __kmp_linear_barrier_release_template(
     } else
 #endif /* USE_ITT_BUILD && USE_ITT_NOTIFY */
         // Early exit for reaping threads releasing forkjoin barrier
-        if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+        if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
       return false;
 // The worker thread may now assume that the team is valid.
 #ifdef KMP_DEBUG
@@ -791,15 +791,15 @@ static bool __kmp_linear_barrier_release_cancellable(
 }
 
 // Tree barrier
-static void __kmp_tree_barrier_gather(
+static void __kmp_tree_barrier_gather_bits(
     enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
-    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+    void (*reduce)(void *, void *),
+    kmp_uint32 branch_bits USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
   KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_tree_gather);
   kmp_team_t *team = this_thr->th.th_team;
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_info_t **other_threads = team->t.t_threads;
   kmp_uint32 nproc = this_thr->th.th_team_nproc;
-  kmp_uint32 branch_bits = __kmp_barrier_gather_branch_bits[bt];
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 child;
   kmp_uint32 child_tid;
@@ -897,14 +897,22 @@ static void __kmp_tree_barrier_gather(
             gtid, team->t.t_id, tid, bt));
 }
 
-static void __kmp_tree_barrier_release(
+static void __kmp_tree_barrier_gather(
     enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
-    int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  __kmp_tree_barrier_gather_bits(
+      bt, this_thr, gtid, tid, reduce,
+      __kmp_barrier_gather_branch_bits[bt] USE_ITT_BUILD_ARG(itt_sync_obj));
+}
+
+static void __kmp_tree_barrier_release_bits(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    int propagate_icvs, kmp_uint32 branch_bits USE_ITT_BUILD_ARG(
+                            void *itt_sync_obj)) {
   KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_tree_release);
   kmp_team_t *team;
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_uint32 nproc;
-  kmp_uint32 branch_bits = __kmp_barrier_release_branch_bits[bt];
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 child;
   kmp_uint32 child_tid;
@@ -925,7 +933,7 @@ static void __kmp_tree_barrier_release(
       // Cancel wait on previous parallel region...
       __kmp_itt_task_starting(itt_sync_obj);
 
-      if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+      if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
         return;
 
       itt_sync_obj = __kmp_itt_barrier_object(gtid, bs_forkjoin_barrier);
@@ -935,7 +943,7 @@ static void __kmp_tree_barrier_release(
     } else
 #endif /* USE_ITT_BUILD && USE_ITT_NOTIFY */
         // Early exit for reaping threads releasing forkjoin barrier
-        if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+        if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
       return;
 
     // The worker thread may now assume that the team is valid.
@@ -1002,17 +1010,25 @@ static void __kmp_tree_barrier_release(
            gtid, team->t.t_id, tid, bt));
 }
 
+static void __kmp_tree_barrier_release(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  __kmp_tree_barrier_release_bits(
+      bt, this_thr, gtid, tid, propagate_icvs,
+      __kmp_barrier_release_branch_bits[bt] USE_ITT_BUILD_ARG(itt_sync_obj));
+}
+
 // Hyper Barrier
-static void __kmp_hyper_barrier_gather(
+static void __kmp_hyper_barrier_gather_bits(
     enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
-    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+    void (*reduce)(void *, void *),
+    kmp_uint32 branch_bits USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
   KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_hyper_gather);
   kmp_team_t *team = this_thr->th.th_team;
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_info_t **other_threads = team->t.t_threads;
   kmp_uint64 new_state = KMP_BARRIER_UNUSED_STATE;
   kmp_uint32 num_threads = this_thr->th.th_team_nproc;
-  kmp_uint32 branch_bits = __kmp_barrier_gather_branch_bits[bt];
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 offset;
   kmp_uint32 level;
@@ -1120,17 +1136,25 @@ static void __kmp_hyper_barrier_gather(
            gtid, team->t.t_id, tid, bt));
 }
 
+static void __kmp_hyper_barrier_gather(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  __kmp_hyper_barrier_gather_bits(
+      bt, this_thr, gtid, tid, reduce,
+      __kmp_barrier_gather_branch_bits[bt] USE_ITT_BUILD_ARG(itt_sync_obj));
+}
+
 // The reverse versions seem to beat the forward versions overall
 #define KMP_REVERSE_HYPER_BAR
-static void __kmp_hyper_barrier_release(
+static void __kmp_hyper_barrier_release_bits(
     enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
-    int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+    int propagate_icvs, kmp_uint32 branch_bits USE_ITT_BUILD_ARG(
+                            void *itt_sync_obj)) {
   KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_hyper_release);
   kmp_team_t *team;
   kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
   kmp_info_t **other_threads;
   kmp_uint32 num_threads;
-  kmp_uint32 branch_bits = __kmp_barrier_release_branch_bits[bt];
   kmp_uint32 branch_factor = 1 << branch_bits;
   kmp_uint32 child;
   kmp_uint32 child_tid;
@@ -1166,7 +1190,7 @@ static void __kmp_hyper_barrier_release(
       // Cancel wait on previous parallel region...
       __kmp_itt_task_starting(itt_sync_obj);
 
-      if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+      if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
         return;
 
       itt_sync_obj = __kmp_itt_barrier_object(gtid, bs_forkjoin_barrier);
@@ -1176,7 +1200,7 @@ static void __kmp_hyper_barrier_release(
     } else
 #endif /* USE_ITT_BUILD && USE_ITT_NOTIFY */
         // Early exit for reaping threads releasing forkjoin barrier
-        if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+        if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
       return;
 
     // The worker thread may now assume that the team is valid.
@@ -1277,6 +1301,481 @@ static void __kmp_hyper_barrier_release(
        gtid, team->t.t_id, tid, bt));
 }
 
+static void __kmp_hyper_barrier_release(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  __kmp_hyper_barrier_release_bits(
+      bt, this_thr, gtid, tid, propagate_icvs,
+      __kmp_barrier_release_branch_bits[bt] USE_ITT_BUILD_ARG(itt_sync_obj));
+}
+
+// Dissemination and Tournament Barriers
+
+/* Both barriers synchronize through per-round flags of the team, see
+   kmp_bar_round_t. A flag is bumped once per barrier and its owner waits for
+   the value following the one it saw last time. The dissemination barrier lets
+   a thread run into the next barrier and bump a flag of its partner before the
+   partner has left the current one, so the flags are double buffered on the
+   parity of the barrier count, which all threads of the team agree on. */
+
+static inline bool __kmp_barrier_uses_rounds(enum barrier_type bt) {
+  return __kmp_barrier_gather_pattern[bt] == bp_dissem_bar ||
+         __kmp_barrier_gather_pattern[bt] == bp_tournament_bar ||
+         __kmp_barrier_gather_pattern[bt] == bp_auto_bar;
+}
+
+void __kmp_barrier_alloc_rounds(kmp_team_t *team, int max_nth) {
+  kmp_uint32 nrounds = 0;
+  while ((1 << nrounds) < max_nth)
+    ++nrounds;
+  for (int b = 0; b < bs_last_barrier; ++b) {
+    KMP_DEBUG_ASSERT(team->t.t_bar[b].b_rounds == NULL);
+    if (nrounds == 0 || !__kmp_barrier_uses_rounds((enum barrier_type)b))
+      continue;
+    team->t.t_bar[b].b_rounds = (kmp_bar_round_t *)__kmp_allocate(
+        sizeof(kmp_bar_round_t) * max_nth * 2 * nrounds);
+    team->t.t_bar[b].b_nrounds = nrounds;
+  }
+}
+
+void __kmp_barrier_free_rounds(kmp_team_t *team) {
+  for (int b = 0; b < bs_last_barrier; ++b) {
+    if (team->t.t_bar[b].b_rounds) {
+      __kmp_free(team->t.t_bar[b].b_rounds);
+      team->t.t_bar[b].b_rounds = NULL;
+      team->t.t_bar[b].b_nrounds = 0;
+    }
+  }
+}
+
+static inline kmp_bar_round_t *__kmp_bar_round(kmp_team_t *team,
+                                               enum barrier_type bt,
+                                               kmp_uint32 tid,
+                                               kmp_uint32 parity,
+                                               kmp_uint32 round) {
+  kmp_balign_team_t *team_bar = &team->t.t_bar[bt];
+  KMP_DEBUG_ASSERT(round < team_bar->b_nrounds);
+  return &team_bar->b_rounds[(tid * 2 + parity) * team_bar->b_nrounds + round];
+}
+
+// Parity of the barrier, from the arrived count of the thread, or of the team
+// for the primary thread
+static inline kmp_uint32 __kmp_bar_round_parity(kmp_team_t *team,
+                                                kmp_bstate_t *thr_bar,
+                                                enum barrier_type bt, int tid) {
+  kmp_uint64 state = KMP_MASTER_TID(tid) ? team->t.t_bar[bt].b_arrived
+                                         : thr_bar->b_arrived;
+  return (kmp_uint32)(state >> KMP_BARRIER_BUMP_BIT) & 1;
+}
+
+static inline void __kmp_bar_round_wait(kmp_info_t *this_thr,
+                                        kmp_bar_round_t *round
+                                            USE_ITT_BUILD_ARG(
+                                                void *itt_sync_obj)) {
+  round->seen += KMP_BARRIER_STATE_BUMP;
+  kmp_flag_64<> flag(&round->flag, round->seen);
+  flag.wait(this_thr, FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
+}
+
+// Whether the thread needs the release phase after a dissemination gather. A
+// plain barrier can do without when the release uses dissemination too, no
+// thread has tasks to wait for, and the primary thread has nothing to publish.
+static inline bool
+__kmp_dissem_barrier_need_release(kmp_info_t *this_thr, int is_split,
+                                  void (*reduce)(void *, void *)) {
+  if (is_split || reduce || __kmp_omp_cancellation)
+    return true;
+  kmp_task_team_t *task_team = this_thr->th.th_task_team;
+  return task_team != NULL &&
+         (KMP_TASKING_ENABLED(task_team) ||
+          TCR_4(task_team->tt.tt_found_proxy_tasks) ||
+          TCR_4(task_team->tt.tt_hidden_helper_task_encountered));
+}
+
+/* Dissemination gather: in round k each thread signals thread tid + 2^k and
+   waits for thread tid - 2^k (modulo nproc), so after ceil(log2(nproc))
+   rounds every thread knows that all threads have arrived, without a single
+   root. need_release is or-ed into the signals, the result tells every thread
+   whether any of them needs the release phase. Reduction is done by the
+   primary thread after the last round. The team must stay valid until all
+   threads have left the barrier, so it is not used for the fork/join barrier.
+ */
+static bool __kmp_dissem_barrier_gather(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    void (*reduce)(void *, void *),
+    bool need_release USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_dissem_gather);
+  kmp_team_t *team = this_thr->th.th_team;
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
+  kmp_info_t **other_threads = team->t.t_threads;
+  kmp_uint32 nproc = this_thr->th.th_team_nproc;
+  kmp_uint32 parity = __kmp_bar_round_parity(team, thr_bar, bt, tid);
+  kmp_uint32 need = need_release;
+  kmp_uint32 round, offset;
+
+  KA_TRACE(
+      20,
+      ("__kmp_dissem_barrier_gather: T#%d(%d:%d) enter for barrier type %d\n",
+       gtid, team->t.t_id, tid, bt));
+  KMP_DEBUG_ASSERT(this_thr == other_threads[this_thr->th.th_info.ds.ds_tid]);
+
+#if USE_ITT_BUILD && USE_ITT_NOTIFY
+  // Barrier imbalance - save arrive time to the thread
+  if (__kmp_forkjoin_frames_mode == 3 || __kmp_forkjoin_frames_mode == 2) {
+    this_thr->th.th_bar_arrive_time = this_thr->th.th_bar_min_time =
+        __itt_get_timestamp();
+  }
+#endif
+  for (round = 0, offset = 1; offset < nproc; ++round, offset <<= 1) {
+    kmp_uint32 to_tid = (tid + offset) % nproc;
+    kmp_bar_round_t *out = __kmp_bar_round(team, bt, to_tid, parity, round);
+    kmp_bar_round_t *in = __kmp_bar_round(team, bt, tid, parity, round);
+    KA_TRACE(20, ("__kmp_dissem_barrier_gather: T#%d(%d:%d) round %u "
+                  "signal T#%d(%d:%u) flag(%p)\n",
+                  gtid, team->t.t_id, tid, round,
+                  __kmp_gtid_from_tid(to_tid, team), team->t.t_id, to_tid,
+                  &out->flag));
+    out->need_release = need;
+    kmp_flag_64<> flag(&out->flag, other_threads[to_tid]);
+    flag.release();
+    __kmp_bar_round_wait(this_thr, in USE_ITT_BUILD_ARG(itt_sync_obj));
+    need |= in->need_release;
+  }
+
+  if (KMP_MASTER_TID(tid)) {
+    if (reduce) {
+      // all threads have arrived, their reduce_data are final
+      OMPT_REDUCTION_DECL(this_thr, gtid);
+      OMPT_REDUCTION_BEGIN;
+      for (kmp_uint32 i = 1; i < nproc; ++i) {
+        KA_TRACE(100,
+                 ("__kmp_dissem_barrier_gather: T#%d(%d:%d) += T#%d(%d:%u)\n",
+                  gtid, team->t.t_id, tid, __kmp_gtid_from_tid(i, team),
+                  team->t.t_id, i));
+        (*reduce)(this_thr->th.th_local.reduce_data,
+                  other_threads[i]->th.th_local.reduce_data);
+      }
+      OMPT_REDUCTION_END;
+    }
+    team->t.t_bar[bt].b_arrived += KMP_BARRIER_STATE_BUMP;
+  } else {
+    thr_bar->b_arrived += KMP_BARRIER_STATE_BUMP;
+  }
+  KA_TRACE(20, ("__kmp_dissem_barrier_gather: T#%d(%d:%d) exit for barrier "
+                "type %d, need release %u\n",
+                gtid, team->t.t_id, tid, bt, need));
+  return need != 0;
+}
+
+/* Tournament gather: in round k a thread with bit k set loses against thread
+   tid - 2^k, signals it on a flag the winner owns, and leaves the gather. The
+   winner of all rounds is the primary thread. Reduction is done by the
+   winners as the losers arrive. The release is the reverse binomial tree. */
+static void __kmp_tournament_barrier_gather(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_tournament_gather);
+  kmp_team_t *team = this_thr->th.th_team;
+  kmp_bstate_t *thr_bar = &this_thr->th.th_bar[bt].bb;
+  kmp_info_t **other_threads = team->t.t_threads;
+  kmp_uint32 nproc = this_thr->th.th_team_nproc;
+  kmp_uint32 parity = __kmp_bar_round_parity(team, thr_bar, bt, tid);
+  kmp_uint32 round, offset;
+
+  KA_TRACE(20, ("__kmp_tournament_barrier_gather: T#%d(%d:%d) enter for "
+                "barrier type %d\n",
+                gtid, team->t.t_id, tid, bt));
+  KMP_DEBUG_ASSERT(this_thr == other_threads[this_thr->th.th_info.ds.ds_tid]);
+
+#if USE_ITT_BUILD && USE_ITT_NOTIFY
+  // Barrier imbalance - save arrive time to the thread
+  if (__kmp_forkjoin_frames_mode == 3 || __kmp_forkjoin_frames_mode == 2) {
+    this_thr->th.th_bar_arrive_time = this_thr->th.th_bar_min_time =
+        __itt_get_timestamp();
+  }
+#endif
+  for (round = 0, offset = 1; offset < nproc; ++round, offset <<= 1) {
+    if (tid & offset) {
+      kmp_uint32 winner_tid = tid - offset;
+      kmp_bar_round_t *out =
+          __kmp_bar_round(team, bt, winner_tid, parity, round);
+      KA_TRACE(20, ("__kmp_tournament_barrier_gather: T#%d(%d:%d) round %u "
+                    "releasing T#%d(%d:%u) flag(%p)\n",
+                    gtid, team->t.t_id, tid, round,
+                    __kmp_gtid_from_tid(winner_tid, team), team->t.t_id,
+                    winner_tid, &out->flag));
+      thr_bar->b_arrived += KMP_BARRIER_STATE_BUMP;
+      /* After performing this write, a worker thread may not assume that the
+         team is valid any more - it could be deallocated by the primary thread
+         at any time.  */
+      kmp_flag_64<> flag(&out->flag, other_threads[winner_tid]);
+      flag.release();
+      break;
+    }
+    kmp_uint32 loser_tid = tid + offset;
+    if (loser_tid < nproc) {
+      kmp_info_t *loser_thr = other_threads[loser_tid];
+      kmp_bar_round_t *in = __kmp_bar_round(team, bt, tid, parity, round);
+      KA_TRACE(20, ("__kmp_tournament_barrier_gather: T#%d(%d:%d) round %u "
+                    "wait T#%d(%d:%u) flag(%p)\n",
+                    gtid, team->t.t_id, tid, round,
+                    __kmp_gtid_from_tid(loser_tid, team), team->t.t_id,
+                    loser_tid, &in->flag));
+      __kmp_bar_round_wait(this_thr, in USE_ITT_BUILD_ARG(itt_sync_obj));
+#if USE_ITT_BUILD && USE_ITT_NOTIFY
+      // Barrier imbalance - write min of the thread time and a child time to
+      // the thread.
+      if (__kmp_forkjoin_frames_mode == 2) {
+        this_thr->th.th_bar_min_time = KMP_MIN(this_thr->th.th_bar_min_time,
+                                               loser_thr->th.th_bar_min_time);
+      }
+#endif
+      if (reduce) {
+        KA_TRACE(100, ("__kmp_tournament_barrier_gather: T#%d(%d:%d) += "
+                       "T#%d(%d:%u)\n",
+                       gtid, team->t.t_id, tid,
+                       __kmp_gtid_from_tid(loser_tid, team), team->t.t_id,
+                       loser_tid));
+        OMPT_REDUCTION_DECL(this_thr, gtid);
+        OMPT_REDUCTION_BEGIN;
+        (*reduce)(this_thr->th.th_local.reduce_data,
+                  loser_thr->th.th_local.reduce_data);
+        OMPT_REDUCTION_END;
+      }
+    }
+  }
+
+  if (KMP_MASTER_TID(tid)) {
+    team->t.t_bar[bt].b_arrived += KMP_BARRIER_STATE_BUMP;
+    KA_TRACE(20, ("__kmp_tournament_barrier_gather: T#%d(%d:%d) set team %d "
+                  "arrived(%p) = %llu\n",
+                  gtid, team->t.t_id, tid, team->t.t_id,
+                  &team->t.t_bar[bt].b_arrived, team->t.t_bar[bt].b_arrived));
+  }
+  KA_TRACE(20, ("__kmp_tournament_barrier_gather: T#%d(%d:%d) exit for "
+                "barrier type %d\n",
+                gtid, team->t.t_id, tid, bt));
+}
+
+// Release of the dissemination and tournament barriers: binomial tree
+static void __kmp_round_barrier_release(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  __kmp_hyper_barrier_release_bits(bt, this_thr, gtid, tid, propagate_icvs,
+                                   1 USE_ITT_BUILD_ARG(itt_sync_obj));
+}
+
+// Auto Barrier Pattern
+
+/* Candidates of the auto pattern. They all count the arrivals in b_arrived and
+   release the threads through b_go the same way, so a team can switch from one
+   to another between two barriers. The dissemination and tournament barriers
+   release through a binomial tree. */
+typedef struct kmp_bar_auto_cand {
+  kmp_bar_pat_e pattern;
+  kmp_uint32 branch_bits;
+} kmp_bar_auto_cand_t;
+
+static const kmp_bar_auto_cand_t __kmp_bar_auto_cands[] = {
+    {bp_linear_bar, 0}, {bp_tree_bar, 1},   {bp_tree_bar, 2},
+    {bp_tree_bar, 3},   {bp_tree_bar, 4},   {bp_hyper_bar, 1},
+    {bp_hyper_bar, 2},  {bp_hyper_bar, 3},  {bp_hyper_bar, 4},
+    {bp_dissem_bar, 0}, {bp_tournament_bar, 0}};
+
+#define KMP_BAR_AUTO_NUM_CANDS                                                 \
+  (kmp_uint32)(sizeof(__kmp_bar_auto_cands) / sizeof(__kmp_bar_auto_cands[0]))
+
+// Candidate chosen for each team size, plus one, so that a new team of a size
+// already seen does not time the candidates again
+#define KMP_BAR_AUTO_MAX_NPROC 1024
+static std::atomic<kmp_uint8>
+    __kmp_bar_auto_chosen[bs_last_barrier][KMP_BAR_AUTO_MAX_NPROC];
+
+// A tree candidate is not worth timing when the previous one, with one branch
+// bit less, already has all the threads as children of the root
+static inline bool __kmp_bar_auto_useful(kmp_uint32 cand, kmp_uint32 nproc) {
+  kmp_uint32 bits = __kmp_bar_auto_cands[cand].branch_bits;
+  return bits <= 1 || (1u << (bits - 1)) < nproc - 1;
+}
+
+/* Candidate of the barrier the thread enters. All threads of the team get the
+   same one, as it is only changed by the primary thread before it releases
+   them from the previous barrier. Until the primary thread has seen a new team
+   size, the linear pattern is used without timing it. */
+static inline kmp_uint32 __kmp_bar_auto_cand(kmp_team_t *team,
+                                             enum barrier_type bt,
+                                             kmp_uint32 nproc) {
+  kmp_bar_auto_t *ba = &team->t.t_bar[bt].b_auto;
+  if (ba->b_nproc != nproc)
+    return KMP_BAR_AUTO_LOCKED;
+  return ba->b_cand;
+}
+
+static inline void __kmp_bar_auto_start(kmp_bar_auto_t *ba, kmp_uint32 cand) {
+  ba->b_cand = cand;
+  ba->b_samples = 0;
+  ba->b_gather_ticks = ~(kmp_uint64)0;
+  // the dissemination barrier is timed with a release while tuning, but
+  // mostly goes without one afterwards
+  ba->b_release_ticks = __kmp_bar_auto_cands[cand].pattern == bp_dissem_bar
+                            ? 0
+                            : ~(kmp_uint64)0;
+}
+
+/* Called by the primary thread before it releases the team from a barrier
+   that used candidate cand. Once the candidate has been timed by enough
+   barriers, moves on to the next one, or locks in the fastest one. The cost of
+   a candidate is the sum of its fastest gather and fastest release, as seen by
+   the primary thread. */
+static void __kmp_bar_auto_update(kmp_team_t *team, enum barrier_type bt,
+                                  kmp_uint32 nproc, kmp_uint32 cand) {
+  kmp_bar_auto_t *ba = &team->t.t_bar[bt].b_auto;
+  kmp_uint32 chosen = 0;
+
+  if (ba->b_nproc != nproc) {
+    if (nproc < KMP_BAR_AUTO_MAX_NPROC)
+      chosen = __kmp_bar_auto_chosen[bt][nproc].load(std::memory_order_relaxed);
+    ba->b_nproc = nproc;
+    ba->b_best = 0;
+    ba->b_best_ticks = ~(kmp_uint64)0;
+    if (chosen)
+      ba->b_cand = (chosen - 1) | KMP_BAR_AUTO_LOCKED;
+    else
+      __kmp_bar_auto_start(ba, 0);
+    return;
+  }
+  if ((cand & KMP_BAR_AUTO_LOCKED) ||
+      ba->b_samples < (kmp_uint32)__kmp_barrier_auto_samples)
+    return;
+
+  kmp_uint64 ticks = ba->b_gather_ticks + ba->b_release_ticks;
+  if (ticks < ba->b_best_ticks) {
+    ba->b_best_ticks = ticks;
+    ba->b_best = cand;
+  }
+  do {
+    ++cand;
+  } while (cand < KMP_BAR_AUTO_NUM_CANDS &&
+           !__kmp_bar_auto_useful(cand, nproc));
+  if (cand < KMP_BAR_AUTO_NUM_CANDS) {
+    __kmp_bar_auto_start(ba, cand);
+    return;
+  }
+  KA_TRACE(10, ("__kmp_bar_auto_update: team %d barrier type %d, %u threads: "
+                "chose %s with %u branch bits\n",
+                team->t.t_id, bt, nproc,
+                __kmp_barrier_pattern_name[__kmp_bar_auto_cands[ba->b_best]
+                                               .pattern],
+                __kmp_bar_auto_cands[ba->b_best].branch_bits));
+  ba->b_cand = ba->b_best | KMP_BAR_AUTO_LOCKED;
+  if (nproc < KMP_BAR_AUTO_MAX_NPROC)
+    __kmp_bar_auto_chosen[bt][nproc].store((kmp_uint8)(ba->b_best + 1),
+                                           std::memory_order_relaxed);
+}
+
+/* Gather of the auto pattern with candidate cand. Returns whether the release
+   phase is needed, see __kmp_dissem_barrier_gather(). While the candidates are
+   timed, the primary thread publishes the next one before the release, so the
+   release is always needed. */
+static bool __kmp_auto_barrier_gather(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    kmp_uint32 cand, int is_split,
+    void (*reduce)(void *, void *) USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  const kmp_bar_auto_cand_t *c =
+      &__kmp_bar_auto_cands[cand & ~KMP_BAR_AUTO_LOCKED];
+  bool timed = KMP_MASTER_TID(tid) && !(cand & KMP_BAR_AUTO_LOCKED);
+  bool need_release = true;
+  kmp_uint64 start = timed ? KMP_NOW() : 0;
+
+  switch (c->pattern) {
+  case bp_tree_bar: {
+    __kmp_tree_barrier_gather_bits(
+        bt, this_thr, gtid, tid, reduce,
+        c->branch_bits USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  case bp_hyper_bar: {
+    __kmp_hyper_barrier_gather_bits(
+        bt, this_thr, gtid, tid, reduce,
+        c->branch_bits USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  case bp_dissem_bar: {
+    need_release = __kmp_dissem_barrier_gather(
+        bt, this_thr, gtid, tid, reduce,
+        !(cand & KMP_BAR_AUTO_LOCKED) ||
+            __kmp_dissem_barrier_need_release(this_thr, is_split, reduce)
+                USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  case bp_tournament_bar: {
+    __kmp_tournament_barrier_gather(bt, this_thr, gtid, tid,
+                                    reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  default: {
+    __kmp_linear_barrier_gather(bt, this_thr, gtid, tid,
+                                reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+  }
+  }
+  if (timed) {
+    kmp_bar_auto_t *ba = &this_thr->th.th_team->t.t_bar[bt].b_auto;
+    ba->b_gather_ticks = KMP_MIN(ba->b_gather_ticks, KMP_NOW() - start);
+  }
+  return need_release;
+}
+
+static void __kmp_auto_barrier_release(
+    enum barrier_type bt, kmp_info_t *this_thr, int gtid, int tid,
+    kmp_uint32 cand, int propagate_icvs USE_ITT_BUILD_ARG(void *itt_sync_obj)) {
+  const kmp_bar_auto_cand_t *c =
+      &__kmp_bar_auto_cands[cand & ~KMP_BAR_AUTO_LOCKED];
+  kmp_team_t *team = this_thr->th.th_team;
+  bool timed = KMP_MASTER_TID(tid) && !(cand & KMP_BAR_AUTO_LOCKED);
+  kmp_uint64 start = 0;
+
+  if (KMP_MASTER_TID(tid)) {
+    __kmp_bar_auto_update(team, bt, this_thr->th.th_team_nproc, cand);
+    if (timed)
+      start = KMP_NOW();
+  }
+  switch (c->pattern) {
+  case bp_tree_bar: {
+    __kmp_tree_barrier_release_bits(
+        bt, this_thr, gtid, tid, propagate_icvs,
+        c->branch_bits USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  case bp_hyper_bar: {
+    __kmp_hyper_barrier_release_bits(
+        bt, this_thr, gtid, tid, propagate_icvs,
+        c->branch_bits USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  case bp_dissem_bar:
+  case bp_tournament_bar: {
+    __kmp_round_barrier_release(bt, this_thr, gtid, tid,
+                                propagate_icvs USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
+  default: {
+    __kmp_linear_barrier_release(
+        bt, this_thr, gtid, tid,
+        propagate_icvs USE_ITT_BUILD_ARG(itt_sync_obj));
+  }
+  }
+  if (timed) {
+    // the team is owned by the primary thread, the workers do not read the
+    // timing fields
+    kmp_bar_auto_t *ba = &team->t.t_bar[bt].b_auto;
+    if (ba->b_cand == cand) {
+      if (c->pattern != bp_dissem_bar)
+        ba->b_release_ticks = KMP_MIN(ba->b_release_ticks, KMP_NOW() - start);
+      ++ba->b_samples;
+    }
+  }
+}
+
 // Hierarchical Barrier
 
 // Initialize thread barrier data
@@ -1568,7 +2067,7 @@ static void __kmp_hierarchical_barrier_release(
     }
     thr_bar->wait_flag = KMP_BARRIER_NOT_WAITING;
     // Early exit for reaping threads releasing forkjoin barrier
-    if (bt == bs_forkjoin_barrier && TCR_4(__kmp_global.g.g_done))
+    if (bt == bs_forkjoin_barrier && __kmp_worker_exiting(this_thr))
       return;
     // The worker thread may now assume that the team is valid.
     team = __kmp_threads[gtid]->th.th_team;
@@ -1774,6 +2273,8 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
   kmp_team_t *team = this_thr->th.th_team;
   int status = 0;
   is_cancellable<cancellable> cancelled;
+  bool skip_release = false;
+  kmp_uint32 auto_cand = 0;
 #if OMPT_SUPPORT && OMPT_OPTIONAL
   ompt_data_t *my_task_data;
   ompt_data_t *my_parallel_data;
@@ -1871,6 +2372,26 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
                                   reduce USE_ITT_BUILD_ARG(itt_sync_obj));
         break;
       }
+      case bp_dissem_bar: {
+        skip_release = !__kmp_dissem_barrier_gather(
+            bt, this_thr, gtid, tid, reduce,
+            __kmp_barrier_release_pattern[bt] != bp_dissem_bar ||
+                __kmp_dissem_barrier_need_release(this_thr, is_split, reduce)
+                    USE_ITT_BUILD_ARG(itt_sync_obj));
+        break;
+      }
+      case bp_tournament_bar: {
+        __kmp_tournament_barrier_gather(bt, this_thr, gtid, tid,
+                                        reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+        break;
+      }
+      case bp_auto_bar: {
+        auto_cand = __kmp_bar_auto_cand(team, bt, this_thr->th.th_team_nproc);
+        skip_release = !__kmp_auto_barrier_gather(
+            bt, this_thr, gtid, tid, auto_cand, is_split,
+            reduce USE_ITT_BUILD_ARG(itt_sync_obj));
+        break;
+      }
       case bp_hyper_bar: {
         // don't set branch bits to 0; use linear
         KMP_ASSERT(__kmp_barrier_gather_branch_bits[bt]);
@@ -1982,7 +2503,7 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
       if (cancellable) {
         cancelled = __kmp_linear_barrier_release_cancellable(
             bt, this_thr, gtid, tid, FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
-      } else {
+      } else if (!skip_release) {
         switch (__kmp_barrier_release_pattern[bt]) {
         case bp_dist_bar: {
           KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
@@ -1990,6 +2511,17 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
                                      FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
           break;
         }
+        case bp_dissem_bar:
+        case bp_tournament_bar: {
+          __kmp_round_barrier_release(bt, this_thr, gtid, tid,
+                                      FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
+          break;
+        }
+        case bp_auto_bar: {
+          __kmp_auto_barrier_release(bt, this_thr, gtid, tid, auto_cand,
+                                     FALSE USE_ITT_BUILD_ARG(itt_sync_obj));
+          break;
+        }
         case bp_hyper_bar: {
           KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
           __kmp_hyper_barrier_release(bt, this_thr, gtid, tid,
@@ -2126,6 +2658,19 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
                                    FALSE USE_ITT_BUILD_ARG(NULL));
         break;
       }
+      case bp_dissem_bar:
+      case bp_tournament_bar: {
+        __kmp_round_barrier_release(bt, this_thr, gtid, tid,
+                                    FALSE USE_ITT_BUILD_ARG(NULL));
+        break;
+      }
+      case bp_auto_bar: {
+        __kmp_auto_barrier_release(
+            bt, this_thr, gtid, tid,
+            __kmp_bar_auto_cand(team, bt, this_thr->th.th_team_nproc),
+            FALSE USE_ITT_BUILD_ARG(NULL));
+        break;
+      }
       case bp_hyper_bar: {
         KMP_ASSERT(__kmp_barrier_release_branch_bits[bt]);
         __kmp_hyper_barrier_release(bt, this_thr, gtid, tid,
@@ -2155,6 +2700,93 @@ void __kmp_end_split_barrier(enum barrier_type bt, int gtid) {
   }
 }
 
+// Split barrier of the kmp_barrier_arrive/kmp_barrier_wait extension
+
+/* The arrival of a worker thread is its signal of the linear gather, which
+   does not wait. The primary thread gathers the workers in its wait, waits for
+   the tasks of the team and releases the team. Hierarchical and distributed
+   plain barriers keep arrival state of their own, with them the arrival does
+   nothing and the wait is a full barrier. */
+static inline bool __kmp_split_barrier_linear(kmp_team_t *team) {
+  kmp_bar_pat_e pattern = __kmp_barrier_gather_pattern[bs_plain_barrier];
+  return !team->t.t_serialized && pattern != bp_hierarchical_bar &&
+         pattern != bp_dist_bar;
+}
+
+void __kmp_split_barrier_arrive(int gtid) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_split_barrier_arrive);
+  int tid = __kmp_tid_from_gtid(gtid);
+  kmp_info_t *this_thr = __kmp_threads[gtid];
+  kmp_team_t *team = this_thr->th.th_team;
+
+  KA_TRACE(15, ("__kmp_split_barrier_arrive: T#%d(%d:%d) has arrived\n", gtid,
+                team->t.t_id, tid));
+  if (this_thr->th.th_split_arrived || !__kmp_split_barrier_linear(team))
+    return;
+  this_thr->th.th_split_arrived = TRUE;
+
+  if (__kmp_tasking_mode == tskm_extra_barrier)
+    __kmp_tasking_barrier(team, this_thr, gtid);
+  // see __kmp_barrier_template()
+  if (__kmp_dflt_blocktime != KMP_MAX_BLOCKTIME) {
+#if KMP_USE_MONITOR
+    this_thr->th.th_team_bt_intervals =
+        team->t.t_implicit_task_taskdata[tid].td_icvs.bt_intervals;
+    this_thr->th.th_team_bt_set =
+        team->t.t_implicit_task_taskdata[tid].td_icvs.bt_set;
+#else
+    this_thr->th.th_team_bt_intervals = KMP_BLOCKTIME_INTERVAL(team, tid);
+#endif
+  }
+  if (!KMP_MASTER_TID(tid))
+    __kmp_linear_barrier_gather(bs_plain_barrier, this_thr, gtid, tid,
+                                NULL USE_ITT_BUILD_ARG(NULL));
+}
+
+void __kmp_split_barrier_wait(int gtid) {
+  KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_split_barrier_wait);
+  enum barrier_type bt = bs_plain_barrier;
+  int tid = __kmp_tid_from_gtid(gtid);
+  kmp_info_t *this_thr = __kmp_threads[gtid];
+  kmp_team_t *team = this_thr->th.th_team;
+
+  if (!__kmp_split_barrier_linear(team)) {
+    __kmp_barrier(bt, gtid, FALSE, 0, NULL, NULL);
+    return;
+  }
+  if (!this_thr->th.th_split_arrived)
+    __kmp_split_barrier_arrive(gtid);
+  this_thr->th.th_split_arrived = FALSE;
+
+  if (KMP_MASTER_TID(tid)) {
+    if (__kmp_tasking_mode != tskm_immediate_exec)
+      __kmp_task_team_setup(this_thr, team, 0);
+    __kmp_linear_barrier_gather(bt, this_thr, gtid, tid,
+                                NULL USE_ITT_BUILD_ARG(NULL));
+    if (__kmp_tasking_mode != tskm_immediate_exec)
+      __kmp_task_team_wait(this_thr, team USE_ITT_BUILD_ARG(NULL));
+    if (__kmp_omp_cancellation) {
+      kmp_int32 cancel_request = KMP_ATOMIC_LD_RLX(&team->t.t_cancel_request);
+      // Reset cancellation flag for worksharing constructs
+      if (cancel_request == cancel_loop || cancel_request == cancel_sections) {
+        KMP_ATOMIC_ST_RLX(&team->t.t_cancel_request, cancel_noreq);
+      }
+    }
+  }
+  // any release goes with the linear gather, the threads wait on their b_go
+  if (__kmp_barrier_release_branch_bits[bt])
+    __kmp_hyper_barrier_release_bits(
+        bt, this_thr, gtid, tid, FALSE,
+        __kmp_barrier_release_branch_bits[bt] USE_ITT_BUILD_ARG(NULL));
+  else
+    __kmp_linear_barrier_release(bt, this_thr, gtid, tid,
+                                 FALSE USE_ITT_BUILD_ARG(NULL));
+  if (__kmp_tasking_mode != tskm_immediate_exec)
+    __kmp_task_team_sync(this_thr, team);
+  KA_TRACE(15, ("__kmp_split_barrier_wait: T#%d(%d:%d) is leaving\n", gtid,
+                team->t.t_id, tid));
+}
+
 void __kmp_join_barrier(int gtid) {
   KMP_TIME_PARTITIONED_BLOCK(OMP_join_barrier);
   KMP_SET_THREAD_STATE_BLOCK(FORK_JOIN_BARRIER);
@@ -2276,6 +2908,11 @@ void __kmp_join_barrier(int gtid) {
                               NULL USE_ITT_BUILD_ARG(itt_sync_obj));
     break;
   }
+  case bp_tournament_bar: {
+    __kmp_tournament_barrier_gather(bs_forkjoin_barrier, this_thr, gtid, tid,
+                                    NULL USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
   case bp_hyper_bar: {
     KMP_ASSERT(__kmp_barrier_gather_branch_bits[bs_forkjoin_barrier]);
     __kmp_hyper_barrier_gather(bs_forkjoin_barrier, this_thr, gtid, tid,
@@ -2469,6 +3106,12 @@ void __kmp_fork_barrier(int gtid, int tid) {
                                TRUE USE_ITT_BUILD_ARG(NULL));
     break;
   }
+  case bp_dissem_bar:
+  case bp_tournament_bar: {
+    __kmp_round_barrier_release(bs_forkjoin_barrier, this_thr, gtid, tid,
+                                TRUE USE_ITT_BUILD_ARG(itt_sync_obj));
+    break;
+  }
   case bp_hyper_bar: {
     KMP_ASSERT(__kmp_barrier_release_branch_bits[bs_forkjoin_barrier]);
     __kmp_hyper_barrier_release(bs_forkjoin_barrier, this_thr, gtid, tid,
@@ -2526,7 +3169,7 @@ void __kmp_fork_barrier(int gtid, int tid) {
 #endif
 
   // Early exit for reaping threads releasing forkjoin barrier
-  if (TCR_4(__kmp_global.g.g_done)) {
+  if (__kmp_worker_exiting(this_thr)) {
     this_thr->th.th_task_team = NULL;
 
 #if USE_ITT_BUILD && USE_ITT_NOTIFY
@@ -104,8 +104,300 @@ enum { // values for steal_flag (possible states of private per-loop buffer)
   // 3 -> 2 owner only, async
   // 3 -> 0 last thread finishing the loop, async
 };
+
+// The pair (count, ub) of a static_steal buffer is updated as a whole with a
+// CAS on its N 8-byte words: N is 1 for 4-byte induction variables and 2 for
+// 8-byte ones. The latter needs a 16-byte CAS. Without it count and ub are
+// updated separately: the owner takes chunks by incrementing count, thieves
+// lower ub under the per-buffer steal_lock, and the owner only takes the lock
+// when it may have raced with a thief for the last chunks.
+static inline bool __kmp_steal_use_cas128() {
+#if KMP_HAVE_CAS128 && KMP_ARCH_X86_64
+  return __kmp_cpuinfo.flags.cmpxchg16b;
+#else
+  return KMP_HAVE_CAS128;
+#endif
+}
+
+// Atomic access to count or ub of the split protocol, plain 8-byte loads and
+// stores may tear on 32-bit targets
+static inline kmp_uint64 __kmp_steal_read64(volatile void *p) {
+#if KMP_32_BIT_ARCH
+  return KMP_TEST_THEN_ADD64((volatile kmp_int64 *)p, 0LL);
+#else
+  return *(volatile kmp_uint64 *)p;
+#endif
+}
+
+// The store is ordered before the loads that follow it
+static inline void __kmp_steal_write64(volatile void *p, kmp_uint64 v) {
+  KMP_XCHG_FIXED64((volatile kmp_int64 *)p, (kmp_int64)v);
+  KMP_MB();
+}
+
+// Read the pair, a torn value only makes the following CAS fail
+template <int N>
+static inline void __kmp_steal_pair_read(kmp_int64 (&dst)[N],
+                                         volatile void *src) {
+  for (int i = 0; i < N; ++i)
+    dst[i] = ((volatile kmp_int64 *)src)[i];
+}
+
+// Write the pair of the inactive (THIEF) own buffer
+template <int N>
+static inline void __kmp_steal_pair_write(volatile void *dst,
+                                          const kmp_int64 (&src)[N]) {
+#if KMP_ARCH_X86
+  if (N == 1) {
+    KMP_XCHG_FIXED64((volatile kmp_int64 *)dst, src[0]);
+    return;
+  }
+#endif
+  for (int i = 0; i < N; ++i)
+    ((volatile kmp_int64 *)dst)[i] = src[i];
+}
+
+template <int N>
+static inline bool __kmp_steal_pair_cas(volatile void *dst,
+                                        const kmp_int64 (&cv)[N],
+                                        const kmp_int64 (&sv)[N]) {
+  if (N == 1)
+    return KMP_COMPARE_AND_STORE_REL64((volatile kmp_int64 *)dst, cv[0],
+                                       sv[0]);
+#if KMP_HAVE_CAS128
+  return KMP_COMPARE_AND_STORE_REL128(dst, cv, sv);
+#else
+  KMP_ASSERT(0); // 8-byte induction variables use steal_lock
+  return false;
+#endif
+}
 #endif
 
+// Learning auto schedule (KMP_AUTO_LEARN). A schedule(auto) loop is keyed by
+// its ident_t, the team size and the log2 of its trip count. Its first
+// executions try each candidate schedule in turn and record the time the
+// slowest thread spent in the loop, the imbalance between the threads and the
+// number of chunks they took. Later executions use the candidate with the
+// least average time, whose statistics keep being updated.
+#define KMP_AUTO_LEARN_TABLE_BITS 10
+#define KMP_AUTO_LEARN_TABLE_SIZE (1 << KMP_AUTO_LEARN_TABLE_BITS)
+#define KMP_AUTO_LEARN_PROBES 16 // entries searched before giving up
+#define KMP_AUTO_LEARN_SAMPLES 2 // executions of each candidate to start with
+
+typedef struct kmp_auto_learn_arm {
+  enum sched_type sched;
+  int chunk_div; // chunk is trip count / (nproc * chunk_div), 0 for default
+  char const *name;
+} kmp_auto_learn_arm_t;
+
+static const kmp_auto_learn_arm_t __kmp_auto_learn_arms[] = {
+    {kmp_sch_static, 0, "static"},
+#if KMP_STATIC_STEAL_ENABLED
+    {kmp_sch_static_steal, 16, "nonmonotonic:dynamic"},
+#endif
+    {kmp_sch_guided_chunked, 0, "guided"},
+    {kmp_sch_dynamic_chunked, 64, "dynamic"},
+    {kmp_sch_dynamic_chunked, 8, "dynamic"},
+};
+#define KMP_AUTO_LEARN_ARMS                                                    \
+  ((int)(sizeof(__kmp_auto_learn_arms) / sizeof(__kmp_auto_learn_arms[0])))
+
+typedef struct kmp_auto_learn_entry {
+  std::atomic<kmp_uint64> key; // loop, team size, trip count log2; 0 if free
+  std::atomic<kmp_int32> reported; // choice reported by KMP_AUTO_LEARN_REPORT
+  struct {
+    std::atomic<kmp_int32> samples; // executions recorded
+    std::atomic<kmp_uint64> time; // sum of loop times (ns)
+    std::atomic<kmp_uint64> imbalance; // sum of imbalances (percent)
+    std::atomic<kmp_uint64> chunks; // sum of chunks per thread
+  } arm[KMP_AUTO_LEARN_ARMS];
+} kmp_auto_learn_entry_t;
+
+static kmp_auto_learn_entry_t
+    __kmp_auto_learn_table[KMP_AUTO_LEARN_TABLE_SIZE];
+
+// Find or create the entry of a loop, NULL if the table has no room for it
+static kmp_auto_learn_entry_t *__kmp_auto_learn_find(ident_t *loc, int nproc,
+                                                     kmp_uint64 tc) {
+  int tc_log = 0;
+  while (tc >>= 1)
+    ++tc_log;
+  // user space addresses fit in the low 47 bits
+  kmp_uint64 key = (kmp_uint64)(kmp_uintptr_t)loc ^
+                   ((kmp_uint64)(nproc & 0x7ff) << 47) ^
+                   ((kmp_uint64)tc_log << 58);
+  kmp_uint32 hash = (kmp_uint32)((key * 0x9E3779B97F4A7C15ULL) >>
+                                 (64 - KMP_AUTO_LEARN_TABLE_BITS));
+  for (int i = 0; i < KMP_AUTO_LEARN_PROBES; ++i) {
+    kmp_auto_learn_entry_t *e =
+        &__kmp_auto_learn_table[(hash + i) & (KMP_AUTO_LEARN_TABLE_SIZE - 1)];
+    kmp_uint64 k = e->key.load(std::memory_order_acquire);
+    if (k == 0 && e->key.compare_exchange_strong(k, key))
+      return e;
+    if (k == key)
+      return e;
+  }
+  return NULL;
+}
+
+// The candidate to use for the next execution of the loop
+static int __kmp_auto_learn_choose(kmp_auto_learn_entry_t *e) {
+  int best = 0;
+  double best_time = 0;
+  for (int i = 0; i < KMP_AUTO_LEARN_ARMS; ++i) {
+    kmp_int32 samples = e->arm[i].samples.load(std::memory_order_acquire);
+    if (samples < KMP_AUTO_LEARN_SAMPLES)
+      return i; // still trying the candidates
+    double time = (double)e->arm[i].time.load(std::memory_order_relaxed);
+    time /= samples;
+    if (i == 0 || time < best_time) {
+      best = i;
+      best_time = time;
+    }
+  }
+  return best;
+}
+
+static void __kmp_auto_learn_print(kmp_auto_learn_entry_t *e, int arm,
+                                   ident_t *loc, int nproc, kmp_uint64 tc,
+                                   kmp_int32 chunk) {
+  int tc_log = 0;
+  while (tc >>= 1)
+    ++tc_log;
+  kmp_int32 samples = e->arm[arm].samples.load(std::memory_order_relaxed);
+  int time = (int)(e->arm[arm].time.load(std::memory_order_relaxed) / 1000 /
+                   samples);
+  int imbalance =
+      (int)(e->arm[arm].imbalance.load(std::memory_order_relaxed) / samples);
+  int chunks =
+      (int)(e->arm[arm].chunks.load(std::memory_order_relaxed) / samples);
+  char *src_loc;
+  if (loc->psource) {
+    kmp_str_loc_t str_loc = __kmp_str_loc_init(loc->psource, false);
+    src_loc = __kmp_str_format("%s:%d", str_loc.file, str_loc.line);
+    __kmp_str_loc_free(&str_loc);
+  } else {
+    src_loc = __kmp_str_format("unknown");
+  }
+  KMP_INFORM(AutoLearnSchedule, "KMP_AUTO_LEARN_REPORT", src_loc, nproc,
+             tc_log, __kmp_auto_learn_arms[arm].name, chunk, time, imbalance,
+             chunks);
+  __kmp_str_free(&src_loc);
+}
+
+// Pick the schedule of a schedule(auto) loop. The first thread of the team to
+// get here chooses the candidate and publishes it in the shared buffer, the
+// others use the same one.
+template <typename T>
+static void __kmp_auto_learn_init(ident_t *loc, kmp_info_t *th,
+                                  dispatch_shared_info_template<T> volatile *sh,
+                                  enum sched_type *schedule, T lb, T ub,
+                                  typename traits_t<T>::signed_t st,
+                                  typename traits_t<T>::signed_t *chunk) {
+  typedef typename traits_t<T>::unsigned_t UT;
+  kmp_disp_t *disp = th->th.th_dispatch;
+  int nproc = th->th.th_team_nproc;
+  kmp_auto_learn_entry_t *e = NULL;
+  kmp_uint64 tc = 0;
+  kmp_int32 arm;
+
+  if (st > 0 && ub >= lb)
+    tc = (UT)(ub - lb) / st + 1;
+  else if (st < 0 && lb >= ub)
+    tc = (UT)(lb - ub) / (UT)(-st) + 1;
+  if (loc != NULL && tc != 0)
+    e = __kmp_auto_learn_find(loc, nproc, tc);
+
+  arm = sh->auto_arm;
+  if (arm == 0) {
+    // KMP_AUTO_LEARN_ARMS stands for __kmp_auto, used for loops not learned
+    kmp_int32 mine = e ? __kmp_auto_learn_choose(e) : KMP_AUTO_LEARN_ARMS;
+    if (KMP_COMPARE_AND_STORE_ACQ32(&sh->auto_arm, 0, mine + 1)) {
+      arm = mine + 1;
+      if (__kmp_auto_learn_report && e &&
+          e->arm[mine].samples >= KMP_AUTO_LEARN_SAMPLES &&
+          e->reported.load(std::memory_order_relaxed) == 0 &&
+          e->reported.exchange(1) == 0) {
+        int div = __kmp_auto_learn_arms[mine].chunk_div;
+        kmp_int32 ch = div ? (kmp_int32)KMP_MAX(tc / ((kmp_uint64)nproc * div),
+                                                (kmp_uint64)1)
+                           : 0;
+        __kmp_auto_learn_print(e, mine, loc, nproc, tc, ch);
+      }
+    } else {
+      arm = sh->auto_arm;
+    }
+  }
+  --arm;
+  if (arm == KMP_AUTO_LEARN_ARMS) {
+    *schedule = kmp_sch_auto;
+    disp->th_auto_entry = NULL;
+    return;
+  }
+
+  const kmp_auto_learn_arm_t *cand = &__kmp_auto_learn_arms[arm];
+  *schedule = cand->sched;
+  if (cand->sched == kmp_sch_dynamic_chunked)
+    SCHEDULE_SET_MODIFIERS(*schedule, kmp_sch_modifier_monotonic);
+  *chunk = 0;
+  if (cand->chunk_div) {
+    kmp_uint64 c = tc / ((kmp_uint64)nproc * cand->chunk_div);
+    *chunk = (typename traits_t<T>::signed_t)KMP_MIN(
+        KMP_MAX(c, (kmp_uint64)1), (kmp_uint64)KMP_INT_MAX);
+  }
+  disp->th_auto_entry = e;
+  disp->th_auto_chunks = 0;
+  __kmp_read_system_time(&disp->th_auto_start);
+}
+
+// Add the time and the chunk count of this thread to the loop totals before
+// it leaves the loop. Returns the entry of the loop, NULL if not learning.
+template <typename T>
+static kmp_auto_learn_entry_t *
+__kmp_auto_learn_fini(kmp_info_t *th,
+                      dispatch_shared_info_template<T> volatile *sh) {
+  kmp_disp_t *disp = th->th.th_dispatch;
+  kmp_auto_learn_entry_t *e = (kmp_auto_learn_entry_t *)disp->th_auto_entry;
+  if (e) {
+    double now;
+    __kmp_read_system_time(&now);
+    kmp_int64 time = (kmp_int64)((now - disp->th_auto_start) * 1e9);
+    kmp_int64 max = sh->auto_time_max;
+    KMP_TEST_THEN_ADD64(&sh->auto_time_sum, time);
+    KMP_TEST_THEN_ADD64(&sh->auto_chunks, disp->th_auto_chunks);
+    while (time > max &&
+           !KMP_COMPARE_AND_STORE_ACQ64(&sh->auto_time_max, max, time)) {
+      max = sh->auto_time_max;
+    }
+    disp->th_auto_entry = NULL;
+  }
+  return e;
+}
+
+// Called by the last thread to leave the loop: record the loop totals in its
+// entry and reset them for the next loop using the shared buffer.
+template <typename T>
+static void __kmp_auto_learn_done(kmp_auto_learn_entry_t *e,
+                                  dispatch_shared_info_template<T> volatile *sh,
+                                  int nproc) {
+  int arm = sh->auto_arm - 1;
+  kmp_int64 max = sh->auto_time_max;
+  if (e && arm < KMP_AUTO_LEARN_ARMS) {
+    kmp_uint64 imbalance = 0;
+    if (max > 0)
+      imbalance = 100 - (kmp_uint64)(sh->auto_time_sum * 100 / (nproc * max));
+    e->arm[arm].time.fetch_add(max, std::memory_order_relaxed);
+    e->arm[arm].imbalance.fetch_add(imbalance, std::memory_order_relaxed);
+    e->arm[arm].chunks.fetch_add(sh->auto_chunks / nproc,
+                                 std::memory_order_relaxed);
+    e->arm[arm].samples.fetch_add(1, std::memory_order_release);
+  }
+  sh->auto_arm = 0;
+  sh->auto_time_sum = 0;
+  sh->auto_time_max = 0;
+  sh->auto_chunks = 0;
+}
+
 // Initialize a dispatch_private_info_template<T> buffer for a particular
 // type of schedule,chunk.  The loop description is found in lb (lower bound),
 // ub (upper bound), and st (stride).  nproc is the number of threads relevant
@@ -380,13 +672,17 @@ void __kmp_dispatch_init_algorithm(ident_t *loc, int gtid,
       kmp_uint32 old = UNUSED;
       int claimed = pr->steal_flag.compare_exchange_strong(old, CLAIMED);
       if (traits_t<T>::type_size > 4) {
-        // AC: TODO: check if 16-byte CAS available and use it to
-        // improve performance (probably wait for explicit request
-        // before spending time on this).
-        // For now use dynamically allocated per-private-buffer lock,
-        // free memory in __kmp_dispatch_next when status==0.
-        pr->u.p.steal_lock = (kmp_lock_t *)__kmp_allocate(sizeof(kmp_lock_t));
-        __kmp_init_lock(pr->u.p.steal_lock);
+        if (__kmp_steal_use_cas128()) {
+          // the pair (count, ub) is updated with 16-byte CAS
+          KMP_DEBUG_ASSERT(((kmp_uintptr_t)&pr->u.p.count & 15) == 0);
+        } else {
+          // No 16-byte CAS: thieves use dynamically allocated
+          // per-private-buffer lock, free memory in __kmp_dispatch_next when
+          // status==0.
+          pr->u.p.steal_lock =
+              (kmp_lock_t *)__kmp_allocate(sizeof(kmp_lock_t));
+          __kmp_init_lock(pr->u.p.steal_lock);
+        }
       }
       small_chunk = ntc / nproc;
       extras = ntc % nproc;
@@ -669,6 +965,9 @@ void __kmp_dispatch_init_algorithm(ident_t *loc, int gtid,
   case kmp_sch_static_chunked:
   case kmp_sch_dynamic_chunked:
   dynamic_init:
+    // No batch of chunks claimed yet (see KMP_DYNAMIC_BATCH)
+    pr->u.p.parm3 = 0;
+    pr->u.p.parm4 = 0;
     if (tc == 0)
       break;
     if (pr->u.p.parm1 <= 0)
@@ -919,6 +1218,17 @@ __kmp_dispatch_init(ident_t *loc, int gtid, enum sched_type schedule, T lb,
                      "sh->buffer_index:%d\n",
                      gtid, my_buffer_index, sh->buffer_index));
     }
+    if (__kmp_auto_learn) {
+      enum sched_type auto_sched = SCHEDULE_WITHOUT_MODIFIERS(schedule);
+      if (auto_sched == kmp_sch_runtime)
+        auto_sched = SCHEDULE_WITHOUT_MODIFIERS(team->t.t_sched.r_sched_type);
+#if KMP_USE_HIER_SCHED
+      if (pr->flags.use_hier)
+        auto_sched = kmp_sch_default;
+#endif
+      if (auto_sched == kmp_sch_auto)
+        __kmp_auto_learn_init<T>(loc, th, sh, &schedule, lb, ub, st, &chunk);
+    }
   }
 
   __kmp_dispatch_init_algorithm(loc, gtid, pr, schedule, lb, ub, st,
@@ -1056,8 +1366,11 @@ static void __kmp_dispatch_finish(int gtid, ident_t *loc) {
       }
 #endif
 
-      __kmp_wait<UT>(&sh->u.s.ordered_iteration, lower,
-                     __kmp_ge<UT> USE_ITT_BUILD_ARG(NULL));
+      if (sh->ordered_slots)
+        __kmp_ordered_wait<UT>(sh, lower);
+      else
+        __kmp_wait<UT>(&sh->u.s.ordered_iteration, lower,
+                       __kmp_ge<UT> USE_ITT_BUILD_ARG(NULL));
       KMP_MB(); /* is this necessary? */
 #ifdef KMP_DEBUG
       {
@@ -1071,7 +1384,10 @@ static void __kmp_dispatch_finish(int gtid, ident_t *loc) {
       }
 #endif
 
-      test_then_inc<ST>((volatile ST *)&sh->u.s.ordered_iteration);
+      UT done =
+          (UT)test_then_inc<ST>((volatile ST *)&sh->u.s.ordered_iteration) + 1;
+      if (sh->ordered_slots && done > pr->u.p.ordered_upper)
+        __kmp_ordered_notify<UT>(sh, done);
     } // if
   } // if
   KD_TRACE(100, ("__kmp_dispatch_finish: T#%d returned\n", gtid));
@@ -1124,8 +1440,11 @@ static void __kmp_dispatch_finish_chunk(int gtid, ident_t *loc) {
       }
 #endif
 
-      __kmp_wait<UT>(&sh->u.s.ordered_iteration, lower,
-                     __kmp_ge<UT> USE_ITT_BUILD_ARG(NULL));
+      if (sh->ordered_slots)
+        __kmp_ordered_wait<UT>(sh, lower);
+      else
+        __kmp_wait<UT>(&sh->u.s.ordered_iteration, lower,
+                       __kmp_ge<UT> USE_ITT_BUILD_ARG(NULL));
 
       KMP_MB(); /* is this necessary? */
       KD_TRACE(1000, ("__kmp_dispatch_finish_chunk: T#%d resetting "
@@ -1149,6 +1468,9 @@ static void __kmp_dispatch_finish_chunk(int gtid, ident_t *loc) {
 #endif
 
       test_then_add<ST>((volatile ST *)&sh->u.s.ordered_iteration, inc);
+      // the chunk is done, hand over to the thread of the next one
+      if (sh->ordered_slots)
+        __kmp_ordered_notify<UT>(sh, upper + 1);
     }
     //        }
   }
@@ -1213,18 +1535,23 @@ int __kmp_dispatch_next_algorithm(int gtid,
 
     trip = pr->u.p.tc - 1;
 
-    if (traits_t<T>::type_size > 4) {
-      // use lock for 8-byte induction variable.
-      // TODO (optional): check presence and use 16-byte CAS
+    if (traits_t<T>::type_size > 4 && !__kmp_steal_use_cas128()) {
+      // split count/ub for 8-byte induction variable without 16-byte CAS
       kmp_lock_t *lck = pr->u.p.steal_lock;
       KMP_DEBUG_ASSERT(lck != NULL);
       if (pr->u.p.count < (UT)pr->u.p.ub) {
         KMP_DEBUG_ASSERT(pr->steal_flag == READY);
-        __kmp_acquire_lock(lck, gtid);
-        // try to get own chunk of iterations
-        init = (pr->u.p.count)++;
-        status = (init < (UT)pr->u.p.ub);
-        __kmp_release_lock(lck, gtid);
+        // try to get own chunk of iterations, the increment is ordered before
+        // the read of ub
+        init = KMP_TEST_THEN_INC64((volatile kmp_int64 *)&pr->u.p.count);
+        KMP_MB();
+        status = (init < (UT)__kmp_steal_read64(&pr->u.p.ub));
+        if (!status) {
+          // a thief may have lowered ub and then given the chunks back
+          __kmp_acquire_lock(lck, gtid);
+          status = (init < (UT)pr->u.p.ub);
+          __kmp_release_lock(lck, gtid);
+        }
       } else {
         status = 0; // no own chunks
       }
@@ -1298,25 +1625,36 @@ int __kmp_dispatch_next_algorithm(int gtid,
           KMP_ASSERT(lckv != NULL);
           __kmp_acquire_lock(lckv, gtid);
           limit = v->u.p.ub; // keep initial ub
-          if (v->u.p.count >= limit) {
+          init = __kmp_steal_read64(&v->u.p.count);
+          if (init >= limit) {
             __kmp_release_lock(lckv, gtid);
             pr->u.p.parm4 = (victimId + 1) % nproc; // shift start victim tid
             continue; // no chunks to steal, try next victim
           }
 
-          // stealing succeded, reduce victim's ub by 1/4 of undone chunks
+          // reduce victim's ub by 1/4 of undone chunks
           // TODO: is this heuristics good enough??
-          remaining = limit - v->u.p.count;
+          remaining = limit - init;
           if (remaining > 7) {
             // steal 1/4 of remaining
-            KMP_COUNT_DEVELOPER_VALUE(FOR_static_steal_stolen, remaining >> 2);
-            init = (v->u.p.ub -= (remaining >> 2));
+            init = limit - (remaining >> 2);
           } else {
             // steal 1 chunk of 1..7 remaining
-            KMP_COUNT_DEVELOPER_VALUE(FOR_static_steal_stolen, 1);
-            init = (v->u.p.ub -= 1);
+            init = limit - 1;
+          }
+          __kmp_steal_write64(&v->u.p.ub, init);
+          // the victim may have taken some of the chunks meanwhile, give
+          // them back then; the victim retries under the lock if it has seen
+          // the lowered ub
+          if (__kmp_steal_read64(&v->u.p.count) > (UT)init) {
+            __kmp_steal_write64(&v->u.p.ub, limit);
+            __kmp_release_lock(lckv, gtid);
+            pr->u.p.parm4 = (victimId + 1) % nproc; // shift start victim tid
+            continue; // no chunks to steal, try next victim
           }
           __kmp_release_lock(lckv, gtid);
+          // stealing succeded
+          KMP_COUNT_DEVELOPER_VALUE(FOR_static_steal_stolen, limit - init);
 #ifdef KMP_DEBUG
           {
             char *buff;
@@ -1343,28 +1681,26 @@ int __kmp_dispatch_next_algorithm(int gtid,
         } // while (search for victim)
       } // if (try to find victim and steal)
     } else {
-      // 4-byte induction variable, use 8-byte CAS for pair (count, ub)
-      // as all operations on pair (count, ub) must be done atomically
+      // use 8-byte CAS (16-byte CAS for 8-byte induction variable) for pair
+      // (count, ub) as all operations on pair (count, ub) must be done
+      // atomically
       typedef union {
         struct {
           UT count;
           T ub;
         } p;
-        kmp_int64 b;
-      } union_i4;
-      union_i4 vold, vnew;
+        kmp_int64 b[sizeof(T) / 4];
+      } union_pair;
+      union_pair vold, vnew;
       if (pr->u.p.count < (UT)pr->u.p.ub) {
         KMP_DEBUG_ASSERT(pr->steal_flag == READY);
-        vold.b = *(volatile kmp_int64 *)(&pr->u.p.count);
-        vnew.b = vold.b;
+        __kmp_steal_pair_read(vold.b, &pr->u.p.count);
+        vnew = vold;
         vnew.p.count++; // get chunk from head of self range
-        while (!KMP_COMPARE_AND_STORE_REL64(
-            (volatile kmp_int64 *)&pr->u.p.count,
-            *VOLATILE_CAST(kmp_int64 *) & vold.b,
-            *VOLATILE_CAST(kmp_int64 *) & vnew.b)) {
+        while (!__kmp_steal_pair_cas(&pr->u.p.count, vold.b, vnew.b)) {
           KMP_CPU_PAUSE();
-          vold.b = *(volatile kmp_int64 *)(&pr->u.p.count);
-          vnew.b = vold.b;
+          __kmp_steal_pair_read(vold.b, &pr->u.p.count);
+          vnew = vold;
           vnew.p.count++;
         }
         init = vold.p.count;
@@ -1411,11 +1747,7 @@ int __kmp_dispatch_next_algorithm(int gtid,
               vnew.p.count = init + 1;
               vnew.p.ub = init + small_chunk + (id < extras ? 1 : 0);
               // write pair (count, ub) at once atomically
-#if KMP_ARCH_X86
-              KMP_XCHG_FIXED64((volatile kmp_int64 *)(&pr->u.p.count), vnew.b);
-#else
-              *(volatile kmp_int64 *)(&pr->u.p.count) = vnew.b;
-#endif
+              __kmp_steal_pair_write(&pr->u.p.count, vnew.b);
               pr->u.p.parm4 = (id + 1) % nproc; // remember neighbour tid
               // no need to initialize other thread invariants: lb, st, etc.
 #ifdef KMP_DEBUG
@@ -1438,13 +1770,13 @@ int __kmp_dispatch_next_algorithm(int gtid,
           }
           while (1) { // CAS loop with check if victim still has enough chunks
             // many threads may be stealing concurrently from same victim
-            vold.b = *(volatile kmp_int64 *)(&v->u.p.count);
+            __kmp_steal_pair_read(vold.b, &v->u.p.count);
             if (KMP_ATOMIC_LD_ACQ(&v->steal_flag) != READY ||
                 vold.p.count >= (UT)vold.p.ub) {
               pr->u.p.parm4 = (victimId + 1) % nproc; // shift start victim id
               break; // no chunks to steal, try next victim
             }
-            vnew.b = vold.b;
+            vnew = vold;
             remaining = vold.p.ub - vold.p.count;
             // try to steal 1/4 of remaining
             // TODO: is this heuristics good enough??
@@ -1454,10 +1786,7 @@ int __kmp_dispatch_next_algorithm(int gtid,
               vnew.p.ub -= 1; // steal 1 chunk of 1..7 remaining
             }
             KMP_DEBUG_ASSERT(vnew.p.ub * (UT)chunk <= trip);
-            if (KMP_COMPARE_AND_STORE_REL64(
-                    (volatile kmp_int64 *)&v->u.p.count,
-                    *VOLATILE_CAST(kmp_int64 *) & vold.b,
-                    *VOLATILE_CAST(kmp_int64 *) & vnew.b)) {
+            if (__kmp_steal_pair_cas(&v->u.p.count, vold.b, vnew.b)) {
               // stealing succedded
 #ifdef KMP_DEBUG
               {
@@ -1478,11 +1807,7 @@ int __kmp_dispatch_next_algorithm(int gtid,
               // now update own count and ub
               init = vnew.p.ub;
               vold.p.count = init + 1;
-#if KMP_ARCH_X86
-              KMP_XCHG_FIXED64((volatile kmp_int64 *)(&pr->u.p.count), vold.b);
-#else
-              *(volatile kmp_int64 *)(&pr->u.p.count) = vold.b;
-#endif
+              __kmp_steal_pair_write(&pr->u.p.count, vold.b);
               // activate non-empty buffer and let others steal from us
               if (vold.p.count < (UT)vold.p.ub)
                 KMP_ATOMIC_ST_REL(&pr->steal_flag, READY);
@@ -1492,7 +1817,7 @@ int __kmp_dispatch_next_algorithm(int gtid,
           } // while (try to steal from particular victim)
         } // while (search for victim)
       } // if (try to find victim and steal)
-    } // if (4-byte induction variable)
+    } // if (lock or CAS for pair (count, ub))
     if (!status) {
       *p_lb = 0;
       *p_ub = 0;
@@ -1595,7 +1920,33 @@ int __kmp_dispatch_next_algorithm(int gtid,
         ("__kmp_dispatch_next_algorithm: T#%d kmp_sch_dynamic_chunked case\n",
          gtid));
 
-    chunk_number = test_then_inc_acq<ST>((volatile ST *)&sh->u.s.iteration);
+    if (__kmp_dynamic_batch > 1 && !pr->flags.ordered) {
+      // Claim several chunks with one update of the shared counter and hand
+      // them out from the private buffer: parm3 is the next chunk of the
+      // batch, parm4 the end of the batch.  The batch size follows guided,
+      // estimating the remaining chunks from the end of the previous batch
+      // of this thread, so it shrinks as the loop nears its end.
+      if ((UT)pr->u.p.parm3 < (UT)pr->u.p.parm4) {
+        chunk_number = (UT)pr->u.p.parm3;
+      } else {
+        UT batch = 1;
+        UT left = nchunks - (UT)pr->u.p.parm4;
+        if ((UT)pr->u.p.parm4 < nchunks)
+          batch = left / (UT)(guided_int_param * nproc);
+        if (batch > (UT)__kmp_dynamic_batch)
+          batch = (UT)__kmp_dynamic_batch;
+        else if (batch < 1)
+          batch = 1;
+        chunk_number =
+            test_then_add<ST>((volatile ST *)&sh->u.s.iteration, (ST)batch);
+        pr->u.p.parm4 = (T)(chunk_number + batch < nchunks
+                                ? chunk_number + batch
+                                : nchunks);
+      }
+      pr->u.p.parm3 = (T)(chunk_number + 1);
+    } else {
+      chunk_number = test_then_inc_acq<ST>((volatile ST *)&sh->u.s.iteration);
+    }
     status = (chunk_number < nchunks);
     if (!status) {
       *p_lb = 0;
@@ -2184,6 +2535,7 @@ static int __kmp_dispatch_next(ident_t *loc, int gtid, kmp_int32 *p_last,
     // status == 0: no more iterations to execute
     if (status == 0) {
       ST num_done;
+      kmp_auto_learn_entry_t *auto_entry = __kmp_auto_learn_fini<T>(th, sh);
       num_done = test_then_inc<ST>(&sh->u.s.num_done);
 #ifdef KMP_DEBUG
       {
@@ -2213,7 +2565,7 @@ static int __kmp_dispatch_next(ident_t *loc, int gtid, kmp_int32 *p_last,
                     &team->t.t_dispatch[i].th_disp_buffer[idx]);
             KMP_ASSERT(buf->steal_flag == THIEF); // buffer must be inactive
             KMP_ATOMIC_ST_RLX(&buf->steal_flag, UNUSED);
-            if (traits_t<T>::type_size > 4) {
+            if (traits_t<T>::type_size > 4 && !__kmp_steal_use_cas128()) {
               // destroy locks used for stealing
               kmp_lock_t *lck = buf->u.p.steal_lock;
               KMP_ASSERT(lck != NULL);
@@ -2234,8 +2586,15 @@ static int __kmp_dispatch_next(ident_t *loc, int gtid, kmp_int32 *p_last,
         /* TODO replace with general release procedure? */
         if (pr->flags.ordered) {
           sh->u.s.ordered_iteration = 0;
+          if (sh->ordered_slots) {
+            for (kmp_uint32 i = 0; i <= sh->ordered_slots_mask; ++i)
+              sh->ordered_slots[i].ticket = 0;
+          }
         }
 
+        if (sh->auto_arm)
+          __kmp_auto_learn_done<T>(auto_entry, sh, th->th.th_team_nproc);
+
         sh->buffer_index += __kmp_dispatch_num_buffers;
         KD_TRACE(100, ("__kmp_dispatch_next: T#%d change buffer_index:%d\n",
                        gtid, sh->buffer_index));
@@ -2259,6 +2618,8 @@ static int __kmp_dispatch_next(ident_t *loc, int gtid, kmp_int32 *p_last,
       pr->u.p.last_upper = pr->u.p.ub;
     }
 #endif /* KMP_OS_WINDOWS */
+    if (status != 0 && th->th.th_dispatch->th_auto_entry)
+      th->th.th_dispatch->th_auto_chunks++; // learning auto schedule
     if (p_last != NULL && status != 0)
       *p_last = last;
   } // if
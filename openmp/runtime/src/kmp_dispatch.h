@@ -173,6 +173,12 @@ template <typename T> struct dispatch_shared_info_template {
   volatile kmp_int32 doacross_buf_idx; // teamwise index
   kmp_uint32 *doacross_flags; // array of iteration flags (0/1)
   kmp_int32 doacross_num_done; // count finished threads
+  volatile kmp_int32 auto_arm; // learning auto schedule: candidate used + 1
+  volatile kmp_int64 auto_time_sum; // learning auto: sum of loop times
+  volatile kmp_int64 auto_time_max; // learning auto: maximum loop time
+  volatile kmp_int64 auto_chunks; // learning auto: sum of chunk counts
+  kmp_ordered_slot_t *ordered_slots; // ordered tickets: slots of the waiters
+  kmp_uint32 ordered_slots_mask; // ordered tickets: number of slots - 1
 #if KMP_USE_HIER_SCHED
   kmp_hier_t<T> *hier;
 #endif
@@ -313,6 +319,28 @@ static UT __kmp_wait(volatile UT *spinner, UT checker,
   return r;
 }
 
+// KMP_ORDERED_TICKETS: wait until the ordered iterations before ticket are
+// done.  The thread spins on the slot of its ticket, which only the thread
+// finishing iteration ticket - 1 writes to.
+template <typename UT>
+static __forceinline void
+__kmp_ordered_wait(dispatch_shared_info_template<UT> volatile *sh, UT ticket) {
+  kmp_ordered_slot_t *slot =
+      &sh->ordered_slots[ticket & (UT)sh->ordered_slots_mask];
+  __kmp_wait<kmp_uint64>(&slot->ticket, (kmp_uint64)ticket,
+                         __kmp_ge<kmp_uint64> USE_ITT_BUILD_ARG(NULL));
+}
+
+// KMP_ORDERED_TICKETS: let the thread waiting for ticket go
+template <typename UT>
+static __forceinline void
+__kmp_ordered_notify(dispatch_shared_info_template<UT> volatile *sh,
+                     UT ticket) {
+  KMP_MB(); /* Flush all pending memory write invalidates.  */
+  TCW_8(sh->ordered_slots[ticket & (UT)sh->ordered_slots_mask].ticket,
+        (kmp_uint64)ticket);
+}
+
 /* ------------------------------------------------------------------------ */
 /* ------------------------------------------------------------------------ */
 
@@ -373,8 +401,11 @@ void __kmp_dispatch_deo(int *gtid_ref, int *cid_ref, ident_t *loc_ref) {
       __kmp_str_free(&buff);
     }
 #endif
-    __kmp_wait<UT>(&sh->u.s.ordered_iteration, lower,
-                   __kmp_ge<UT> USE_ITT_BUILD_ARG(NULL));
+    if (sh->ordered_slots)
+      __kmp_ordered_wait<UT>(sh, lower);
+    else
+      __kmp_wait<UT>(&sh->u.s.ordered_iteration, lower,
+                     __kmp_ge<UT> USE_ITT_BUILD_ARG(NULL));
     KMP_MB(); /* is this necessary? */
 #ifdef KMP_DEBUG
     {
@@ -444,7 +475,11 @@ void __kmp_dispatch_dxo(int *gtid_ref, int *cid_ref, ident_t *loc_ref) {
     KMP_MB(); /* Flush all pending memory write invalidates.  */
 
     /* TODO use general release procedure? */
-    test_then_inc<ST>((volatile ST *)&sh->u.s.ordered_iteration);
+    UT done =
+        (UT)test_then_inc<ST>((volatile ST *)&sh->u.s.ordered_iteration) + 1;
+    // Within the chunk the next ordered iteration is this thread's own
+    if (sh->ordered_slots && done > pr->u.p.ordered_upper)
+      __kmp_ordered_notify<UT>(sh, done);
 
     KMP_MB(); /* Flush all pending memory write invalidates.  */
   }
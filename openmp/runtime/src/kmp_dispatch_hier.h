@@ -123,6 +123,8 @@ typedef struct kmp_hier_sched_env_t {
 } kmp_hier_sched_env_t;
 
 extern int __kmp_dispatch_hand_threading;
+// OMP_SCHEDULE=hierarchical: derive the layers from the machine topology
+extern int __kmp_hier_auto;
 extern kmp_hier_sched_env_t __kmp_hier_scheds;
 
 // Sizes of layer arrays bounded by max number of detected L1s, L2s, etc.
@@ -218,6 +218,51 @@ void FTN_STDCALL FTN_SET_DISP_NUM_BUFFERS(int KMP_DEREF arg) {
 #endif
 }
 
+/* Task graph record and replay: the first execution of the region between
+   kmp_taskgraph_begin and kmp_taskgraph_end with a given graph_id records the
+   dependences between the tasks created in it, later executions reuse them.
+   Returns 1 if the recorded graph is replayed. */
+int FTN_STDCALL FTN_TASKGRAPH_BEGIN(int KMP_DEREF graph_id) {
+#ifdef KMP_STUB
+  return 0;
+#else
+  int gtid = __kmp_entry_gtid();
+  return __kmp_taskgraph_begin(gtid, KMP_DEREF graph_id);
+#endif
+}
+
+void FTN_STDCALL FTN_TASKGRAPH_END(void) {
+#ifndef KMP_STUB
+  __kmp_taskgraph_end(__kmp_entry_gtid());
+#endif
+}
+
+/* Split barrier: kmp_barrier_arrive signals that the thread has reached a
+   barrier of its team without waiting for the other threads, kmp_barrier_wait
+   waits until all threads of the team have arrived. The thread may do work
+   that does not depend on the other threads in between. */
+void FTN_STDCALL FTN_BARRIER_ARRIVE(void) {
+#ifndef KMP_STUB
+  __kmp_split_barrier_arrive(__kmp_entry_gtid());
+#endif
+}
+
+void FTN_STDCALL FTN_BARRIER_WAIT(void) {
+#ifndef KMP_STUB
+  __kmp_split_barrier_wait(__kmp_entry_gtid());
+#endif
+}
+
+/* Number of threads in active parallel regions of all root threads, as
+   charged to the thread budget of KMP_DYNAMIC_MODE=thread_budget. */
+int FTN_STDCALL FTN_GET_THREAD_BUDGET_USED(void) {
+#ifdef KMP_STUB
+  return 0;
+#else
+  return KMP_ATOMIC_LD_ACQ(&__kmp_thread_budget_nth);
+#endif
+}
+
 int FTN_STDCALL FTN_SET_AFFINITY(void **mask) {
 #if defined(KMP_STUB) || !KMP_AFFINITY_SUPPORTED
   return -1;
@@ -33,6 +33,11 @@
 #define FTN_GET_LIBRARY kmp_get_library
 #define FTN_SET_DEFAULTS kmp_set_defaults
 #define FTN_SET_DISP_NUM_BUFFERS kmp_set_disp_num_buffers
+#define FTN_TASKGRAPH_BEGIN kmp_taskgraph_begin
+#define FTN_TASKGRAPH_END kmp_taskgraph_end
+#define FTN_BARRIER_ARRIVE kmp_barrier_arrive
+#define FTN_BARRIER_WAIT kmp_barrier_wait
+#define FTN_GET_THREAD_BUDGET_USED kmp_get_thread_budget_used
 #define FTN_SET_AFFINITY kmp_set_affinity
 #define FTN_GET_AFFINITY kmp_get_affinity
 #define FTN_GET_AFFINITY_MAX_PROC kmp_get_affinity_max_proc
@@ -168,6 +173,11 @@
 #define FTN_GET_LIBRARY kmp_get_library_
 #define FTN_SET_DEFAULTS kmp_set_defaults_
 #define FTN_SET_DISP_NUM_BUFFERS kmp_set_disp_num_buffers_
+#define FTN_TASKGRAPH_BEGIN kmp_taskgraph_begin_
+#define FTN_TASKGRAPH_END kmp_taskgraph_end_
+#define FTN_BARRIER_ARRIVE kmp_barrier_arrive_
+#define FTN_BARRIER_WAIT kmp_barrier_wait_
+#define FTN_GET_THREAD_BUDGET_USED kmp_get_thread_budget_used_
 #define FTN_SET_AFFINITY kmp_set_affinity_
 #define FTN_GET_AFFINITY kmp_get_affinity_
 #define FTN_GET_AFFINITY_MAX_PROC kmp_get_affinity_max_proc_
@@ -305,6 +315,11 @@
 #define FTN_GET_LIBRARY KMP_GET_LIBRARY
 #define FTN_SET_DEFAULTS KMP_SET_DEFAULTS
 #define FTN_SET_DISP_NUM_BUFFERS KMP_SET_DISP_NUM_BUFFERS
+#define FTN_TASKGRAPH_BEGIN KMP_TASKGRAPH_BEGIN
+#define FTN_TASKGRAPH_END KMP_TASKGRAPH_END
+#define FTN_BARRIER_ARRIVE KMP_BARRIER_ARRIVE
+#define FTN_BARRIER_WAIT KMP_BARRIER_WAIT
+#define FTN_GET_THREAD_BUDGET_USED KMP_GET_THREAD_BUDGET_USED
 #define FTN_SET_AFFINITY KMP_SET_AFFINITY
 #define FTN_GET_AFFINITY KMP_GET_AFFINITY
 #define FTN_GET_AFFINITY_MAX_PROC KMP_GET_AFFINITY_MAX_PROC
@@ -440,6 +455,11 @@
 #define FTN_GET_LIBRARY KMP_GET_LIBRARY_
 #define FTN_SET_DEFAULTS KMP_SET_DEFAULTS_
 #define FTN_SET_DISP_NUM_BUFFERS KMP_SET_DISP_NUM_BUFFERS_
+#define FTN_TASKGRAPH_BEGIN KMP_TASKGRAPH_BEGIN_
+#define FTN_TASKGRAPH_END KMP_TASKGRAPH_END_
+#define FTN_BARRIER_ARRIVE KMP_BARRIER_ARRIVE_
+#define FTN_BARRIER_WAIT KMP_BARRIER_WAIT_
+#define FTN_GET_THREAD_BUDGET_USED KMP_GET_THREAD_BUDGET_USED_
 #define FTN_SET_AFFINITY KMP_SET_AFFINITY_
 #define FTN_GET_AFFINITY KMP_GET_AFFINITY_
 #define FTN_GET_AFFINITY_MAX_PROC KMP_GET_AFFINITY_MAX_PROC_
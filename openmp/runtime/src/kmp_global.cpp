@@ -112,7 +112,9 @@ char const *__kmp_barrier_type_name[bs_last_barrier] = {"plain", "forkjoin"
 #endif // KMP_FAST_REDUCTION_BARRIER
 };
 char const *__kmp_barrier_pattern_name[bp_last_bar] = {
-    "linear", "tree", "hyper", "hierarchical", "dist"};
+    "linear", "tree", "hyper", "hierarchical", "dist", "dissemination",
+    "tournament", "auto"};
+int __kmp_barrier_auto_samples = 16;
 
 int __kmp_allThreadsSpecified = 0;
 size_t __kmp_align_alloc = CACHE_LINE;
@@ -121,6 +123,7 @@ int __kmp_generate_warnings = kmp_warnings_low;
 int __kmp_reserve_warn = 0;
 int __kmp_xproc = 0;
 int __kmp_avail_proc = 0;
+int __kmp_thread_budget = 0;
 size_t __kmp_sys_min_stksize = KMP_MIN_STKSIZE;
 int __kmp_sys_max_nth = KMP_MAX_NTH;
 int __kmp_max_nth = 0;
@@ -138,7 +141,11 @@ bool __kmp_dflt_max_active_levels_set = false; // Don't override set value
 int __kmp_hot_teams_mode = 0; /* 0 - free extra threads when reduced */
 /* 1 - keep extra threads when reduced */
 int __kmp_hot_teams_max_level = 1; /* nesting level of hot teams */
+int __kmp_hot_teams_max_threads = 0; /* no cap on nested hot team workers */
+kmp_team_t *__kmp_hot_teams_lru = NULL;
+kmp_team_t *__kmp_hot_teams_lru_tail = NULL;
 #endif
+int __kmp_hot_teams_fast_fork = FALSE;
 enum library_type __kmp_library = library_none;
 enum sched_type __kmp_sched =
     kmp_sch_default; /* scheduling method for runtime scheduling */
@@ -150,12 +157,19 @@ enum sched_type __kmp_auto =
     kmp_sch_guided_analytical_chunked; /* default auto scheduling method */
 #if KMP_USE_HIER_SCHED
 int __kmp_dispatch_hand_threading = 0;
+int __kmp_hier_auto = 0;
 int __kmp_hier_max_units[kmp_hier_layer_e::LAYER_LAST + 1];
 int __kmp_hier_threads_per[kmp_hier_layer_e::LAYER_LAST + 1];
 kmp_hier_sched_env_t __kmp_hier_scheds = {0, 0, NULL, NULL, NULL};
 #endif
 int __kmp_dflt_blocktime = KMP_DEFAULT_BLOCKTIME;
 bool __kmp_wpolicy_passive = false;
+#if !KMP_USE_MONITOR
+int __kmp_adaptive_blocktime = FALSE;
+#endif
+#if KMP_USE_FUTEX
+int __kmp_futex_suspend = FALSE;
+#endif
 #if KMP_USE_MONITOR
 int __kmp_monitor_wakeups = KMP_MIN_MONITOR_WAKEUPS;
 int __kmp_bt_intervals = KMP_INTERVALS_FROM_BLOCKTIME(KMP_DEFAULT_BLOCKTIME,
@@ -169,6 +183,10 @@ int __kmp_ncores = 0;
 #endif
 int __kmp_chunk = 0;
 int __kmp_force_monotonic = 0;
+int __kmp_auto_learn = FALSE;
+int __kmp_auto_learn_report = FALSE;
+int __kmp_dynamic_batch = 0;
+int __kmp_ordered_tickets = FALSE;
 int __kmp_abort_delay = 0;
 #if KMP_OS_LINUX && defined(KMP_TDATA_GTID)
 int __kmp_gtid_mode = 3; /* use __declspec(thread) TLS to store gtid */
@@ -294,6 +312,7 @@ kmp_int32 __kmp_default_device = 0;
 kmp_tasking_mode_t __kmp_tasking_mode = tskm_task_teams;
 kmp_int32 __kmp_max_task_priority = 0;
 kmp_uint64 __kmp_taskloop_min_tasks = 0;
+kmp_int32 __kmp_taskloop_adaptive = 0;
 
 int __kmp_memkind_available = 0;
 omp_allocator_handle_t const omp_null_allocator = NULL;
@@ -349,6 +368,13 @@ KMP_BUILD_ASSERT(sizeof(kmp_tasking_flags_t) == 4);
 
 int __kmp_task_stealing_constraint = 1; /* Constrain task stealing by default */
 int __kmp_enable_task_throttling = 1;
+int __kmp_task_deque_lockfree = FALSE;
+int __kmp_task_steal_half = FALSE;
+int __kmp_task_steal_hier = 0;
+int __kmp_task_alloc_cache = FALSE;
+int __kmp_task_priority_mq = FALSE;
+int __kmp_task_affinity = FALSE;
+int __kmp_task_mtx_tokens = FALSE;
 
 #ifdef DEBUG_SUSPEND
 int __kmp_suspend_count = 0;
@@ -452,9 +478,12 @@ volatile int __kmp_nth = 0;
 volatile int __kmp_all_nth = 0;
 volatile kmp_info_t *__kmp_thread_pool = NULL;
 volatile kmp_team_t *__kmp_team_pool = NULL;
+int __kmp_pool_thread_timeout = 0;
+std::atomic<double> __kmp_pool_reap_time(0);
 
 KMP_ALIGN_CACHE
 std::atomic<int> __kmp_thread_pool_active_nth = ATOMIC_VAR_INIT(0);
+std::atomic<int> __kmp_thread_budget_nth = ATOMIC_VAR_INIT(0);
 
 /* -------------------------------------------------
  * GLOBAL/ROOT STATE */
@@ -1030,6 +1030,69 @@ extern kmp_real64 __kmp_xchg_real64(volatile kmp_real64 *p, kmp_real64 v);
 
 #endif /* KMP_ASM_INTRINS */
 
+// 16-byte compare-and-store of the pair of 64-bit words at p (p must be 16-byte
+// aligned). Available when KMP_HAVE_CAS128 is set; on x86_64 the processor
+// must also support CMPXCHG16B (see __kmp_cpuinfo.flags.cmpxchg16b). It may
+// fail spuriously on AArch64, so it is meant to be retried in a loop.
+#if (KMP_ARCH_X86_64 || KMP_ARCH_AARCH64) && KMP_MSVC_COMPAT
+#include <intrin.h>
+#define KMP_HAVE_CAS128 1
+static inline int __kmp_compare_and_store128(volatile kmp_int64 *p,
+                                             kmp_int64 cv0, kmp_int64 cv1,
+                                             kmp_int64 sv0, kmp_int64 sv1) {
+  __int64 cv[2] = {cv0, cv1};
+  return _InterlockedCompareExchange128((volatile __int64 *)p, sv1, sv0, cv);
+}
+#elif KMP_ARCH_X86_64 && (KMP_COMPILER_GCC || KMP_COMPILER_CLANG ||            \
+                          KMP_COMPILER_ICC || KMP_COMPILER_ICX)
+#define KMP_HAVE_CAS128 1
+static inline int __kmp_compare_and_store128(volatile kmp_int64 *p,
+                                             kmp_int64 cv0, kmp_int64 cv1,
+                                             kmp_int64 sv0, kmp_int64 sv1) {
+  unsigned char res;
+  __asm__ __volatile__("lock; cmpxchg16b %1\n\tsete %0"
+                       : "=q"(res), "+m"(*(volatile kmp_int64(*)[2])p),
+                         "+a"(cv0), "+d"(cv1)
+                       : "b"(sv0), "c"(sv1)
+                       : "memory", "cc");
+  return res;
+}
+#elif KMP_ARCH_AARCH64 && (KMP_COMPILER_GCC || KMP_COMPILER_CLANG)
+// LDAXP/STLXP loop, also used for arm64_32 which has the AArch64 instruction
+// set. On a mismatch the words read may be torn, so the CAS just fails.
+#define KMP_HAVE_CAS128 1
+static inline int __kmp_compare_and_store128(volatile kmp_int64 *p,
+                                             kmp_int64 cv0, kmp_int64 cv1,
+                                             kmp_int64 sv0, kmp_int64 sv1) {
+  kmp_int64 old0, old1;
+  int fail;
+  __asm__ __volatile__("1:\n\t"
+                       "ldaxp %0, %1, %3\n\t"
+                       "cmp %0, %4\n\t"
+                       "ccmp %1, %5, #0, eq\n\t"
+                       "b.ne 2f\n\t"
+                       "stlxp %w2, %6, %7, %3\n\t"
+                       "cbnz %w2, 1b\n\t"
+                       "b 3f\n"
+                       "2:\n\t"
+                       "clrex\n"
+                       "3:"
+                       : "=&r"(old0), "=&r"(old1), "=&r"(fail),
+                         "+Q"(*(volatile kmp_int64(*)[2])p)
+                       : "r"(cv0), "r"(cv1), "r"(sv0), "r"(sv1)
+                       : "memory", "cc");
+  return old0 == cv0 && old1 == cv1;
+}
+#else
+#define KMP_HAVE_CAS128 0
+#endif
+
+#if KMP_HAVE_CAS128
+#define KMP_COMPARE_AND_STORE_REL128(p, cv, sv)                                \
+  __kmp_compare_and_store128((volatile kmp_int64 *)(p), (cv)[0], (cv)[1],      \
+                             (sv)[0], (sv)[1])
+#endif
+
 /* ------------- relaxed consistency memory model stuff ------------------ */
 
 #if KMP_OS_WINDOWS
@@ -86,6 +86,9 @@ static void __kmp_initialize_info(kmp_info_t *, kmp_team_t *, int tid,
 static void __kmp_initialize_team(kmp_team_t *team, int new_nproc,
                                   kmp_internal_control_t *new_icvs,
                                   ident_t *loc);
+static void __kmp_reinitialize_team(kmp_team_t *team,
+                                    kmp_internal_control_t *new_icvs,
+                                    ident_t *loc);
 #if KMP_AFFINITY_SUPPORTED
 static void __kmp_partition_places(kmp_team_t *team,
                                    int update_master_only = 0);
@@ -105,6 +108,9 @@ static int __kmp_expand_threads(int nNeed);
 static int __kmp_unregister_root_other_thread(int gtid);
 #endif
 static void __kmp_reap_thread(kmp_info_t *thread, int is_root);
+static void __kmp_reap_pool_threads(kmp_root_t *root);
+static void __kmp_reap_worker_thread(kmp_info_t *thread);
+static void __kmp_restart_pool_thread(kmp_info_t *thread);
 kmp_info_t *__kmp_thread_pool_insert_pt = NULL;
 
 void __kmp_resize_dist_barrier(kmp_team_t *team, int old_nthreads,
@@ -772,6 +778,25 @@ static int __kmp_reserve_threads(kmp_root_t *root, kmp_team_t *parent_team,
     } else {
       new_nthreads = set_nthreads;
     }
+  } else if (__kmp_global.g.g_dynamic_mode == dynamic_thread_budget) {
+    // Threads already in active parallel regions of any root count against
+    // the budget; the primary thread of a nested team is already counted.
+    int budget = __kmp_thread_budget ? __kmp_thread_budget : __kmp_avail_proc;
+    new_nthreads = budget - KMP_ATOMIC_LD_ACQ(&__kmp_thread_budget_nth) +
+                   (root->r.r_active ? 1 : 0);
+    if (new_nthreads <= 1) {
+      KC_TRACE(10, ("__kmp_reserve_threads: T#%d thread budget reduced "
+                    "reservation to 1 thread\n",
+                    master_tid));
+      return 1;
+    }
+    if (new_nthreads < set_nthreads) {
+      KC_TRACE(10, ("__kmp_reserve_threads: T#%d thread budget reduced "
+                    "reservation to %d threads\n",
+                    master_tid, new_nthreads));
+    } else {
+      new_nthreads = set_nthreads;
+    }
   } else if (__kmp_global.g.g_dynamic_mode == dynamic_random) {
     if (set_nthreads > 2) {
       new_nthreads = __kmp_get_random(parent_team->t.t_threads[master_tid]);
@@ -910,6 +935,107 @@ static int __kmp_reserve_threads(kmp_root_t *root, kmp_team_t *parent_team,
   return new_nthreads;
 }
 
+#if KMP_NESTED_HOT_TEAMS
+/* With KMP_HOT_TEAMS_MAX_THREADS set, the nested hot teams (level index > 0)
+   are kept on an LRU list, so that the least recently used idle ones give
+   their worker threads back to the thread pool when the nested hot teams keep
+   more workers than the cap. All of this is done under __kmp_forkjoin_lock. */
+static void __kmp_hot_teams_lru_unlink(kmp_team_t *team) {
+  if (team->t.t_hot_prev)
+    team->t.t_hot_prev->t.t_hot_next = team->t.t_hot_next;
+  else
+    __kmp_hot_teams_lru = team->t.t_hot_next;
+  if (team->t.t_hot_next)
+    team->t.t_hot_next->t.t_hot_prev = team->t.t_hot_prev;
+  else
+    __kmp_hot_teams_lru_tail = team->t.t_hot_prev;
+  team->t.t_hot_prev = team->t.t_hot_next = NULL;
+}
+
+static void __kmp_hot_teams_lru_push(kmp_team_t *team) {
+  team->t.t_hot_prev = NULL;
+  team->t.t_hot_next = __kmp_hot_teams_lru;
+  if (__kmp_hot_teams_lru)
+    __kmp_hot_teams_lru->t.t_hot_prev = team;
+  else
+    __kmp_hot_teams_lru_tail = team;
+  __kmp_hot_teams_lru = team;
+}
+
+// Mark a listed nested hot team busy and make it the most recently used one.
+static void __kmp_hot_teams_lru_use(kmp_team_t *team) {
+  KMP_DEBUG_ASSERT(team->t.t_hot_owner && !team->t.t_hot_busy);
+  team->t.t_hot_busy = 1;
+  if (team != __kmp_hot_teams_lru) {
+    __kmp_hot_teams_lru_unlink(team);
+    __kmp_hot_teams_lru_push(team);
+  }
+}
+
+// Drop from the list the nested hot teams of a thread whose hot teams array is
+// about to be freed.
+static void __kmp_hot_teams_lru_forget(kmp_info_t *thr) {
+  kmp_hot_team_ptr_t *hot_teams = thr->th.th_hot_teams;
+  for (int level = 1; level < __kmp_hot_teams_max_level; ++level) {
+    kmp_team_t *team = hot_teams[level].hot_team;
+    if (team && team->t.t_hot_owner == thr) {
+      __kmp_hot_teams_lru_unlink(team);
+      team->t.t_hot_owner = NULL;
+      team->t.t_hot_busy = 0;
+    }
+  }
+}
+
+// Drop an idle nested hot team from its owner and free it together with its
+// worker threads, including the ones kept in reserve in KMP_HOT_TEAMS_MODE=1.
+static void __kmp_hot_teams_lru_evict(kmp_root_t *root, kmp_team_t *team) {
+  kmp_info_t *owner = team->t.t_hot_owner;
+  kmp_hot_team_ptr_t *hot_team = &owner->th.th_hot_teams[team->t.t_hot_level];
+  int f;
+
+  KA_TRACE(20, ("__kmp_hot_teams_lru_evict: T#%d evicting team %d of T#%d at "
+                "level %d\n",
+                __kmp_get_gtid(), team->t.t_id, owner->th.th_info.ds.ds_gtid,
+                team->t.t_hot_level));
+  KMP_DEBUG_ASSERT(hot_team->hot_team == team && !team->t.t_hot_busy);
+  __kmp_hot_teams_lru_unlink(team);
+  for (f = team->t.t_nproc; f < hot_team->hot_team_nth; ++f) {
+    KMP_DEBUG_ASSERT(team->t.t_threads[f]);
+    if (__kmp_tasking_mode != tskm_immediate_exec)
+      team->t.t_threads[f]->th.th_task_team = NULL;
+    __kmp_free_thread(team->t.t_threads[f]);
+    team->t.t_threads[f] = NULL;
+  }
+  hot_team->hot_team = NULL;
+  hot_team->hot_team_nth = 0;
+  __kmp_free_team(root, team, NULL);
+  team->t.t_hot_owner = NULL;
+}
+
+// Evict the least recently used idle nested hot teams until the workers kept
+// by all nested hot teams fit in KMP_HOT_TEAMS_MAX_THREADS.
+static void __kmp_hot_teams_lru_trim(kmp_root_t *root) {
+  kmp_team_t *team;
+  int nth = 0;
+
+  for (team = __kmp_hot_teams_lru; team; team = team->t.t_hot_next)
+    nth += team->t.t_hot_owner->th.th_hot_teams[team->t.t_hot_level]
+               .hot_team_nth -
+           1;
+  team = __kmp_hot_teams_lru_tail;
+  while (team && nth > __kmp_hot_teams_max_threads) {
+    kmp_team_t *prev = team->t.t_hot_prev;
+    if (!team->t.t_hot_busy) {
+      nth -= team->t.t_hot_owner->th.th_hot_teams[team->t.t_hot_level]
+                 .hot_team_nth -
+             1;
+      __kmp_hot_teams_lru_evict(root, team);
+    }
+    team = prev;
+  }
+}
+#endif // KMP_NESTED_HOT_TEAMS
+
 /* Allocate threads from the thread pool and assign them to the new team. We are
    assured that there are enough threads available, because we checked on that
    earlier within critical section forkjoin */
@@ -958,6 +1084,13 @@ static void __kmp_fork_team_threads(kmp_root_t *root, kmp_team_t *team,
         use_hot_team = 0; // AC: threads are not allocated yet
         hot_teams[level].hot_team = team; // remember new hot team
         hot_teams[level].hot_team_nth = team->t.t_nproc;
+        if (__kmp_hot_teams_max_threads > 0 && level > 0 &&
+            !master_th->th.th_teams_microtask) {
+          team->t.t_hot_owner = master_th;
+          team->t.t_hot_level = level;
+          team->t.t_hot_busy = 1;
+          __kmp_hot_teams_lru_push(team);
+        }
       }
     } else {
       use_hot_team = 0;
@@ -1842,6 +1975,139 @@ __kmp_serial_fork_call(ident_t *loc, int gtid, enum fork_context_e call_context,
   return FALSE;
 }
 
+/* Charge the threads of a team going parallel to the thread budget of
+   KMP_DYNAMIC_MODE=thread_budget; the primary thread of a nested team is
+   already charged to the enclosing team. __kmp_join_call gives them back. */
+static inline void __kmp_charge_thread_budget(kmp_team_t *team, int nested) {
+  if (__kmp_global.g.g_dynamic_mode != dynamic_thread_budget)
+    return;
+  team->t.t_budget_nth = team->t.t_nproc - (nested ? 1 : 0);
+  KMP_ATOMIC_ADD(&__kmp_thread_budget_nth, team->t.t_budget_nth);
+}
+
+/* Fast path of __kmp_fork_call (KMP_HOT_TEAMS_FAST_FORK): a parallel region at
+   the outermost level that reuses the hot team with its current number of
+   threads and unchanged ICVs, with no tool attached. The thread reservation,
+   ICV derivation, team allocation and thread installation of the generic path
+   would leave such a team as it is, so only the per-region updates are done
+   before the fork barrier. Returns the forked team, or NULL if the generic path
+   has to be taken. */
+static kmp_team_t *__kmp_fork_hot_team(ident_t *loc, int gtid, kmp_int32 argc,
+                                       microtask_t microtask, launch_t invoker,
+                                       kmp_va_list ap) {
+  kmp_info_t *master_th = __kmp_threads[gtid];
+  kmp_root_t *root = master_th->th.th_root;
+  kmp_team_t *parent_team = master_th->th.th_team;
+  kmp_team_t *team = root->r.r_hot_team;
+  kmp_internal_control_t *icvs = &master_th->th.th_current_task->td_icvs;
+  int nthreads = master_th->th.th_set_nproc ? master_th->th.th_set_nproc
+                                            : icvs->nproc;
+
+  if (!TCR_4(__kmp_init_parallel) || __kmp_pause_status != kmp_not_paused ||
+      root->r.r_active || parent_team != root->r.r_root_team ||
+      master_th->th.th_teams_microtask || master_th->th.th_task_team ||
+      master_th->th.th_set_proc_bind != proc_bind_default || !team ||
+      nthreads < 2 || team->t.t_nproc != nthreads ||
+      team->t.t_size_changed == -1 || team->t.t_proc_bind != icvs->proc_bind ||
+      icvs->dynamic || icvs->max_active_levels < 1 ||
+      __kmp_library == library_serial || __kmp_nested_nth.used > 1 ||
+      __kmp_nested_proc_bind.used > 1 || __kmp_display_affinity)
+    return NULL;
+#if KMP_NESTED_HOT_TEAMS
+  if (!master_th->th.th_hot_teams ||
+      master_th->th.th_hot_teams[0].hot_team != team)
+    return NULL;
+#endif
+  // idle pool threads are reaped under the lock
+  double reap_time = KMP_ATOMIC_LD_ACQ(&__kmp_pool_reap_time);
+  if (reap_time) {
+    double now;
+    __kmp_read_system_time(&now);
+    if (now >= reap_time)
+      return NULL;
+  }
+#if OMPT_SUPPORT
+  if (ompt_enabled.enabled)
+    return NULL;
+#endif
+#if USE_ITT_BUILD
+  if (__itt_stack_caller_create_ptr || __itt_frame_begin_v3_ptr ||
+      KMP_ITT_DEBUG)
+    return NULL;
+#if USE_ITT_NOTIFY
+  if (__itt_frame_submit_v3_ptr)
+    return NULL;
+#endif
+#endif /* USE_ITT_BUILD */
+
+  KMP_COUNT_VALUE(OMP_PARALLEL_args, argc);
+  KA_TRACE(20, ("__kmp_fork_hot_team: T#%d reusing hot team %p\n", gtid, team));
+  __kmp_assign_root_init_mask();
+  master_th->th.th_ident = loc;
+  master_th->th.th_set_nproc = 0;
+  master_th->th.th_current_task->td_flags.executing = 0;
+  KMP_ATOMIC_INC(&root->r.r_in_parallel);
+
+  // What __kmp_allocate_team does for a hot team of unchanged size
+  KMP_CHECK_UPDATE(team->t.t_size_changed, 0);
+  KMP_CHECK_UPDATE(team->t.t_sched.sched, icvs->sched.sched);
+  __kmp_reinitialize_team(team, icvs, root->r.r_uber_thread->th.th_ident);
+  __kmp_push_current_task_to_thread(master_th, team, 0);
+#if KMP_AFFINITY_SUPPORTED
+  if (team->t.t_proc_bind == proc_bind_spread)
+    __kmp_partition_places(team, 1);
+#endif
+  __kmp_alloc_argv_entries(argc, team, TRUE);
+  KMP_CHECK_UPDATE(team->t.t_argc, argc);
+  if (__kmp_barrier_release_pattern[bs_forkjoin_barrier] == bp_dist_bar)
+    copy_icvs((kmp_internal_control_t *)team->t.b->team_icvs, icvs);
+
+  // The team setup of __kmp_fork_call
+  KMP_CHECK_UPDATE(team->t.t_master_tid, 0);
+  KMP_CHECK_UPDATE(team->t.t_master_this_cons,
+                   master_th->th.th_local.this_construct);
+  KMP_CHECK_UPDATE(team->t.t_ident, loc);
+  KMP_CHECK_UPDATE(team->t.t_parent, parent_team);
+  KMP_CHECK_UPDATE_SYNC(team->t.t_pkfn, microtask);
+  KMP_CHECK_UPDATE(team->t.t_invoke, invoker);
+  int new_level = parent_team->t.t_level + 1;
+  KMP_CHECK_UPDATE(team->t.t_level, new_level);
+  new_level = parent_team->t.t_active_level + 1;
+  KMP_CHECK_UPDATE(team->t.t_active_level, new_level);
+  KMP_CHECK_UPDATE(team->t.t_cancel_request, cancel_noreq);
+  KMP_CHECK_UPDATE(team->t.t_def_allocator, master_th->th.th_def_allocator);
+  propagateFPControl(team);
+#if OMPD_SUPPORT
+  if (ompd_state & OMPD_ENABLE_BP)
+    ompd_bp_parallel_begin();
+#endif
+
+  void **argv = (void **)team->t.t_argv;
+  for (int i = argc - 1; i >= 0; --i) {
+    void *new_argv = va_arg(kmp_va_deref(ap), void *);
+    KMP_CHECK_UPDATE(*argv, new_argv);
+    argv++;
+  }
+  KMP_CHECK_UPDATE(team->t.t_master_active, FALSE);
+  __kmp_charge_thread_budget(team, FALSE);
+  // Not under __kmp_forkjoin_lock, which the shutdown and pause paths hold
+  // while they read r_active
+  TCW_SYNC_4(root->r.r_active, TRUE);
+
+  // What __kmp_fork_team_threads does for the primary thread of a hot team
+  master_th->th.th_info.ds.ds_tid = 0;
+  master_th->th.th_team = team;
+  master_th->th.th_team_nproc = team->t.t_nproc;
+  master_th->th.th_team_master = master_th;
+  master_th->th.th_team_serialized = FALSE;
+  master_th->th.th_dispatch = &team->t.t_dispatch[0];
+  __kmp_setup_icv_copy(team, nthreads, icvs, loc);
+  KMP_MB();
+
+  __kmp_internal_fork(loc, gtid, team);
+  return team;
+}
+
 /* most of the work for a fork */
 /* return true if we really went parallel, false if serialized */
 int __kmp_fork_call(ident_t *loc, int gtid,
@@ -1865,6 +2131,17 @@ int __kmp_fork_call(ident_t *loc, int gtid,
 #if KMP_NESTED_HOT_TEAMS
   kmp_hot_team_ptr_t **p_hot_teams;
 #endif
+  if (__kmp_hot_teams_fast_fork && ap) {
+    team = __kmp_fork_hot_team(loc, gtid, argc, microtask, invoker, ap);
+    if (team) {
+      if (call_context == fork_context_gnu)
+        return TRUE;
+      if (!team->t.t_invoke(gtid)) {
+        KMP_ASSERT2(0, "cannot invoke microtask for PRIMARY thread");
+      }
+      return TRUE;
+    }
+  }
   { // KMP_TIME_BLOCK
     KMP_TIME_DEVELOPER_PARTITIONED_BLOCK(KMP_fork_call);
     KMP_COUNT_VALUE(OMP_PARALLEL_args, argc);
@@ -1992,6 +2269,8 @@ int __kmp_fork_call(ident_t *loc, int gtid,
       if (nthreads > 1) {
         /* determine how many new threads we can use */
         __kmp_acquire_bootstrap_lock(&__kmp_forkjoin_lock);
+        if (KMP_ATOMIC_LD_RLX(&__kmp_pool_reap_time))
+          __kmp_reap_pool_threads(root);
         /* AC: If we execute teams from parallel region (on host), then teams
            should be created but each can only have 1 thread if nesting is
            disabled. If teams called from serial region, then teams and their
@@ -2199,10 +2478,10 @@ int __kmp_fork_call(ident_t *loc, int gtid,
         if (master_th->th.th_hot_teams &&
             active_level < __kmp_hot_teams_max_level &&
             team == master_th->th.th_hot_teams[active_level].hot_team) {
-          // Restore primary thread's nested state if nested hot team
-          master_th->th.th_task_state =
-              master_th->th
-                  .th_task_state_memo_stack[master_th->th.th_task_state_top];
+          // Restore primary thread's nested state if nested hot team. It is
+          // kept in the team: the memo stack slot is shared by the hot teams
+          // the thread forks at different levels over time.
+          master_th->th.th_task_state = team->t.t_primary_task_state;
         } else {
 #endif
           master_th->th.th_task_state = 0;
@@ -2244,6 +2523,8 @@ int __kmp_fork_call(ident_t *loc, int gtid,
 
     /* now actually fork the threads */
     KMP_CHECK_UPDATE(team->t.t_master_active, master_active);
+    if (!master_th->th.th_teams_microtask)
+      __kmp_charge_thread_budget(team, master_active);
     if (!root->r.r_active) // Only do assignment if it prevents cache ping-pong
       root->r.r_active = TRUE;
 
@@ -2598,7 +2879,16 @@ void __kmp_join_call(ident_t *loc, int gtid
   /* jc: The following lock has instructions with REL and ACQ semantics,
      separating the parallel user code called in this parallel region
      from the serial user code called after this function returns. */
-  __kmp_acquire_bootstrap_lock(&__kmp_forkjoin_lock);
+  // The outermost hot team belongs to its root and nothing goes back to the
+  // pools when it joins, so with KMP_HOT_TEAMS_FAST_FORK it joins without the
+  // global lock and independent roots do not serialize on it.
+  int join_locked = !__kmp_hot_teams_fast_fork || team != root->r.r_hot_team ||
+                    parent_team != root->r.r_root_team ||
+                    master_th->th.th_teams_microtask != NULL;
+  if (join_locked)
+    __kmp_acquire_bootstrap_lock(&__kmp_forkjoin_lock);
+  else
+    KMP_MB();
 
   if (!master_th->th.th_teams_microtask ||
       team->t.t_level > master_th->th.th_teams_level) {
@@ -2636,9 +2926,17 @@ void __kmp_join_call(ident_t *loc, int gtid
 #endif
   updateHWFPControl(team);
 
-  if (root->r.r_active != master_active)
-    root->r.r_active = master_active;
+  if (root->r.r_active != master_active) {
+    if (!join_locked)
+      KMP_MB(); // the region is over before other threads see the root idle
+    TCW_SYNC_4(root->r.r_active, master_active);
+  }
 
+  if (team->t.t_budget_nth) {
+    KMP_ATOMIC_SUB(&__kmp_thread_budget_nth, team->t.t_budget_nth);
+    team->t.t_budget_nth = 0;
+  }
+  team->t.t_primary_task_state = master_th->th.th_task_state;
   __kmp_free_team(root, team USE_NESTED_HOT_ARG(
                             master_th)); // this will free worker threads
 
@@ -2665,9 +2963,6 @@ void __kmp_join_call(ident_t *loc, int gtid
     if (master_th->th.th_task_state_top >
         0) { // Restore task state from memo stack
       KMP_DEBUG_ASSERT(master_th->th.th_task_state_memo_stack);
-      // Remember primary thread's state if we re-use this nested hot team
-      master_th->th.th_task_state_memo_stack[master_th->th.th_task_state_top] =
-          master_th->th.th_task_state;
       --master_th->th.th_task_state_top; // pop
       // Now restore state at this level
       master_th->th.th_task_state =
@@ -2694,7 +2989,10 @@ void __kmp_join_call(ident_t *loc, int gtid
   // KMP_ASSERT( master_th->th.th_current_task->td_flags.executing == 0 );
   master_th->th.th_current_task->td_flags.executing = 1;
 
-  __kmp_release_bootstrap_lock(&__kmp_forkjoin_lock);
+  if (join_locked)
+    __kmp_release_bootstrap_lock(&__kmp_forkjoin_lock);
+  else
+    KMP_MB();
 
 #if KMP_AFFINITY_SUPPORTED
   if (master_th->th.th_team->t.t_level == 0 && __kmp_affinity.flags.reset) {
@@ -3212,12 +3510,32 @@ static void __kmp_allocate_team_arrays(kmp_team_t *team, int max_nth) {
   team->t.t_implicit_task_taskdata =
       (kmp_taskdata_t *)__kmp_allocate(sizeof(kmp_taskdata_t) * max_nth);
   team->t.t_max_nproc = max_nth;
+  __kmp_barrier_alloc_rounds(team, max_nth);
 
   /* setup dispatch buffers */
   for (i = 0; i < num_disp_buff; ++i) {
     team->t.t_disp_buffer[i].buffer_index = i;
     team->t.t_disp_buffer[i].doacross_buf_idx = i;
   }
+  if (__kmp_ordered_tickets && max_nth > 1) {
+    // One ordered ticket slot per thread, rounded up to a power of two, for
+    // each dispatch buffer
+    kmp_uint32 nslots = 2;
+    while (nslots < (kmp_uint32)max_nth)
+      nslots <<= 1;
+    kmp_ordered_slot_t *slots = (kmp_ordered_slot_t *)__kmp_allocate(
+        sizeof(kmp_ordered_slot_t) * nslots * num_disp_buff);
+    for (i = 0; i < num_disp_buff; ++i) {
+      team->t.t_disp_buffer[i].ordered_slots = &slots[i * nslots];
+      team->t.t_disp_buffer[i].ordered_slots_mask = nslots - 1;
+    }
+  }
+}
+
+static void __kmp_free_ordered_slots(kmp_team_t *team) {
+  // the slots of all dispatch buffers are allocated together
+  if (team->t.t_disp_buffer[0].ordered_slots != NULL)
+    __kmp_free(team->t.t_disp_buffer[0].ordered_slots);
 }
 
 static void __kmp_free_team_arrays(kmp_team_t *team) {
@@ -3232,10 +3550,12 @@ static void __kmp_free_team_arrays(kmp_team_t *team) {
 #if KMP_USE_HIER_SCHED
   __kmp_dispatch_free_hierarchies(team);
 #endif
+  __kmp_free_ordered_slots(team);
   __kmp_free(team->t.t_threads);
   __kmp_free(team->t.t_disp_buffer);
   __kmp_free(team->t.t_dispatch);
   __kmp_free(team->t.t_implicit_task_taskdata);
+  __kmp_barrier_free_rounds(team);
   team->t.t_threads = NULL;
   team->t.t_disp_buffer = NULL;
   team->t.t_dispatch = NULL;
@@ -3245,9 +3565,11 @@ static void __kmp_free_team_arrays(kmp_team_t *team) {
 static void __kmp_reallocate_team_arrays(kmp_team_t *team, int max_nth) {
   kmp_info_t **oldThreads = team->t.t_threads;
 
+  __kmp_free_ordered_slots(team);
   __kmp_free(team->t.t_disp_buffer);
   __kmp_free(team->t.t_dispatch);
   __kmp_free(team->t.t_implicit_task_taskdata);
+  __kmp_barrier_free_rounds(team);
   __kmp_allocate_team_arrays(team, max_nth);
 
   KMP_MEMCPY(team->t.t_threads, oldThreads,
@@ -3975,6 +4297,7 @@ int __kmp_register_root(int initial_thread) {
   root_thread->th.th_def_allocator = __kmp_def_allocator;
   root_thread->th.th_prev_level = 0;
   root_thread->th.th_prev_num_threads = 1;
+  root_thread->th.th_numa_node = -1;
 
   kmp_cg_root_t *tmp = (kmp_cg_root_t *)__kmp_allocate(sizeof(kmp_cg_root_t));
   tmp->cg_root = root_thread;
@@ -4032,6 +4355,11 @@ static int __kmp_free_hot_teams(kmp_root_t *root, kmp_info_t *thr, int level,
   }
   KMP_DEBUG_ASSERT(level < max_level);
   kmp_team_t *team = hot_teams[level].hot_team;
+  if (team->t.t_hot_owner) {
+    __kmp_hot_teams_lru_unlink(team);
+    team->t.t_hot_owner = NULL;
+    team->t.t_hot_busy = 0;
+  }
   nth = hot_teams[level].hot_team_nth;
   n = nth - 1; // primary thread is not freed
   if (level < max_level - 1) {
@@ -4039,6 +4367,7 @@ static int __kmp_free_hot_teams(kmp_root_t *root, kmp_info_t *thr, int level,
       kmp_info_t *th = team->t.t_threads[i];
       n += __kmp_free_hot_teams(root, th, level + 1, max_level);
       if (i > 0 && th->th.th_hot_teams) {
+        __kmp_hot_teams_lru_forget(th);
         __kmp_free(th->th.th_hot_teams);
         th->th.th_hot_teams = NULL;
       }
@@ -4073,6 +4402,7 @@ static int __kmp_reset_root(int gtid, kmp_root_t *root) {
         n += __kmp_free_hot_teams(root, th, 1, __kmp_hot_teams_max_level);
       }
       if (th->th.th_hot_teams) {
+        __kmp_hot_teams_lru_forget(th);
         __kmp_free(th->th.th_hot_teams);
         th->th.th_hot_teams = NULL;
       }
@@ -4439,6 +4769,8 @@ kmp_info_t *__kmp_allocate_thread(kmp_root_t *root, kmp_team_t *team,
       KMP_DEBUG_ASSERT(new_thr->th.th_used_in_team.load() == 0);
       // Thread activated in __kmp_allocate_team when increasing team size
     }
+    if (TCR_4(new_thr->th.th_reaped))
+      __kmp_restart_pool_thread(new_thr);
 
 #ifdef KMP_ADJUST_BLOCKTIME
     /* Adjust blocktime back to zero if necessary */
@@ -4625,6 +4957,7 @@ kmp_info_t *__kmp_allocate_thread(kmp_root_t *root, kmp_team_t *team,
   new_thr->th.th_def_allocator = __kmp_def_allocator;
   new_thr->th.th_prev_level = 0;
   new_thr->th.th_prev_num_threads = 1;
+  new_thr->th.th_numa_node = -1;
 
   TCW_4(new_thr->th.th_in_pool, FALSE);
   new_thr->th.th_active_in_pool = FALSE;
@@ -5186,6 +5519,8 @@ __kmp_allocate_team(kmp_root_t *root, int new_nproc, int max_nproc,
     KMP_DEBUG_ASSERT(new_nproc <= max_nproc);
 #if KMP_NESTED_HOT_TEAMS
     team = hot_teams[level].hot_team;
+    if (team->t.t_hot_owner)
+      __kmp_hot_teams_lru_use(team);
 #else
     team = root->r.r_hot_team;
 #endif
@@ -5448,11 +5783,9 @@ __kmp_allocate_team(kmp_root_t *root, int new_nproc, int max_nproc,
         // __kmp_initialize_info() no longer zeroes th_task_state, so we should
         // only need to set the th_task_state for the new threads. th_task_state
         // for primary thread will not be accurate until after this in
-        // __kmp_fork_call(), so we look to the primary thread's memo_stack to
-        // get the correct value.
+        // __kmp_fork_call(), so we take the value it had at the last join.
         for (f = old_nproc; f < team->t.t_nproc; ++f)
-          team->t.t_threads[f]->th.th_task_state =
-              team->t.t_threads[0]->th.th_task_state_memo_stack[level];
+          team->t.t_threads[f]->th.th_task_state = team->t.t_primary_task_state;
       } else { // set th_task_state for new threads in non-nested hot team
         // copy primary thread's state
         kmp_uint8 old_state = team->t.t_threads[0]->th.th_task_state;
@@ -5742,6 +6075,12 @@ void __kmp_free_team(kmp_root_t *root,
         if (task_team != NULL) {
           for (f = 0; f < team->t.t_nproc; ++f) { // threads unref task teams
             KMP_DEBUG_ASSERT(team->t.t_threads[f]);
+#if KMP_NESTED_HOT_TEAMS
+            // The primary thread of an evicted nested hot team may be running
+            // another parallel region
+            if (f == 0 && team->t.t_hot_owner)
+              continue;
+#endif
             team->t.t_threads[f]->th.th_task_team = NULL;
           }
           KA_TRACE(
@@ -5833,6 +6172,13 @@ void __kmp_free_team(kmp_root_t *root,
     }
   }
 
+#if KMP_NESTED_HOT_TEAMS
+  if (use_hot_team && team->t.t_hot_owner) {
+    team->t.t_hot_busy = 0;
+    __kmp_hot_teams_lru_trim(root);
+  }
+#endif
+
   KMP_MB();
 }
 
@@ -5973,6 +6319,14 @@ void __kmp_free_thread(kmp_info_t *this_th) {
                    (this_th->th.th_info.ds.ds_gtid <
                     this_th->th.th_next_pool->th.th_info.ds.ds_gtid));
   TCW_4(this_th->th.th_in_pool, TRUE);
+  if (__kmp_pool_thread_timeout) {
+    double time_out;
+    __kmp_read_system_time(&this_th->th.th_pool_time);
+    time_out = this_th->th.th_pool_time + __kmp_pool_thread_timeout * 1e-3;
+    double reap_time = KMP_ATOMIC_LD_RLX(&__kmp_pool_reap_time);
+    if (reap_time == 0 || time_out < reap_time)
+      KMP_ATOMIC_ST_REL(&__kmp_pool_reap_time, time_out);
+  }
   __kmp_suspend_initialize_thread(this_th);
   __kmp_lock_suspend_mx(this_th);
   if (this_th->th.th_active == TRUE) {
@@ -6002,6 +6356,109 @@ void __kmp_free_thread(kmp_info_t *this_th) {
   KMP_MB();
 }
 
+/* Reap the OS threads of the workers that have been in the thread pool for
+   longer than KMP_POOL_THREAD_TIMEOUT, so that their stacks are given back,
+   along with the free memory their allocators cache. The kmp_info_t of a
+   reaped thread stays in the pool with th_reaped set, with the allocator
+   blocks still in use: other threads may hold blocks allocated by it, or lists
+   of such blocks to hand back to it, so the structure is only freed at
+   shutdown. __kmp_allocate_thread starts a new OS thread for it when
+   it is taken from the pool again. The nested hot teams of a thread that timed
+   out are freed first, and their workers, idle for as long, are reaped too.
+   Threads with threadprivate data are kept, as an exiting thread runs their
+   destructors. Threads spinning with an infinite blocktime are not woken up
+   for reaping and are kept too. The forkjoin lock is held by the caller. */
+static void __kmp_reap_pool_threads(kmp_root_t *root) {
+  kmp_info_t *thread;
+  double now, expired, time_out, reap_time = 0;
+
+  __kmp_read_system_time(&now);
+  if (now < KMP_ATOMIC_LD_RLX(&__kmp_pool_reap_time))
+    return;
+  if (__kmp_dflt_blocktime == KMP_MAX_BLOCKTIME) {
+    KMP_ATOMIC_ST_REL(&__kmp_pool_reap_time, 0);
+    return;
+  }
+  // the threads that entered the pool before this time timed out
+  expired = now - __kmp_pool_thread_timeout * 1e-3;
+
+#if KMP_NESTED_HOT_TEAMS
+  if (__kmp_hot_teams_max_level > 1) {
+    bool freed = false;
+    for (thread = CCAST(kmp_info_t *, __kmp_thread_pool); thread != NULL;
+         thread = thread->th.th_next_pool) {
+      if (thread->th.th_hot_teams == NULL || TCR_4(thread->th.th_reaped) ||
+          thread->th.th_pool_time > expired)
+        continue;
+      // the workers of these teams enter the pool behind the current position
+      __kmp_free_hot_teams(root, thread, 1, __kmp_hot_teams_max_level);
+      __kmp_hot_teams_lru_forget(thread);
+      __kmp_free(thread->th.th_hot_teams);
+      thread->th.th_hot_teams = NULL;
+      freed = true;
+    }
+    if (freed) {
+      for (thread = CCAST(kmp_info_t *, __kmp_thread_pool); thread != NULL;
+           thread = thread->th.th_next_pool)
+        if (thread->th.th_pool_time >= now)
+          thread->th.th_pool_time = expired;
+    }
+  }
+#endif
+
+  // Reap the threads that timed out, and find when the next one times out
+  for (thread = CCAST(kmp_info_t *, __kmp_thread_pool); thread != NULL;
+       thread = thread->th.th_next_pool) {
+    if (TCR_4(thread->th.th_reaped) || thread->th.th_pri_head != NULL)
+      continue;
+    if (thread->th.th_pool_time > expired) {
+      time_out = thread->th.th_pool_time + __kmp_pool_thread_timeout * 1e-3;
+      if (reap_time == 0 || time_out < reap_time)
+        reap_time = time_out;
+      continue;
+    }
+    KMP_DEBUG_ASSERT(thread->th.th_reap_state == KMP_SAFE_TO_REAP);
+    KA_TRACE(10, ("__kmp_reap_pool_threads: reaping idle T#%d\n",
+                  thread->th.th_info.ds.ds_gtid));
+    TCW_4(thread->th.th_reaped, TRUE);
+    KMP_MB();
+    __kmp_reap_worker_thread(thread);
+    thread->th.th_reap_state = KMP_SAFE_TO_REAP;
+    __kmp_trim_thread_memory(thread);
+    if (thread->th.th_cons) { // a new OS thread allocates its own
+      __kmp_free_cons_stack(thread->th.th_cons);
+      thread->th.th_cons = NULL;
+    }
+    thread->th.th_used_in_team = 0;
+  }
+  KMP_ATOMIC_ST_REL(&__kmp_pool_reap_time, reap_time);
+}
+
+// Start a new OS thread for a thread taken from the pool after it was reaped.
+static void __kmp_restart_pool_thread(kmp_info_t *thread) {
+  kmp_balign_t *balign = thread->th.th_bar;
+  int b;
+
+  KA_TRACE(10, ("__kmp_restart_pool_thread: T#%d\n",
+                thread->th.th_info.ds.ds_gtid));
+  for (b = 0; b < bs_last_barrier; ++b) {
+    balign[b].bb.b_go = KMP_INIT_BARRIER_STATE;
+    balign[b].bb.wait_flag = KMP_BARRIER_NOT_WAITING;
+  }
+  TCW_PTR(thread->th.th_sleep_loc, NULL);
+  thread->th.th_sleep_loc_type = flag_unset;
+#if KMP_AFFINITY_SUPPORTED
+  thread->th.th_current_place = KMP_PLACE_UNDEFINED;
+  thread->th.th_new_place = KMP_PLACE_UNDEFINED;
+  thread->th.th_first_place = KMP_PLACE_UNDEFINED;
+  thread->th.th_last_place = KMP_PLACE_UNDEFINED;
+#endif
+  TCW_4(thread->th.th_active, TRUE);
+  TCW_4(thread->th.th_reaped, FALSE);
+  KMP_MB();
+  __kmp_create_worker(thread->th.th_info.ds.ds_gtid, thread, __kmp_stksize);
+}
+
 /* ------------------------------------------------------------------------ */
 
 void *__kmp_launch_thread(kmp_info_t *this_thr) {
@@ -6047,7 +6504,7 @@ void *__kmp_launch_thread(kmp_info_t *this_thr) {
 #endif
 
   /* This is the place where threads wait for work */
-  while (!TCR_4(__kmp_global.g.g_done)) {
+  while (!__kmp_worker_exiting(this_thr)) {
     KMP_DEBUG_ASSERT(this_thr == __kmp_threads[gtid]);
     KMP_MB();
 
@@ -6184,6 +6641,53 @@ void __kmp_internal_end_atexit(void) {
 #endif
 }
 
+// Release a worker thread from the fork barrier and wait for its OS thread to
+// exit.
+static void __kmp_reap_worker_thread(kmp_info_t *thread) {
+  // It is assumed __kmp_forkjoin_lock is acquired.
+
+  int gtid = thread->th.th_info.ds.ds_gtid;
+
+  if (__kmp_dflt_blocktime != KMP_MAX_BLOCKTIME) {
+    /* Assume the threads are at the fork barrier here */
+    KA_TRACE(
+        20, ("__kmp_reap_worker_thread: releasing T#%d from fork barrier for "
+             "reap\n",
+             gtid));
+    if (__kmp_barrier_gather_pattern[bs_forkjoin_barrier] == bp_dist_bar) {
+      while (
+          !KMP_COMPARE_AND_STORE_ACQ32(&(thread->th.th_used_in_team), 0, 3))
+        KMP_CPU_PAUSE();
+      __kmp_resume_32(gtid, (kmp_flag_32<false, false> *)NULL);
+    } else {
+      /* Need release fence here to prevent seg faults for tree forkjoin
+         barrier (GEH) */
+      kmp_flag_64<> flag(&thread->th.th_bar[bs_forkjoin_barrier].bb.b_go,
+                         thread);
+      __kmp_release_64(&flag);
+    }
+  }
+
+  // Terminate OS thread.
+  __kmp_reap_worker(thread);
+
+  // The thread was killed asynchronously.  If it was actively
+  // spinning in the thread pool, decrement the global count.
+  //
+  // There is a small timing hole here - if the worker thread was just waking
+  // up after sleeping in the pool, had reset it's th_active_in_pool flag but
+  // not decremented the global counter __kmp_thread_pool_active_nth yet, then
+  // the global counter might not get updated.
+  //
+  // Currently, this can only happen as the library is unloaded,
+  // so there are no harmful side effects.
+  if (thread->th.th_active_in_pool) {
+    thread->th.th_active_in_pool = FALSE;
+    KMP_ATOMIC_DEC(&__kmp_thread_pool_active_nth);
+    KMP_DEBUG_ASSERT(__kmp_thread_pool_active_nth >= 0);
+  }
+}
+
 static void __kmp_reap_thread(kmp_info_t *thread, int is_root) {
   // It is assumed __kmp_forkjoin_lock is acquired.
 
@@ -6193,45 +6697,9 @@ static void __kmp_reap_thread(kmp_info_t *thread, int is_root) {
 
   gtid = thread->th.th_info.ds.ds_gtid;
 
-  if (!is_root) {
-    if (__kmp_dflt_blocktime != KMP_MAX_BLOCKTIME) {
-      /* Assume the threads are at the fork barrier here */
-      KA_TRACE(
-          20, ("__kmp_reap_thread: releasing T#%d from fork barrier for reap\n",
-               gtid));
-      if (__kmp_barrier_gather_pattern[bs_forkjoin_barrier] == bp_dist_bar) {
-        while (
-            !KMP_COMPARE_AND_STORE_ACQ32(&(thread->th.th_used_in_team), 0, 3))
-          KMP_CPU_PAUSE();
-        __kmp_resume_32(gtid, (kmp_flag_32<false, false> *)NULL);
-      } else {
-        /* Need release fence here to prevent seg faults for tree forkjoin
-           barrier (GEH) */
-        kmp_flag_64<> flag(&thread->th.th_bar[bs_forkjoin_barrier].bb.b_go,
-                           thread);
-        __kmp_release_64(&flag);
-      }
-    }
-
-    // Terminate OS thread.
-    __kmp_reap_worker(thread);
-
-    // The thread was killed asynchronously.  If it was actively
-    // spinning in the thread pool, decrement the global count.
-    //
-    // There is a small timing hole here - if the worker thread was just waking
-    // up after sleeping in the pool, had reset it's th_active_in_pool flag but
-    // not decremented the global counter __kmp_thread_pool_active_nth yet, then
-    // the global counter might not get updated.
-    //
-    // Currently, this can only happen as the library is unloaded,
-    // so there are no harmful side effects.
-    if (thread->th.th_active_in_pool) {
-      thread->th.th_active_in_pool = FALSE;
-      KMP_ATOMIC_DEC(&__kmp_thread_pool_active_nth);
-      KMP_DEBUG_ASSERT(__kmp_thread_pool_active_nth >= 0);
-    }
-  }
+  // The OS thread of a thread reaped from the pool is already gone
+  if (!is_root && !TCR_4(thread->th.th_reaped))
+    __kmp_reap_worker_thread(thread);
 
   __kmp_free_implicit_task(thread);
 
@@ -6239,6 +6707,7 @@ static void __kmp_reap_thread(kmp_info_t *thread, int is_root) {
 #if USE_FAST_MEMORY
   __kmp_free_fast_memory(thread);
 #endif /* USE_FAST_MEMORY */
+  __kmp_task_cache_release(thread);
 
   __kmp_suspend_uninitialize_thread(thread);
 
@@ -6347,7 +6816,7 @@ static void __kmp_internal_end(void) {
 
   for (i = 0; i < __kmp_threads_capacity; i++)
     if (__kmp_root[i])
-      if (__kmp_root[i]->r.r_active)
+      if (TCR_SYNC_4(__kmp_root[i]->r.r_active))
         break;
   KMP_MB(); /* Flush all pending memory write invalidates.  */
   TCW_SYNC_4(__kmp_global.g.g_done, TRUE);
@@ -6507,7 +6976,7 @@ void __kmp_internal_end_library(int gtid_req) {
       /* we don't know who we are, but we may still shutdown the library */
     } else if (KMP_UBER_GTID(gtid)) {
       /* unregister ourselves as an uber thread.  gtid is no longer valid */
-      if (__kmp_root[gtid]->r.r_active) {
+      if (TCR_SYNC_4(__kmp_root[gtid]->r.r_active)) {
         __kmp_global.g.g_abort = -1;
         TCW_SYNC_4(__kmp_global.g.g_done, TRUE);
         __kmp_unregister_library();
@@ -6632,7 +7101,7 @@ void __kmp_internal_end_thread(int gtid_req) {
       /* we don't know who we are */
     } else if (KMP_UBER_GTID(gtid)) {
       /* unregister ourselves as an uber thread.  gtid is no longer valid */
-      if (__kmp_root[gtid]->r.r_active) {
+      if (TCR_SYNC_4(__kmp_root[gtid]->r.r_active)) {
         __kmp_global.g.g_abort = -1;
         TCW_SYNC_4(__kmp_global.g.g_done, TRUE);
         KA_TRACE(10,
@@ -7242,7 +7711,12 @@ static void __kmp_do_serial_initialize(void) {
   KMP_DEBUG_ASSERT(__kmp_team_pool == NULL);
   __kmp_thread_pool = NULL;
   __kmp_thread_pool_insert_pt = NULL;
+  KMP_ATOMIC_ST_RLX(&__kmp_pool_reap_time, 0);
   __kmp_team_pool = NULL;
+#if KMP_NESTED_HOT_TEAMS
+  __kmp_hot_teams_lru = NULL;
+  __kmp_hot_teams_lru_tail = NULL;
+#endif
 
   /* Allocate all of the variable sized records */
   /* NOTE: __kmp_threads_capacity entries are allocated, but the arrays are
@@ -8200,6 +8674,7 @@ void __kmp_cleanup(void) {
   }
 
   __kmp_cleanup_threadprivate_caches();
+  __kmp_taskgraph_cleanup();
 
   for (f = 0; f < __kmp_threads_capacity; f++) {
     if (__kmp_root[f] != NULL) {
@@ -707,6 +707,25 @@ static void __kmp_stg_print_use_yield(kmp_str_buf_t *buffer, char const *name,
   __kmp_stg_print_int(buffer, name, __kmp_use_yield);
 } // __kmp_stg_print_use_yield
 
+// -----------------------------------------------------------------------------
+// KMP_FUTEX_SUSPEND
+
+#if KMP_USE_FUTEX
+static void __kmp_stg_parse_futex_suspend(char const *name, char const *value,
+                                          void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_futex_suspend);
+  if (__kmp_futex_suspend && !__kmp_futex_determine_capable()) {
+    KMP_WARNING(FutexNotSupported, name, value);
+    __kmp_futex_suspend = FALSE;
+  }
+} // __kmp_stg_parse_futex_suspend
+
+static void __kmp_stg_print_futex_suspend(kmp_str_buf_t *buffer,
+                                          char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_futex_suspend);
+} // __kmp_stg_print_futex_suspend
+#endif
+
 // -----------------------------------------------------------------------------
 // KMP_BLOCKTIME
 
@@ -752,6 +771,21 @@ static void __kmp_stg_print_blocktime(kmp_str_buf_t *buffer, char const *name,
   __kmp_stg_print_int(buffer, name, __kmp_dflt_blocktime);
 } // __kmp_stg_print_blocktime
 
+// -----------------------------------------------------------------------------
+// KMP_ADAPTIVE_BLOCKTIME
+
+#if !KMP_USE_MONITOR
+static void __kmp_stg_parse_adaptive_blocktime(char const *name,
+                                               char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_adaptive_blocktime);
+} // __kmp_stg_parse_adaptive_blocktime
+
+static void __kmp_stg_print_adaptive_blocktime(kmp_str_buf_t *buffer,
+                                               char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_adaptive_blocktime);
+} // __kmp_stg_print_adaptive_blocktime
+#endif
+
 // -----------------------------------------------------------------------------
 // KMP_DUPLICATE_LIB_OK
 
@@ -1438,6 +1472,20 @@ static void __kmp_stg_print_taskloop_min_tasks(kmp_str_buf_t *buffer,
   __kmp_stg_print_uint64(buffer, name, __kmp_taskloop_min_tasks);
 } // __kmp_stg_print_taskloop_min_tasks
 
+// KMP_TASKLOOP_ADAPTIVE
+// target duration of taskloop tasks in microseconds, used to choose the
+// grainsize of taskloops without grainsize or num_tasks clause
+static void __kmp_stg_parse_taskloop_adaptive(char const *name,
+                                              char const *value, void *data) {
+  __kmp_stg_parse_int(name, value, 0, KMP_USEC_PER_SEC,
+                      &__kmp_taskloop_adaptive);
+} // __kmp_stg_parse_taskloop_adaptive
+
+static void __kmp_stg_print_taskloop_adaptive(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_taskloop_adaptive);
+} // __kmp_stg_print_taskloop_adaptive
+
 // -----------------------------------------------------------------------------
 // KMP_DISP_NUM_BUFFERS
 static void __kmp_stg_parse_disp_buffers(char const *name, char const *value,
@@ -1457,7 +1505,7 @@ static void __kmp_stg_print_disp_buffers(kmp_str_buf_t *buffer,
 
 #if KMP_NESTED_HOT_TEAMS
 // -----------------------------------------------------------------------------
-// KMP_HOT_TEAMS_MAX_LEVEL, KMP_HOT_TEAMS_MODE
+// KMP_HOT_TEAMS_MAX_LEVEL, KMP_HOT_TEAMS_MODE, KMP_HOT_TEAMS_MAX_THREADS
 
 static void __kmp_stg_parse_hot_teams_level(char const *name, char const *value,
                                             void *data) {
@@ -1489,8 +1537,38 @@ static void __kmp_stg_print_hot_teams_mode(kmp_str_buf_t *buffer,
   __kmp_stg_print_int(buffer, name, __kmp_hot_teams_mode);
 } // __kmp_stg_print_hot_teams_mode
 
+static void __kmp_stg_parse_hot_teams_max_threads(char const *name,
+                                                  char const *value,
+                                                  void *data) {
+  if (TCR_4(__kmp_init_parallel)) {
+    KMP_WARNING(EnvParallelWarn, name);
+    return;
+  } // read value before first parallel only
+  __kmp_stg_parse_int(name, value, 0, KMP_MAX_NTH,
+                      &__kmp_hot_teams_max_threads);
+} // __kmp_stg_parse_hot_teams_max_threads
+
+static void __kmp_stg_print_hot_teams_max_threads(kmp_str_buf_t *buffer,
+                                                  char const *name,
+                                                  void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_hot_teams_max_threads);
+} // __kmp_stg_print_hot_teams_max_threads
+
 #endif // KMP_NESTED_HOT_TEAMS
 
+// -----------------------------------------------------------------------------
+// KMP_HOT_TEAMS_FAST_FORK
+
+static void __kmp_stg_parse_hot_teams_fast_fork(char const *name,
+                                                char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_hot_teams_fast_fork);
+} // __kmp_stg_parse_hot_teams_fast_fork
+
+static void __kmp_stg_print_hot_teams_fast_fork(kmp_str_buf_t *buffer,
+                                                char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_hot_teams_fast_fork);
+} // __kmp_stg_print_hot_teams_fast_fork
+
 // -----------------------------------------------------------------------------
 // KMP_HANDLE_SIGNALS
 
@@ -1733,6 +1811,22 @@ static void __kmp_stg_parse_barrier_pattern(char const *name, char const *value,
           } else {
             non_dist_req++;
           }
+          if (j == bp_auto_bar && i == bs_forkjoin_barrier) {
+            // the fork/join barrier patterns are fixed for all teams
+            KMP_WARNING(BarrGatherValueInvalid, name, value);
+            KMP_INFORM(
+                Using_str_Value, name,
+                __kmp_barrier_pattern_name[__kmp_barrier_gather_pattern[i]]);
+            break;
+          }
+          if (j == bp_dissem_bar && i == bs_forkjoin_barrier) {
+            // threads leave the dissemination gather on their own, while the
+            // team may be freed after the join barrier
+            KMP_WARNING(BarrGatherValueInvalid, name, value);
+            KMP_INFORM(Using_str_Value, name,
+                       __kmp_barrier_pattern_name[bp_tournament_bar]);
+            j = bp_tournament_bar;
+          }
           __kmp_barrier_gather_pattern[i] = (kmp_bar_pat_e)j;
           break;
         }
@@ -1752,6 +1846,15 @@ static void __kmp_stg_parse_barrier_pattern(char const *name, char const *value,
             } else {
               non_dist_req++;
             }
+            if (j == bp_auto_bar && i == bs_forkjoin_barrier) {
+              __kmp_msg(kmp_ms_warning,
+                        KMP_MSG(BarrReleaseValueInvalid, name, comma + 1),
+                        __kmp_msg_null);
+              KMP_INFORM(Using_str_Value, name,
+                         __kmp_barrier_pattern_name
+                             [__kmp_barrier_release_pattern[i]]);
+              break;
+            }
             __kmp_barrier_release_pattern[i] = (kmp_bar_pat_e)j;
             break;
           }
@@ -1764,6 +1867,13 @@ static void __kmp_stg_parse_barrier_pattern(char const *name, char const *value,
                      __kmp_barrier_pattern_name[bp_linear_bar]);
         }
       }
+
+      // the auto pattern chooses gather and release together
+      if (__kmp_barrier_gather_pattern[i] == bp_auto_bar ||
+          __kmp_barrier_release_pattern[i] == bp_auto_bar) {
+        __kmp_barrier_gather_pattern[i] = bp_auto_bar;
+        __kmp_barrier_release_pattern[i] = bp_auto_bar;
+      }
     }
   }
   if (dist_req != 0) {
@@ -1803,6 +1913,21 @@ static void __kmp_stg_print_barrier_pattern(kmp_str_buf_t *buffer,
   }
 } // __kmp_stg_print_barrier_pattern
 
+// -----------------------------------------------------------------------------
+// KMP_BARRIER_AUTO_SAMPLES
+
+static void __kmp_stg_parse_barrier_auto_samples(char const *name,
+                                                 char const *value,
+                                                 void *data) {
+  __kmp_stg_parse_int(name, value, 1, 1000, &__kmp_barrier_auto_samples);
+} // __kmp_stg_parse_barrier_auto_samples
+
+static void __kmp_stg_print_barrier_auto_samples(kmp_str_buf_t *buffer,
+                                                 char const *name,
+                                                 void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_barrier_auto_samples);
+} // __kmp_stg_print_barrier_auto_samples
+
 // -----------------------------------------------------------------------------
 // KMP_ABORT_DELAY
 
@@ -3892,6 +4017,12 @@ static void __kmp_stg_parse_kmp_dynamic_mode(char const *name,
            __kmp_str_match("threadlimit", 1, value) ||
            __kmp_str_match("limit", 2, value)) {
     __kmp_global.g.g_dynamic_mode = dynamic_thread_limit;
+  } else if (__kmp_str_match("thread budget", 8, value) ||
+             __kmp_str_match("thread_budget", 8, value) ||
+             __kmp_str_match("thread-budget", 8, value) ||
+             __kmp_str_match("threadbudget", 7, value) ||
+             __kmp_str_match("budget", 2, value)) {
+    __kmp_global.g.g_dynamic_mode = dynamic_thread_budget;
   } else if (__kmp_str_match("random", 1, value)) {
     __kmp_global.g.g_dynamic_mode = dynamic_random;
   } else {
@@ -3912,6 +4043,8 @@ static void __kmp_stg_print_kmp_dynamic_mode(kmp_str_buf_t *buffer,
 #endif /* USE_LOAD_BALANCE */
   else if (__kmp_global.g.g_dynamic_mode == dynamic_thread_limit) {
     __kmp_stg_print_str(buffer, name, "thread limit");
+  } else if (__kmp_global.g.g_dynamic_mode == dynamic_thread_budget) {
+    __kmp_stg_print_str(buffer, name, "thread budget");
   } else if (__kmp_global.g.g_dynamic_mode == dynamic_random) {
     __kmp_stg_print_str(buffer, name, "random");
   } else {
@@ -3945,6 +4078,37 @@ static void __kmp_stg_print_ld_balance_interval(kmp_str_buf_t *buffer,
 
 #endif /* USE_LOAD_BALANCE */
 
+// -----------------------------------------------------------------------------
+// KMP_THREAD_BUDGET
+
+static void __kmp_stg_parse_thread_budget(char const *name, char const *value,
+                                          void *data) {
+  if (TCR_4(__kmp_init_parallel)) {
+    KMP_WARNING(EnvParallelWarn, name);
+    __kmp_env_toPrint(name, 0);
+    return;
+  } // read value before first parallel only
+  __kmp_stg_parse_int(name, value, 0, KMP_MAX_NTH, &__kmp_thread_budget);
+} // __kmp_stg_parse_thread_budget
+
+static void __kmp_stg_print_thread_budget(kmp_str_buf_t *buffer,
+                                          char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_thread_budget);
+} // __kmp_stg_print_thread_budget
+
+// -----------------------------------------------------------------------------
+// KMP_POOL_THREAD_TIMEOUT
+
+static void __kmp_stg_parse_pool_thread_timeout(char const *name,
+                                                char const *value, void *data) {
+  __kmp_stg_parse_int(name, value, 0, INT_MAX, &__kmp_pool_thread_timeout);
+} // __kmp_stg_parse_pool_thread_timeout
+
+static void __kmp_stg_print_pool_thread_timeout(kmp_str_buf_t *buffer,
+                                                char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_pool_thread_timeout);
+} // __kmp_stg_print_pool_thread_timeout
+
 // -----------------------------------------------------------------------------
 // KMP_INIT_AT_FORK
 
@@ -4042,6 +4206,7 @@ static void __kmp_stg_print_schedule(kmp_str_buf_t *buffer, char const *name,
 static inline void __kmp_omp_schedule_restore() {
 #if KMP_USE_HIER_SCHED
   __kmp_hier_scheds.deallocate();
+  __kmp_hier_auto = FALSE;
 #endif
   __kmp_chunk = 0;
   __kmp_sched = kmp_sch_default;
@@ -4051,6 +4216,8 @@ static inline void __kmp_omp_schedule_restore() {
 //    Parse [HW,][modifier:]kind[,chunk]
 // else:
 //    Parse [modifier:]kind[,chunk]
+// where kind hierarchical is a dynamic schedule whose layers are taken from
+// the machine topology
 static const char *__kmp_parse_single_omp_schedule(const char *name,
                                                    const char *value,
                                                    bool parse_hier = false) {
@@ -4059,6 +4226,9 @@ static const char *__kmp_parse_single_omp_schedule(const char *name,
   const char *delim;
   int chunk = 0;
   enum sched_type sched = kmp_sch_default;
+#if KMP_USE_HIER_SCHED
+  int hier_auto = FALSE;
+#endif
   if (*ptr == '\0')
     return NULL;
   delim = ptr;
@@ -4128,6 +4298,15 @@ static const char *__kmp_parse_single_omp_schedule(const char *name,
     sched = kmp_sch_dynamic_chunked;
     sched_modifier = sched_type::kmp_sch_modifier_nonmonotonic;
   }
+#endif
+#if KMP_USE_HIER_SCHED
+  else if (!__kmp_strcasecmp_with_sentinel("hierarchical", ptr, *delim) &&
+           layer == kmp_hier_layer_e::LAYER_THREAD) {
+    // the threads use dynamic within the layers set up at affinity
+    // initialization
+    sched = kmp_sch_dynamic_chunked;
+    hier_auto = TRUE;
+  }
 #endif
   else {
     // If there is no proper schedule kind, then this schedule is invalid
@@ -4189,6 +4368,9 @@ static const char *__kmp_parse_single_omp_schedule(const char *name,
   {
     __kmp_chunk = chunk;
     __kmp_sched = sched;
+#if KMP_USE_HIER_SCHED
+    __kmp_hier_auto = hier_auto;
+#endif
   }
   return ptr;
 }
@@ -4236,6 +4418,15 @@ static void __kmp_stg_print_omp_schedule(kmp_str_buf_t *buffer,
   } else {
     __kmp_str_buf_print(buffer, "   %s='", name);
   }
+#if KMP_USE_HIER_SCHED
+  if (__kmp_hier_auto) {
+    if (__kmp_chunk)
+      __kmp_str_buf_print(buffer, "%s,%d'\n", "hierarchical", __kmp_chunk);
+    else
+      __kmp_str_buf_print(buffer, "%s'\n", "hierarchical");
+    return;
+  }
+#endif
   enum sched_type sched = SCHEDULE_WITHOUT_MODIFIERS(__kmp_sched);
   if (SCHEDULE_HAS_MONOTONIC(__kmp_sched)) {
     __kmp_str_buf_print(buffer, "monotonic:");
@@ -4321,6 +4512,53 @@ static void __kmp_stg_print_kmp_force_monotonic(kmp_str_buf_t *buffer,
   __kmp_stg_print_bool(buffer, name, __kmp_force_monotonic);
 } // __kmp_stg_print_kmp_force_monotonic
 
+// -----------------------------------------------------------------------------
+// KMP_AUTO_LEARN, KMP_AUTO_LEARN_REPORT
+static void __kmp_stg_parse_auto_learn(char const *name, char const *value,
+                                       void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_auto_learn);
+} // __kmp_stg_parse_auto_learn
+
+static void __kmp_stg_print_auto_learn(kmp_str_buf_t *buffer, char const *name,
+                                       void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_auto_learn);
+} // __kmp_stg_print_auto_learn
+
+static void __kmp_stg_parse_auto_learn_report(char const *name,
+                                              char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_auto_learn_report);
+} // __kmp_stg_parse_auto_learn_report
+
+static void __kmp_stg_print_auto_learn_report(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_auto_learn_report);
+} // __kmp_stg_print_auto_learn_report
+
+// -----------------------------------------------------------------------------
+// KMP_DYNAMIC_BATCH
+static void __kmp_stg_parse_dynamic_batch(char const *name, char const *value,
+                                          void *data) {
+  __kmp_stg_parse_int(name, value, 0, KMP_MAX_DYNAMIC_BATCH,
+                      &__kmp_dynamic_batch);
+} // __kmp_stg_parse_dynamic_batch
+
+static void __kmp_stg_print_dynamic_batch(kmp_str_buf_t *buffer,
+                                          char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_dynamic_batch);
+} // __kmp_stg_print_dynamic_batch
+
+// -----------------------------------------------------------------------------
+// KMP_ORDERED_TICKETS
+static void __kmp_stg_parse_ordered_tickets(char const *name,
+                                            char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_ordered_tickets);
+} // __kmp_stg_parse_ordered_tickets
+
+static void __kmp_stg_print_ordered_tickets(kmp_str_buf_t *buffer,
+                                            char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_ordered_tickets);
+} // __kmp_stg_print_ordered_tickets
+
 // -----------------------------------------------------------------------------
 // KMP_ATOMIC_MODE
 
@@ -5191,6 +5429,97 @@ static void __kmp_stg_print_task_throttling(kmp_str_buf_t *buffer,
   __kmp_stg_print_bool(buffer, name, __kmp_enable_task_throttling);
 } // __kmp_stg_print_task_throttling
 
+// -----------------------------------------------------------------------------
+// KMP_TASK_DEQUE_LOCKFREE
+
+static void __kmp_stg_parse_task_deque_lockfree(char const *name,
+                                                char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_deque_lockfree);
+} // __kmp_stg_parse_task_deque_lockfree
+
+static void __kmp_stg_print_task_deque_lockfree(kmp_str_buf_t *buffer,
+                                                char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_deque_lockfree);
+} // __kmp_stg_print_task_deque_lockfree
+
+// -----------------------------------------------------------------------------
+// KMP_TASK_STEAL_HALF
+
+static void __kmp_stg_parse_task_steal_half(char const *name,
+                                            char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_steal_half);
+} // __kmp_stg_parse_task_steal_half
+
+static void __kmp_stg_print_task_steal_half(kmp_str_buf_t *buffer,
+                                            char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_steal_half);
+} // __kmp_stg_print_task_steal_half
+
+// -----------------------------------------------------------------------------
+// KMP_TASK_STEAL_HIER
+
+static void __kmp_stg_parse_task_steal_hier(char const *name,
+                                            char const *value, void *data) {
+  __kmp_stg_parse_int(name, value, 0, KMP_INT_MAX, &__kmp_task_steal_hier);
+} // __kmp_stg_parse_task_steal_hier
+
+static void __kmp_stg_print_task_steal_hier(kmp_str_buf_t *buffer,
+                                            char const *name, void *data) {
+  __kmp_stg_print_int(buffer, name, __kmp_task_steal_hier);
+} // __kmp_stg_print_task_steal_hier
+
+// -----------------------------------------------------------------------------
+// KMP_TASK_ALLOC_CACHE
+
+static void __kmp_stg_parse_task_alloc_cache(char const *name,
+                                             char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_alloc_cache);
+} // __kmp_stg_parse_task_alloc_cache
+
+static void __kmp_stg_print_task_alloc_cache(kmp_str_buf_t *buffer,
+                                             char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_alloc_cache);
+} // __kmp_stg_print_task_alloc_cache
+
+// -----------------------------------------------------------------------------
+// KMP_TASK_PRIORITY_MQ
+
+static void __kmp_stg_parse_task_priority_mq(char const *name,
+                                             char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_priority_mq);
+} // __kmp_stg_parse_task_priority_mq
+
+static void __kmp_stg_print_task_priority_mq(kmp_str_buf_t *buffer,
+                                             char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_priority_mq);
+} // __kmp_stg_print_task_priority_mq
+
+// -----------------------------------------------------------------------------
+// KMP_TASK_AFFINITY
+
+static void __kmp_stg_parse_task_affinity(char const *name, char const *value,
+                                          void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_affinity);
+} // __kmp_stg_parse_task_affinity
+
+static void __kmp_stg_print_task_affinity(kmp_str_buf_t *buffer,
+                                          char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_affinity);
+} // __kmp_stg_print_task_affinity
+
+// -----------------------------------------------------------------------------
+// KMP_TASK_MTX_TOKENS
+
+static void __kmp_stg_parse_task_mtx_tokens(char const *name,
+                                            char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_mtx_tokens);
+} // __kmp_stg_parse_task_mtx_tokens
+
+static void __kmp_stg_print_task_mtx_tokens(kmp_str_buf_t *buffer,
+                                            char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_mtx_tokens);
+} // __kmp_stg_print_task_mtx_tokens
+
 #if KMP_HAVE_MWAIT || KMP_HAVE_UMWAIT
 // -----------------------------------------------------------------------------
 // KMP_USER_LEVEL_MWAIT
@@ -5347,8 +5676,16 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_ALL_THREADS", __kmp_stg_parse_device_thread_limit, NULL, NULL, 0, 0},
     {"KMP_BLOCKTIME", __kmp_stg_parse_blocktime, __kmp_stg_print_blocktime,
      NULL, 0, 0},
+#if !KMP_USE_MONITOR
+    {"KMP_ADAPTIVE_BLOCKTIME", __kmp_stg_parse_adaptive_blocktime,
+     __kmp_stg_print_adaptive_blocktime, NULL, 0, 0},
+#endif
     {"KMP_USE_YIELD", __kmp_stg_parse_use_yield, __kmp_stg_print_use_yield,
      NULL, 0, 0},
+#if KMP_USE_FUTEX
+    {"KMP_FUTEX_SUSPEND", __kmp_stg_parse_futex_suspend,
+     __kmp_stg_print_futex_suspend, NULL, 0, 0},
+#endif
     {"KMP_DUPLICATE_LIB_OK", __kmp_stg_parse_duplicate_lib_ok,
      __kmp_stg_print_duplicate_lib_ok, NULL, 0, 0},
     {"KMP_LIBRARY", __kmp_stg_parse_wait_policy, __kmp_stg_print_wait_policy,
@@ -5394,6 +5731,8 @@ static kmp_setting_t __kmp_stg_table[] = {
      __kmp_stg_print_max_task_priority, NULL, 0, 0},
     {"KMP_TASKLOOP_MIN_TASKS", __kmp_stg_parse_taskloop_min_tasks,
      __kmp_stg_print_taskloop_min_tasks, NULL, 0, 0},
+    {"KMP_TASKLOOP_ADAPTIVE", __kmp_stg_parse_taskloop_adaptive,
+     __kmp_stg_print_taskloop_adaptive, NULL, 0, 0},
     {"OMP_THREAD_LIMIT", __kmp_stg_parse_thread_limit,
      __kmp_stg_print_thread_limit, NULL, 0, 0},
     {"KMP_TEAMS_THREAD_LIMIT", __kmp_stg_parse_teams_thread_limit,
@@ -5411,7 +5750,11 @@ static kmp_setting_t __kmp_stg_table[] = {
      __kmp_stg_print_hot_teams_level, NULL, 0, 0},
     {"KMP_HOT_TEAMS_MODE", __kmp_stg_parse_hot_teams_mode,
      __kmp_stg_print_hot_teams_mode, NULL, 0, 0},
+    {"KMP_HOT_TEAMS_MAX_THREADS", __kmp_stg_parse_hot_teams_max_threads,
+     __kmp_stg_print_hot_teams_max_threads, NULL, 0, 0},
 #endif // KMP_NESTED_HOT_TEAMS
+    {"KMP_HOT_TEAMS_FAST_FORK", __kmp_stg_parse_hot_teams_fast_fork,
+     __kmp_stg_print_hot_teams_fast_fork, NULL, 0, 0},
 
 #if KMP_HANDLE_SIGNALS
     {"KMP_HANDLE_SIGNALS", __kmp_stg_parse_handle_signals,
@@ -5472,6 +5815,8 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_REDUCTION_BARRIER_PATTERN", __kmp_stg_parse_barrier_pattern,
      __kmp_stg_print_barrier_pattern, NULL, 0, 0},
 #endif
+    {"KMP_BARRIER_AUTO_SAMPLES", __kmp_stg_parse_barrier_auto_samples,
+     __kmp_stg_print_barrier_auto_samples, NULL, 0, 0},
 
     {"KMP_ABORT_DELAY", __kmp_stg_parse_abort_delay,
      __kmp_stg_print_abort_delay, NULL, 0, 0},
@@ -5531,6 +5876,14 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_FORCE_MONOTONIC_DYNAMIC_SCHEDULE",
      __kmp_stg_parse_kmp_force_monotonic, __kmp_stg_print_kmp_force_monotonic,
      NULL, 0, 0},
+    {"KMP_AUTO_LEARN", __kmp_stg_parse_auto_learn, __kmp_stg_print_auto_learn,
+     NULL, 0, 0},
+    {"KMP_AUTO_LEARN_REPORT", __kmp_stg_parse_auto_learn_report,
+     __kmp_stg_print_auto_learn_report, NULL, 0, 0},
+    {"KMP_DYNAMIC_BATCH", __kmp_stg_parse_dynamic_batch,
+     __kmp_stg_print_dynamic_batch, NULL, 0, 0},
+    {"KMP_ORDERED_TICKETS", __kmp_stg_parse_ordered_tickets,
+     __kmp_stg_print_ordered_tickets, NULL, 0, 0},
     {"KMP_ATOMIC_MODE", __kmp_stg_parse_atomic_mode,
      __kmp_stg_print_atomic_mode, NULL, 0, 0},
     {"KMP_CONSISTENCY_CHECK", __kmp_stg_parse_consistency_check,
@@ -5553,6 +5906,10 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_LOAD_BALANCE_INTERVAL", __kmp_stg_parse_ld_balance_interval,
      __kmp_stg_print_ld_balance_interval, NULL, 0, 0},
 #endif
+    {"KMP_THREAD_BUDGET", __kmp_stg_parse_thread_budget,
+     __kmp_stg_print_thread_budget, NULL, 0, 0},
+    {"KMP_POOL_THREAD_TIMEOUT", __kmp_stg_parse_pool_thread_timeout,
+     __kmp_stg_print_pool_thread_timeout, NULL, 0, 0},
 
     {"KMP_NUM_LOCKS_IN_BLOCK", __kmp_stg_parse_lock_block,
      __kmp_stg_print_lock_block, NULL, 0, 0},
@@ -5580,6 +5937,20 @@ static kmp_setting_t __kmp_stg_table[] = {
 #endif
     {"KMP_ENABLE_TASK_THROTTLING", __kmp_stg_parse_task_throttling,
      __kmp_stg_print_task_throttling, NULL, 0, 0},
+    {"KMP_TASK_DEQUE_LOCKFREE", __kmp_stg_parse_task_deque_lockfree,
+     __kmp_stg_print_task_deque_lockfree, NULL, 0, 0},
+    {"KMP_TASK_STEAL_HALF", __kmp_stg_parse_task_steal_half,
+     __kmp_stg_print_task_steal_half, NULL, 0, 0},
+    {"KMP_TASK_STEAL_HIER", __kmp_stg_parse_task_steal_hier,
+     __kmp_stg_print_task_steal_hier, NULL, 0, 0},
+    {"KMP_TASK_ALLOC_CACHE", __kmp_stg_parse_task_alloc_cache,
+     __kmp_stg_print_task_alloc_cache, NULL, 0, 0},
+    {"KMP_TASK_PRIORITY_MQ", __kmp_stg_parse_task_priority_mq,
+     __kmp_stg_print_task_priority_mq, NULL, 0, 0},
+    {"KMP_TASK_AFFINITY", __kmp_stg_parse_task_affinity,
+     __kmp_stg_print_task_affinity, NULL, 0, 0},
+    {"KMP_TASK_MTX_TOKENS", __kmp_stg_parse_task_mtx_tokens,
+     __kmp_stg_print_task_mtx_tokens, NULL, 0, 0},
 
     {"OMP_DISPLAY_ENV", __kmp_stg_parse_omp_display_env,
      __kmp_stg_print_omp_display_env, NULL, 0, 0},
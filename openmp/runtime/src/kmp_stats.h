@@ -114,7 +114,10 @@ enum stats_state_e {
   macro(OMP_TASKLOOP, 0, arg)                                                  \
   macro(TASK_executed, 0, arg)                                                 \
   macro(TASK_cancelled, 0, arg)                                                \
-  macro(TASK_stolen, 0, arg)
+  macro(TASK_stolen, 0, arg)                                                   \
+  macro(TASK_cache_hit, 0, arg)                                                \
+  macro(TASK_cache_miss, 0, arg)                                               \
+  macro(TASK_cache_remote_free, 0, arg)
 // clang-format on
 
 /*!
@@ -181,6 +184,7 @@ enum stats_state_e {
          stats_flags_e::noUnits | stats_flags_e::noTotal, arg)                 \
   macro (OMP_distribute_iterations,                                            \
          stats_flags_e::noUnits | stats_flags_e::noTotal, arg)                 \
+  macro (OMP_blocktime_saved, stats_flags_e::noUnits, arg)                     \
   KMP_FOREACH_DEVELOPER_TIMER(macro, arg)
 // clang-format on
 
@@ -232,6 +236,8 @@ enum stats_state_e {
 //                               statically scheduled loops
 // OMP_loop_dynamic_iterations -- Number of iterations thread is assigned for
 //                                dynamically scheduled loops
+// OMP_blocktime_saved    -- Microseconds of spinning before a suspend that
+//                           KMP_ADAPTIVE_BLOCKTIME skipped
 
 #if (KMP_DEVELOPER_STATS)
 // Timers which are of interest to runtime library developers, not end users.
@@ -241,6 +247,8 @@ enum stats_state_e {
 // KMP_join_barrier       -- time in __kmp_join_barrier
 // KMP_barrier            -- time in __kmp_barrier
 // KMP_end_split_barrier  -- time in __kmp_end_split_barrier
+// KMP_split_barrier_arrive -- time in __kmp_split_barrier_arrive
+// KMP_split_barrier_wait -- time in __kmp_split_barrier_wait
 // KMP_setup_icv_copy     -- time in __kmp_setup_icv_copy
 // KMP_icv_copy           -- start/stop timer for any ICV copying
 // KMP_linear_gather      -- time in __kmp_linear_barrier_gather
@@ -251,17 +259,23 @@ enum stats_state_e {
 // KMP_hyper_release      -- time in __kmp_hyper_barrier_release
 // KMP_dist_gather       -- time in __kmp_dist_barrier_gather
 // KMP_dist_release      -- time in __kmp_dist_barrier_release
+// KMP_dissem_gather      -- time in __kmp_dissem_barrier_gather
+// KMP_tournament_gather  -- time in __kmp_tournament_barrier_gather
 // clang-format off
 #define KMP_FOREACH_DEVELOPER_TIMER(macro, arg)                                \
   macro(KMP_fork_call, 0, arg)                                                 \
   macro(KMP_join_call, 0, arg)                                                 \
   macro(KMP_end_split_barrier, 0, arg)                                         \
+  macro(KMP_split_barrier_arrive, 0, arg)                                      \
+  macro(KMP_split_barrier_wait, 0, arg)                                        \
   macro(KMP_hier_gather, 0, arg)                                               \
   macro(KMP_hier_release, 0, arg)                                              \
   macro(KMP_hyper_gather, 0, arg)                                              \
   macro(KMP_hyper_release, 0, arg)                                             \
   macro(KMP_dist_gather, 0, arg)                                              \
   macro(KMP_dist_release, 0, arg)                                             \
+  macro(KMP_dissem_gather, 0, arg)                                             \
+  macro(KMP_tournament_gather, 0, arg)                                         \
   macro(KMP_linear_gather, 0, arg)                                             \
   macro(KMP_linear_release, 0, arg)                                            \
   macro(KMP_tree_gather, 0, arg)                                               \
@@ -40,6 +40,10 @@ static void __kmp_init_node(kmp_depnode_t *node) {
   for (int i = 0; i < MAX_MTX_DEPS; ++i)
     node->dn.mtx_locks[i] = NULL;
   node->dn.mtx_num_locks = 0;
+  node->dn.mtx_num_tokens = 0;
+  node->dn.mtx_num_owned = 0;
+  node->dn.mtx_next_waiter = NULL;
+  node->dn.tg_index = -1;
   __kmp_init_lock(&node->dn.lock);
   KMP_ATOMIC_ST_RLX(&node->dn.nrefs, 1); // init creates the first reference
 #ifdef KMP_SUPPORT_GRAPH_OUTPUT
@@ -55,71 +59,173 @@ static inline kmp_depnode_t *__kmp_node_ref(kmp_depnode_t *node) {
   return node;
 }
 
-enum { KMP_DEPHASH_OTHER_SIZE = 97, KMP_DEPHASH_MASTER_SIZE = 997 };
-
-size_t sizes[] = {997, 2003, 4001, 8191, 16001, 32003, 64007, 131071, 270029};
-const size_t MAX_GEN = 8;
+// Save the token of a mutexinoutset set in the node, sorted in decreasing
+// order so that all tasks take the tokens in the same order
+static void __kmp_mtx_add_token(kmp_depnode_t *node,
+                                kmp_dephash_entry_t *info) {
+  if (info->mtx_token == NULL) {
+    info->mtx_token =
+        (kmp_mtx_token_t *)__kmp_allocate(sizeof(kmp_mtx_token_t));
+    KMP_ATOMIC_ST_RLX(&info->mtx_token->state, KMP_MTX_TOKEN_FREE);
+    __kmp_init_bootstrap_lock(&info->mtx_token->lock);
+    info->mtx_token->head = info->mtx_token->tail = NULL;
+  }
+  kmp_int32 n = node->dn.mtx_num_tokens;
+  KMP_DEBUG_ASSERT(n < MAX_MTX_DEPS);
+  for (; n > 0 && node->dn.mtx_tokens[n - 1] < info->mtx_token; --n)
+    node->dn.mtx_tokens[n] = node->dn.mtx_tokens[n - 1];
+  node->dn.mtx_tokens[n] = info->mtx_token;
+  node->dn.mtx_num_tokens++;
+}
 
-static inline size_t __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
-  // TODO alternate to try: set = (((Addr64)(addrUsefulBits * 9.618)) %
-  // m_num_sets );
-  return ((addr >> 6) ^ (addr >> 2)) % hsize;
+// Take the tokens of the node not owned yet, in order. Returns false if the
+// node had to wait for a token, the releasing owner then hands it over and
+// continues with the remaining tokens on behalf of the node.
+bool __kmp_mtx_acquire_tokens(kmp_depnode_t *node) {
+  for (kmp_int32 i = node->dn.mtx_num_owned; i < node->dn.mtx_num_tokens;
+       ++i) {
+    kmp_mtx_token_t *token = node->dn.mtx_tokens[i];
+    kmp_int32 state = KMP_MTX_TOKEN_FREE;
+    if (token->state.compare_exchange_strong(state, KMP_MTX_TOKEN_OWNED)) {
+      node->dn.mtx_num_owned++;
+      continue;
+    }
+    // the lock orders waiters being queued against the owner releasing
+    __kmp_acquire_bootstrap_lock(&token->lock);
+    for (;;) {
+      state = KMP_ATOMIC_LD_ACQ(&token->state);
+      if (state == KMP_MTX_TOKEN_FREE) {
+        if (token->state.compare_exchange_strong(state, KMP_MTX_TOKEN_OWNED))
+          break;
+      } else if (state == KMP_MTX_TOKEN_CONTENDED ||
+                 token->state.compare_exchange_strong(
+                     state, KMP_MTX_TOKEN_CONTENDED)) {
+        node->dn.mtx_next_waiter = NULL;
+        if (token->tail)
+          token->tail->dn.mtx_next_waiter = node;
+        else
+          token->head = node;
+        token->tail = node;
+        __kmp_release_bootstrap_lock(&token->lock);
+        return false;
+      }
+    }
+    __kmp_release_bootstrap_lock(&token->lock);
+    node->dn.mtx_num_owned++;
+  }
+  return true;
 }
 
-static kmp_dephash_t *__kmp_dephash_extend(kmp_info_t *thread,
-                                           kmp_dephash_t *current_dephash) {
-  kmp_dephash_t *h;
+// Give back the tokens of a completed task, each one goes to its first waiter
+// if any. Waiters that end up owning all their tokens are scheduled.
+void __kmp_mtx_release_tokens(kmp_int32 gtid, kmp_depnode_t *node) {
+  KMP_DEBUG_ASSERT(node->dn.mtx_num_owned == node->dn.mtx_num_tokens);
+  for (kmp_int32 i = node->dn.mtx_num_tokens - 1; i >= 0; --i) {
+    kmp_mtx_token_t *token = node->dn.mtx_tokens[i];
+    kmp_int32 state = KMP_MTX_TOKEN_OWNED;
+    if (token->state.compare_exchange_strong(state, KMP_MTX_TOKEN_FREE))
+      continue;
+    KMP_DEBUG_ASSERT(state == KMP_MTX_TOKEN_CONTENDED);
+    __kmp_acquire_bootstrap_lock(&token->lock);
+    kmp_depnode_t *waiter = token->head;
+    KMP_DEBUG_ASSERT(waiter != NULL);
+    token->head = waiter->dn.mtx_next_waiter;
+    if (token->head == NULL) {
+      token->tail = NULL;
+      KMP_ATOMIC_ST_REL(&token->state, KMP_MTX_TOKEN_OWNED);
+    }
+    __kmp_release_bootstrap_lock(&token->lock);
+    KMP_DEBUG_ASSERT(waiter->dn.mtx_tokens[waiter->dn.mtx_num_owned] == token);
+    waiter->dn.mtx_num_owned++;
+    if (__kmp_mtx_acquire_tokens(waiter)) {
+      KA_TRACE(20, ("__kmp_mtx_release_tokens: T#%d waiter %p scheduled for "
+                    "execution.\n",
+                    gtid, waiter->dn.task));
+      __kmp_dep_task_ready(gtid, waiter->dn.task);
+    }
+  }
+  node->dn.mtx_num_owned = 0;
+}
 
-  size_t gen = current_dephash->generation + 1;
-  if (gen >= MAX_GEN)
-    return current_dephash;
-  size_t new_size = sizes[gen];
+// Initial number of slots, a power of two. The table is grown when it would
+// become more than three quarters full.
+enum { KMP_DEPHASH_OTHER_SIZE = 64, KMP_DEPHASH_MASTER_SIZE = 1024 };
+// Number of slots moved from the old table to the new one per lookup while a
+// resize is in progress
+#define KMP_DEPHASH_MIGRATE_STEP 16
 
-  size_t size_to_allocate =
-      new_size * sizeof(kmp_dephash_entry_t *) + sizeof(kmp_dephash_t);
+static inline size_t __kmp_dephash_hash(kmp_intptr_t addr, size_t hsize) {
+  // Fibonacci hashing, folded so that the high bits also reach the index
+  kmp_uint64 h = (kmp_uint64)addr * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(h ^ (h >> 32)) & (hsize - 1);
+}
 
+static kmp_dephash_slot_t *__kmp_dephash_alloc_slots(kmp_info_t *thread,
+                                                     size_t size) {
+  kmp_dephash_slot_t *slots;
 #if USE_FAST_MEMORY
-  h = (kmp_dephash_t *)__kmp_fast_allocate(thread, size_to_allocate);
+  slots = (kmp_dephash_slot_t *)__kmp_fast_allocate(
+      thread, size * sizeof(kmp_dephash_slot_t));
 #else
-  h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size_to_allocate);
+  slots = (kmp_dephash_slot_t *)__kmp_thread_malloc(
+      thread, size * sizeof(kmp_dephash_slot_t));
 #endif
+  for (size_t i = 0; i < size; i++)
+    slots[i].entry = NULL;
+  return slots;
+}
 
-  h->size = new_size;
-  h->nelements = current_dephash->nelements;
-  h->buckets = (kmp_dephash_entry **)(h + 1);
-  h->generation = gen;
-  h->nconflicts = 0;
-  h->last_all = current_dephash->last_all;
-
-  // make sure buckets are properly initialized
-  for (size_t i = 0; i < new_size; i++) {
-    h->buckets[i] = NULL;
-  }
-
-  // insert existing elements in the new table
-  for (size_t i = 0; i < current_dephash->size; i++) {
-    kmp_dephash_entry_t *next, *entry;
-    for (entry = current_dephash->buckets[i]; entry; entry = next) {
-      next = entry->next_in_bucket;
-      // Compute the new hash using the new size, and insert the entry in
-      // the new bucket.
-      size_t new_bucket = __kmp_dephash_hash(entry->addr, h->size);
-      entry->next_in_bucket = h->buckets[new_bucket];
-      if (entry->next_in_bucket) {
-        h->nconflicts++;
-      }
-      h->buckets[new_bucket] = entry;
-    }
-  }
+static inline kmp_dephash_entry_t *
+__kmp_dephash_lookup(kmp_dephash_slot_t *slots, size_t size,
+                     kmp_intptr_t addr) {
+  for (size_t i = __kmp_dephash_hash(addr, size); slots[i].entry;
+       i = (i + 1) & (size - 1))
+    if (slots[i].addr == addr)
+      return slots[i].entry;
+  return NULL;
+}
 
-  // Free old hash table
-#if USE_FAST_MEMORY
-  __kmp_fast_free(thread, current_dephash);
-#else
-  __kmp_thread_free(thread, current_dephash);
-#endif
+// The caller guarantees addr is not in the table and there is a free slot
+static inline void __kmp_dephash_insert(kmp_dephash_slot_t *slots, size_t size,
+                                        kmp_intptr_t addr,
+                                        kmp_dephash_entry_t *entry) {
+  size_t i = __kmp_dephash_hash(addr, size);
+  while (slots[i].entry)
+    i = (i + 1) & (size - 1);
+  slots[i].addr = addr;
+  slots[i].entry = entry;
+}
 
-  return h;
+// Move up to n slots of the old table into the current one, and free the old
+// table once all of its slots have been moved. Moved slots are left in place
+// so that probe sequences through them stay intact; their entries are found
+// in the current table first.
+static void __kmp_dephash_migrate(kmp_info_t *thread, kmp_dephash_t *h,
+                                  size_t n) {
+  size_t end = KMP_MIN(h->old_next + n, h->old_size);
+  for (size_t i = h->old_next; i < end; i++)
+    if (h->old_slots[i].entry)
+      __kmp_dephash_insert(h->slots, h->size, h->old_slots[i].addr,
+                           h->old_slots[i].entry);
+  h->old_next = end;
+  if (end == h->old_size) {
+    __kmp_dephash_free_slots(thread, h->old_slots);
+    h->old_slots = NULL;
+    h->old_size = h->old_next = 0;
+  }
+}
+
+// Double the table. Existing entries are moved lazily by __kmp_dephash_find.
+static void __kmp_dephash_extend(kmp_info_t *thread, kmp_dephash_t *h) {
+  if (h->old_slots) // finish the previous resize first
+    __kmp_dephash_migrate(thread, h, h->old_size);
+  KA_TRACE(40, ("__kmp_dephash_extend: T#%d resizing dephash %p to %d\n",
+                __kmp_gtid_from_thread(thread), h, (int)(2 * h->size)));
+  h->old_slots = h->slots;
+  h->old_size = h->size;
+  h->old_next = 0;
+  h->size *= 2;
+  h->slots = __kmp_dephash_alloc_slots(thread, h->size);
 }
 
 static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
@@ -133,24 +239,19 @@ static kmp_dephash_t *__kmp_dephash_create(kmp_info_t *thread,
   else
     h_size = KMP_DEPHASH_OTHER_SIZE;
 
-  size_t size = h_size * sizeof(kmp_dephash_entry_t *) + sizeof(kmp_dephash_t);
-
 #if USE_FAST_MEMORY
-  h = (kmp_dephash_t *)__kmp_fast_allocate(thread, size);
+  h = (kmp_dephash_t *)__kmp_fast_allocate(thread, sizeof(kmp_dephash_t));
 #else
-  h = (kmp_dephash_t *)__kmp_thread_malloc(thread, size);
+  h = (kmp_dephash_t *)__kmp_thread_malloc(thread, sizeof(kmp_dephash_t));
 #endif
   h->size = h_size;
-
-  h->generation = 0;
+  h->slots = __kmp_dephash_alloc_slots(thread, h_size);
+  h->old_slots = NULL;
+  h->old_size = 0;
+  h->old_next = 0;
   h->nelements = 0;
-  h->nconflicts = 0;
-  h->buckets = (kmp_dephash_entry **)(h + 1);
   h->last_all = NULL;
 
-  for (size_t i = 0; i < h_size; i++)
-    h->buckets[i] = 0;
-
   return h;
 }
 
@@ -158,18 +259,16 @@ static kmp_dephash_entry *__kmp_dephash_find(kmp_info_t *thread,
                                              kmp_dephash_t **hash,
                                              kmp_intptr_t addr) {
   kmp_dephash_t *h = *hash;
-  if (h->nelements != 0 && h->nconflicts / h->size >= 1) {
-    *hash = __kmp_dephash_extend(thread, h);
-    h = *hash;
-  }
-  size_t bucket = __kmp_dephash_hash(addr, h->size);
+  if (h->old_slots)
+    __kmp_dephash_migrate(thread, h, KMP_DEPHASH_MIGRATE_STEP);
 
-  kmp_dephash_entry_t *entry;
-  for (entry = h->buckets[bucket]; entry; entry = entry->next_in_bucket)
-    if (entry->addr == addr)
-      break;
+  kmp_dephash_entry_t *entry = __kmp_dephash_lookup(h->slots, h->size, addr);
+  if (entry == NULL && h->old_slots)
+    entry = __kmp_dephash_lookup(h->old_slots, h->old_size, addr);
 
   if (entry == NULL) {
+    if (4 * (h->nelements + 1) > 3 * h->size)
+      __kmp_dephash_extend(thread, h);
 // create entry. This is only done by one thread so no locking required
 #if USE_FAST_MEMORY
     entry = (kmp_dephash_entry_t *)__kmp_fast_allocate(
@@ -187,11 +286,8 @@ static kmp_dephash_entry *__kmp_dephash_find(kmp_info_t *thread,
     entry->prev_set = NULL;
     entry->last_flag = 0;
     entry->mtx_lock = NULL;
-    entry->next_in_bucket = h->buckets[bucket];
-    h->buckets[bucket] = entry;
+    __kmp_dephash_insert(h->slots, h->size, addr, entry);
     h->nelements++;
-    if (entry->next_in_bucket)
-      h->nconflicts++;
   }
   return entry;
 }
@@ -246,6 +342,54 @@ static inline void __kmp_track_dependence(kmp_int32 gtid, kmp_depnode_t *source,
 #endif /* OMPT_SUPPORT && OMPT_OPTIONAL */
 }
 
+static void __kmp_taskgraph_grow(void **buf, kmp_int32 *max, kmp_int32 used,
+                                 size_t elem_size) {
+  kmp_int32 new_max = *max ? 2 * *max : 64;
+  void *new_buf = __kmp_allocate(new_max * elem_size);
+  if (used)
+    KMP_MEMCPY(new_buf, *buf, used * elem_size);
+  if (*buf)
+    __kmp_free(*buf);
+  *buf = new_buf;
+  *max = new_max;
+}
+
+// Returns the task graph region of the encountering task if the dependences of
+// task are being recorded
+static inline kmp_taskgraph_region_t *
+__kmp_taskgraph_recording(kmp_info_t *thread, kmp_task_t *task) {
+  kmp_taskgraph_region_t *tgr = thread->th.th_current_task->td_taskgraph;
+  if (tgr == NULL || task == NULL || tgr->mode != tgm_record)
+    return NULL;
+  return tgr;
+}
+
+// Record pred as a predecessor of the last recorded task
+static void __kmp_taskgraph_record_pred(kmp_taskgraph_region_t *tgr,
+                                        kmp_depnode_t *pred) {
+  kmp_taskgraph_t *tg = tgr->graph;
+  kmp_taskgraph_node_t *n = &tg->nodes[tg->ntasks - 1];
+  kmp_int32 index = pred->dn.tg_index;
+  if (index < 0 || index >= tg->ntasks - 1 || tgr->nodes[index] != pred) {
+    // Predecessor created outside of the recording (before the region, or in
+    // an earlier region). A complete one orders nothing; a pending one is not
+    // part of the graph, so record it again next time.
+    if (pred->dn.task == NULL)
+      return;
+    tg->status = tgs_empty;
+    tgr->mode = tgm_plain;
+    return;
+  }
+  for (kmp_int32 i = n->first_pred; i < n->first_pred + n->npreds; ++i)
+    if (tg->preds[i] == index)
+      return;
+  if (tg->npreds == tg->max_preds)
+    __kmp_taskgraph_grow((void **)&tg->preds, &tg->max_preds, tg->npreds,
+                         sizeof(kmp_int32));
+  tg->preds[tg->npreds++] = index;
+  n->npreds++;
+}
+
 static inline kmp_int32
 __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
                              kmp_task_t *task, kmp_depnode_t *node,
@@ -253,9 +397,12 @@ __kmp_depnode_link_successor(kmp_int32 gtid, kmp_info_t *thread,
   if (!plist)
     return 0;
   kmp_int32 npredecessors = 0;
+  kmp_taskgraph_region_t *tgr = __kmp_taskgraph_recording(thread, task);
   // link node as successor of list elements
   for (kmp_depnode_list_t *p = plist; p; p = p->next) {
     kmp_depnode_t *dep = p->node;
+    if (UNLIKELY(tgr != NULL))
+      __kmp_taskgraph_record_pred(tgr, dep);
     if (dep->dn.task) {
       KMP_ACQUIRE_DEPNODE(gtid, dep);
       if (dep->dn.task) {
@@ -281,6 +428,9 @@ static inline kmp_int32 __kmp_depnode_link_successor(kmp_int32 gtid,
   if (!sink)
     return 0;
   kmp_int32 npredecessors = 0;
+  kmp_taskgraph_region_t *tgr = __kmp_taskgraph_recording(thread, task);
+  if (UNLIKELY(tgr != NULL))
+    __kmp_taskgraph_record_pred(tgr, sink);
   if (sink->dn.task) {
     // synchronously add source to sink' list of successors
     KMP_ACQUIRE_DEPNODE(gtid, sink);
@@ -321,33 +471,33 @@ __kmp_process_dep_all(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t *h,
   }
 
   // process all regular dependences
+  if (h->old_slots) // bring all entries into the current table
+    __kmp_dephash_migrate(thread, h, h->old_size);
   for (size_t i = 0; i < h->size; i++) {
-    kmp_dephash_entry_t *info = h->buckets[i];
+    kmp_dephash_entry_t *info = h->slots[i].entry;
     if (!info) // skip empty slots in dephash
       continue;
-    for (; info; info = info->next_in_bucket) {
-      // for each entry the omp_all_memory works as OUT dependence
-      kmp_depnode_t *last_out = info->last_out;
-      kmp_depnode_list_t *last_set = info->last_set;
-      kmp_depnode_list_t *prev_set = info->prev_set;
-      if (last_set) {
-        npredecessors +=
-            __kmp_depnode_link_successor(gtid, thread, task, node, last_set);
-        __kmp_depnode_list_free(thread, last_set);
-        __kmp_depnode_list_free(thread, prev_set);
-        info->last_set = NULL;
-        info->prev_set = NULL;
-        info->last_flag = 0; // no sets in this dephash entry
-      } else {
-        npredecessors +=
-            __kmp_depnode_link_successor(gtid, thread, task, node, last_out);
-      }
-      __kmp_node_deref(thread, last_out);
-      if (!dep_barrier) {
-        info->last_out = __kmp_node_ref(node);
-      } else {
-        info->last_out = NULL;
-      }
+    // for each entry the omp_all_memory works as OUT dependence
+    kmp_depnode_t *last_out = info->last_out;
+    kmp_depnode_list_t *last_set = info->last_set;
+    kmp_depnode_list_t *prev_set = info->prev_set;
+    if (last_set) {
+      npredecessors +=
+          __kmp_depnode_link_successor(gtid, thread, task, node, last_set);
+      __kmp_depnode_list_free(thread, last_set);
+      __kmp_depnode_list_free(thread, prev_set);
+      info->last_set = NULL;
+      info->prev_set = NULL;
+      info->last_flag = 0; // no sets in this dephash entry
+    } else {
+      npredecessors +=
+          __kmp_depnode_link_successor(gtid, thread, task, node, last_out);
+    }
+    __kmp_node_deref(thread, last_out);
+    if (!dep_barrier) {
+      info->last_out = __kmp_node_ref(node);
+    } else {
+      info->last_out = NULL;
     }
   }
   KA_TRACE(30, ("__kmp_process_dep_all: T#%d found %d predecessors\n", gtid,
@@ -441,7 +591,9 @@ __kmp_process_deps(kmp_int32 gtid, kmp_depnode_t *node, kmp_dephash_t **hash,
         info->last_set = __kmp_add_node(thread, info->last_set, node);
       }
       // check if we are processing MTX dependency
-      if (dep->flag == KMP_DEP_MTX) {
+      if (dep->flag == KMP_DEP_MTX && __kmp_task_mtx_tokens) {
+        __kmp_mtx_add_token(node, info);
+      } else if (dep->flag == KMP_DEP_MTX) {
         if (info->mtx_lock == NULL) {
           info->mtx_lock = (kmp_lock_t *)__kmp_allocate(sizeof(kmp_lock_t));
           __kmp_init_lock(info->mtx_lock);
@@ -566,6 +718,123 @@ static bool __kmp_check_deps(kmp_int32 gtid, kmp_depnode_t *node,
   return npredecessors > 0 ? true : false;
 }
 
+// Signature of a dependence list, used to check that a replayed task matches
+// the recorded one
+static kmp_uint64 __kmp_taskgraph_signature(kmp_int32 ndeps,
+                                            kmp_depend_info_t *dep_list,
+                                            kmp_int32 ndeps_noalias,
+                                            kmp_depend_info_t *noalias_dep_list,
+                                            bool *has_mtx) {
+  const kmp_uint64 prime = 0x100000001B3ULL; // FNV-1a
+  kmp_uint64 sig = 0xCBF29CE484222325ULL ^ (kmp_uint64)ndeps;
+  sig = (sig ^ (kmp_uint64)ndeps_noalias) * prime;
+  for (kmp_int32 i = 0; i < ndeps + ndeps_noalias; ++i) {
+    kmp_depend_info_t *dep =
+        i < ndeps ? &dep_list[i] : &noalias_dep_list[i - ndeps];
+    sig = (sig ^ (kmp_uint64)dep->base_addr) * prime;
+    sig = (sig ^ (kmp_uint64)dep->flag) * prime;
+    if (dep->flag == KMP_DEP_MTX)
+      *has_mtx = true;
+  }
+  return sig;
+}
+
+// Wait for the tasks replayed so far in the region to complete. Used when the
+// region stops matching the recorded graph: the tasks created from then on are
+// resolved through the dephash of the encountering task, which does not know
+// the replayed tasks.
+static void __kmp_taskgraph_wait_replayed(kmp_int32 gtid, kmp_info_t *thread,
+                                          kmp_taskgraph_region_t *tgr) {
+  kmp_depnode_t node = {0};
+  __kmp_init_node(&node);
+  node.dn.npredecessors = -1;
+  kmp_int32 npredecessors = 0;
+  for (kmp_int32 i = 0; i < tgr->next; ++i)
+    npredecessors += __kmp_depnode_link_successor(gtid, thread, NULL, &node,
+                                                  tgr->nodes[i]);
+  npredecessors++;
+  npredecessors =
+      node.dn.npredecessors.fetch_add(npredecessors) + npredecessors;
+  if (npredecessors > 0) {
+    int thread_finished = FALSE;
+    kmp_flag_32<false, false> flag(
+        (std::atomic<kmp_uint32> *)&node.dn.npredecessors, 0U);
+    while (node.dn.npredecessors > 0) {
+      flag.execute_tasks(thread, gtid, FALSE,
+                         &thread_finished USE_ITT_BUILD_ARG(NULL),
+                         __kmp_task_stealing_constraint);
+    }
+  }
+  tgr->graph->status = tgs_empty; // record it again next time
+  tgr->mode = tgm_plain;
+}
+
+// Process the dependences of a task created inside a task graph region.
+// Returns -1 if the dependences have to be resolved through the dephash (the
+// task is then appended to the graph when recording), otherwise whether the
+// task has outstanding predecessors in the replayed graph.
+static kmp_int32 __kmp_taskgraph_task_deps(
+    kmp_int32 gtid, kmp_info_t *thread, kmp_taskgraph_region_t *tgr,
+    kmp_depnode_t *node, kmp_task_t *task, kmp_int32 ndeps,
+    kmp_depend_info_t *dep_list, kmp_int32 ndeps_noalias,
+    kmp_depend_info_t *noalias_dep_list) {
+  if (tgr->mode == tgm_plain)
+    return -1;
+  kmp_taskgraph_t *tg = tgr->graph;
+  bool has_mtx = false;
+  kmp_uint64 sig = __kmp_taskgraph_signature(ndeps, dep_list, ndeps_noalias,
+                                             noalias_dep_list, &has_mtx);
+
+  if (tgr->mode == tgm_record) {
+    if (has_mtx) {
+      // mutexinoutset locks live in the dephash entries
+      tg->status = tgs_disabled;
+      tgr->mode = tgm_plain;
+      return -1;
+    }
+    if (tg->ntasks == tg->max_tasks)
+      __kmp_taskgraph_grow((void **)&tg->nodes, &tg->max_tasks, tg->ntasks,
+                           sizeof(kmp_taskgraph_node_t));
+    kmp_taskgraph_node_t *n = &tg->nodes[tg->ntasks];
+    n->sig = sig;
+    n->first_pred = tg->npreds;
+    n->npreds = 0;
+    node->dn.tg_index = tg->ntasks++;
+    if (tgr->next == tgr->max_nodes)
+      __kmp_taskgraph_grow((void **)&tgr->nodes, &tgr->max_nodes, tgr->next,
+                           sizeof(kmp_depnode_t *));
+    tgr->nodes[tgr->next++] = __kmp_node_ref(node);
+    return -1;
+  }
+
+  KMP_DEBUG_ASSERT(tgr->mode == tgm_replay);
+  kmp_int32 index = tgr->next;
+  if (index >= tg->ntasks || tg->nodes[index].sig != sig) {
+    KA_TRACE(20, ("__kmp_taskgraph_task_deps: T#%d task %d does not match "
+                  "task graph %d\n",
+                  gtid, index, tg->id));
+    __kmp_taskgraph_wait_replayed(gtid, thread, tgr);
+    return -1;
+  }
+
+  // same protocol as __kmp_check_deps
+  node->dn.npredecessors = -1;
+  kmp_int32 npredecessors = 0;
+  kmp_taskgraph_node_t *n = &tg->nodes[index];
+  for (kmp_int32 i = n->first_pred; i < n->first_pred + n->npreds; ++i)
+    npredecessors += __kmp_depnode_link_successor(gtid, thread, task, node,
+                                                  tgr->nodes[tg->preds[i]]);
+  tgr->nodes[index] = __kmp_node_ref(node);
+  tgr->next++;
+
+  node->dn.task = task;
+  KMP_MB();
+  npredecessors++;
+  npredecessors =
+      node->dn.npredecessors.fetch_add(npredecessors) + npredecessors;
+  return npredecessors > 0 ? 1 : 0;
+}
+
 /*!
 @ingroup TASKING
 @param loc_ref location of the original task directive
@@ -669,10 +938,6 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
                            task_team->tt.tt_hidden_helper_task_encountered));
 
   if (!serial && (ndeps > 0 || ndeps_noalias > 0)) {
-    /* if no dependences have been tracked yet, create the dependence hash */
-    if (current_task->td_dephash == NULL)
-      current_task->td_dephash = __kmp_dephash_create(thread, current_task);
-
 #if USE_FAST_MEMORY
     kmp_depnode_t *node =
         (kmp_depnode_t *)__kmp_fast_allocate(thread, sizeof(kmp_depnode_t));
@@ -684,9 +949,23 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
     __kmp_init_node(node);
     new_taskdata->td_depnode = node;
 
-    if (__kmp_check_deps(gtid, node, new_task, &current_task->td_dephash,
-                         NO_DEP_BARRIER, ndeps, dep_list, ndeps_noalias,
-                         noalias_dep_list)) {
+    // a replayed task graph links the task without the dephash
+    kmp_int32 blocked = -1;
+    if (UNLIKELY(current_task->td_taskgraph != NULL))
+      blocked = __kmp_taskgraph_task_deps(
+          gtid, thread, current_task->td_taskgraph, node, new_task, ndeps,
+          dep_list, ndeps_noalias, noalias_dep_list);
+    if (blocked < 0) {
+      /* if no dependences have been tracked yet, create the dependence hash */
+      if (current_task->td_dephash == NULL)
+        current_task->td_dephash = __kmp_dephash_create(thread, current_task);
+      blocked = __kmp_check_deps(gtid, node, new_task,
+                                 &current_task->td_dephash, NO_DEP_BARRIER,
+                                 ndeps, dep_list, ndeps_noalias,
+                                 noalias_dep_list);
+    }
+
+    if (blocked) {
       KA_TRACE(10, ("__kmpc_omp_task_with_deps(exit): T#%d task had blocking "
                     "dependences: "
                     "loc=%p task=%p, return: TASK_CURRENT_NOT_QUEUED\n",
@@ -695,6 +974,18 @@ kmp_int32 __kmpc_omp_task_with_deps(ident_t *loc_ref, kmp_int32 gtid,
       if (ompt_enabled.enabled) {
         current_task->ompt_task_info.frame.enter_frame = ompt_data_none;
       }
+#endif
+      return TASK_CURRENT_NOT_QUEUED;
+    }
+    if (node->dn.mtx_num_tokens > 0 && !__kmp_mtx_acquire_tokens(node)) {
+      KA_TRACE(10, ("__kmpc_omp_task_with_deps(exit): T#%d task waits for a "
+                    "mutexinoutset set: loc=%p task=%p, return: "
+                    "TASK_CURRENT_NOT_QUEUED\n",
+                    gtid, loc_ref, new_taskdata));
+#if OMPT_SUPPORT
+      if (ompt_enabled.enabled) {
+        current_task->ompt_task_info.frame.enter_frame = ompt_data_none;
+      }
 #endif
       return TASK_CURRENT_NOT_QUEUED;
     }
@@ -770,6 +1061,17 @@ void __kmpc_omp_taskwait_deps_51(ident_t *loc_ref, kmp_int32 gtid,
   kmp_info_t *thread = __kmp_threads[gtid];
   kmp_taskdata_t *current_task = thread->th.th_current_task;
 
+  kmp_taskgraph_region_t *tgr = current_task->td_taskgraph;
+  if (UNLIKELY(tgr != NULL)) {
+    // The dependences of a taskwait are not part of the recorded graph
+    if (tgr->mode == tgm_record) {
+      tgr->graph->status = tgs_disabled;
+      tgr->mode = tgm_plain;
+    } else if (tgr->mode == tgm_replay) {
+      __kmp_taskgraph_wait_replayed(gtid, thread, tgr);
+    }
+  }
+
 #if OMPT_SUPPORT
   // this function represents a taskwait construct with depend clause
   // We signal 4 events:
@@ -893,3 +1195,125 @@ void __kmpc_omp_taskwait_deps_51(ident_t *loc_ref, kmp_int32 gtid,
                 \n",
                 gtid, loc_ref));
 }
+
+// Task graph record and replay
+
+static kmp_taskgraph_t *__kmp_taskgraphs = NULL;
+static kmp_bootstrap_lock_t __kmp_taskgraph_lock =
+    KMP_BOOTSTRAP_LOCK_INITIALIZER(__kmp_taskgraph_lock);
+
+// __kmp_taskgraph_begin: start a task graph region in the current task
+//
+// The tasks with dependences created until the matching __kmp_taskgraph_end
+// share the dephash of the encountering task, so they are ordered after the
+// sibling tasks created before the region, and the region completes like a
+// taskgroup. The first execution of a graph_id records the resolved
+// dependence edges among the tasks of the region, later executions replay
+// them. If a replayed region stops matching the recording, the runtime waits
+// for the tasks replayed so far, resolves the remaining dependences as usual,
+// and records the graph again next time. A recording that finds a pending
+// sibling created before the region is discarded the same way, and a region
+// entered while such siblings may be pending is not replayed.
+//
+// Returns 1 if the region replays a recorded graph, 0 otherwise.
+int __kmp_taskgraph_begin(int gtid, int graph_id) {
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+  kmp_taskgraph_region_t *tgr =
+      (kmp_taskgraph_region_t *)__kmp_allocate(sizeof(kmp_taskgraph_region_t));
+  kmp_taskgraph_t *tg;
+
+  __kmp_acquire_bootstrap_lock(&__kmp_taskgraph_lock);
+  for (tg = __kmp_taskgraphs; tg; tg = tg->next)
+    if (tg->id == graph_id)
+      break;
+  if (tg == NULL) {
+    tg = (kmp_taskgraph_t *)__kmp_allocate(sizeof(kmp_taskgraph_t));
+    tg->id = graph_id;
+    tg->status = tgs_empty;
+    tg->next = __kmp_taskgraphs;
+    __kmp_taskgraphs = tg;
+  }
+  if (!tg->busy) { // otherwise the region runs without the graph
+    tg->busy = 1;
+    tgr->graph = tg;
+  }
+  __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+
+  tgr->mode = tgm_plain;
+  if (tgr->graph != NULL) {
+    // Replayed tasks skip the dephash and would miss their predecessors among
+    // the sibling tasks created before the region
+    bool pending_deps =
+        current_task->td_dephash != NULL &&
+        KMP_ATOMIC_LD_ACQ(&current_task->td_incomplete_child_tasks) > 0;
+    if (tg->status == tgs_ready && !pending_deps) {
+      tgr->mode = tgm_replay;
+      if (tg->ntasks > 0)
+        tgr->nodes = (kmp_depnode_t **)__kmp_allocate(tg->ntasks *
+                                                      sizeof(kmp_depnode_t *));
+    } else if (tg->status == tgs_empty) {
+      tgr->mode = tgm_record;
+      tg->ntasks = 0;
+      tg->npreds = 0;
+    }
+  }
+  KA_TRACE(10, ("__kmp_taskgraph_begin: T#%d graph %d mode %d\n", gtid,
+                graph_id, tgr->mode));
+
+  __kmpc_taskgroup(NULL, gtid);
+  tgr->outer = current_task->td_taskgraph;
+  current_task->td_taskgraph = tgr;
+  return tgr->mode == tgm_replay;
+}
+
+// __kmp_taskgraph_end: wait for the tasks of the innermost task graph region of
+// the current task and finish the region
+void __kmp_taskgraph_end(int gtid) {
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_taskdata_t *current_task = thread->th.th_current_task;
+  kmp_taskgraph_region_t *tgr = current_task->td_taskgraph;
+
+  if (tgr == NULL) {
+    KA_TRACE(10, ("__kmp_taskgraph_end: T#%d no task graph region\n", gtid));
+    return;
+  }
+  __kmpc_end_taskgroup(NULL, gtid);
+
+  kmp_taskgraph_t *tg = tgr->graph;
+  if (tg != NULL) {
+    if (tgr->mode == tgm_record)
+      tg->status = tgs_ready;
+    else if (tgr->mode == tgm_replay && tgr->next != tg->ntasks)
+      tg->status = tgs_empty; // fewer tasks than recorded, record again
+    if (tgr->nodes) {
+      for (kmp_int32 i = 0; i < tgr->next; ++i)
+        __kmp_node_deref(thread, tgr->nodes[i]);
+      __kmp_free(tgr->nodes);
+    }
+    KA_TRACE(10, ("__kmp_taskgraph_end: T#%d graph %d status %d tasks %d "
+                  "edges %d\n",
+                  gtid, tg->id, tg->status, tg->ntasks, tg->npreds));
+    __kmp_acquire_bootstrap_lock(&__kmp_taskgraph_lock);
+    tg->busy = 0;
+    __kmp_release_bootstrap_lock(&__kmp_taskgraph_lock);
+  }
+
+  current_task->td_taskgraph = tgr->outer;
+  __kmp_free(tgr);
+}
+
+// Free all recorded task graphs at library shutdown
+void __kmp_taskgraph_cleanup(void) {
+  kmp_taskgraph_t *tg = __kmp_taskgraphs;
+  while (tg) {
+    kmp_taskgraph_t *next = tg->next;
+    if (tg->nodes)
+      __kmp_free(tg->nodes);
+    if (tg->preds)
+      __kmp_free(tg->preds);
+    __kmp_free(tg);
+    tg = next;
+  }
+  __kmp_taskgraphs = NULL;
+}
@@ -53,35 +53,58 @@ static inline void __kmp_depnode_list_free(kmp_info_t *thread,
   }
 }
 
-static inline void __kmp_dephash_free_entries(kmp_info_t *thread,
-                                              kmp_dephash_t *h) {
-  for (size_t i = 0; i < h->size; i++) {
-    if (h->buckets[i]) {
-      kmp_dephash_entry_t *next;
-      for (kmp_dephash_entry_t *entry = h->buckets[i]; entry; entry = next) {
-        next = entry->next_in_bucket;
-        __kmp_depnode_list_free(thread, entry->last_set);
-        __kmp_depnode_list_free(thread, entry->prev_set);
-        __kmp_node_deref(thread, entry->last_out);
-        if (entry->mtx_lock) {
-          __kmp_destroy_lock(entry->mtx_lock);
-          __kmp_free(entry->mtx_lock);
-        }
+static inline void __kmp_dephash_free_entry(kmp_info_t *thread,
+                                            kmp_dephash_entry_t *entry) {
+  __kmp_depnode_list_free(thread, entry->last_set);
+  __kmp_depnode_list_free(thread, entry->prev_set);
+  __kmp_node_deref(thread, entry->last_out);
+  if (entry->mtx_token && __kmp_task_mtx_tokens) {
+    __kmp_free(entry->mtx_token);
+  } else if (entry->mtx_lock) {
+    __kmp_destroy_lock(entry->mtx_lock);
+    __kmp_free(entry->mtx_lock);
+  }
 #if USE_FAST_MEMORY
-        __kmp_fast_free(thread, entry);
+  __kmp_fast_free(thread, entry);
 #else
-        __kmp_thread_free(thread, entry);
+  __kmp_thread_free(thread, entry);
 #endif
-      }
-      h->buckets[i] = 0;
+}
+
+static inline void __kmp_dephash_free_slots(kmp_info_t *thread,
+                                            kmp_dephash_slot_t *slots) {
+#if USE_FAST_MEMORY
+  __kmp_fast_free(thread, slots);
+#else
+  __kmp_thread_free(thread, slots);
+#endif
+}
+
+static inline void __kmp_dephash_free_entries(kmp_info_t *thread,
+                                              kmp_dephash_t *h) {
+  for (size_t i = 0; i < h->size; i++) {
+    if (h->slots[i].entry) {
+      __kmp_dephash_free_entry(thread, h->slots[i].entry);
+      h->slots[i].entry = NULL;
     }
   }
+  if (h->old_slots) {
+    // entries below old_next have been moved and were freed above
+    for (size_t i = h->old_next; i < h->old_size; i++)
+      if (h->old_slots[i].entry)
+        __kmp_dephash_free_entry(thread, h->old_slots[i].entry);
+    __kmp_dephash_free_slots(thread, h->old_slots);
+    h->old_slots = NULL;
+    h->old_size = h->old_next = 0;
+  }
+  h->nelements = 0;
   __kmp_node_deref(thread, h->last_all);
   h->last_all = NULL;
 }
 
 static inline void __kmp_dephash_free(kmp_info_t *thread, kmp_dephash_t *h) {
   __kmp_dephash_free_entries(thread, h);
+  __kmp_dephash_free_slots(thread, h->slots);
 #if USE_FAST_MEMORY
   __kmp_fast_free(thread, h);
 #else
@@ -90,11 +113,38 @@ static inline void __kmp_dephash_free(kmp_info_t *thread, kmp_dephash_t *h) {
 }
 
 extern void __kmpc_give_task(kmp_task_t *ptask, kmp_int32 start);
+extern bool __kmp_mtx_acquire_tokens(kmp_depnode_t *node);
+extern void __kmp_mtx_release_tokens(kmp_int32 gtid, kmp_depnode_t *node);
+
+// Schedule a task whose dependences have been satisfied
+static inline void __kmp_dep_task_ready(kmp_int32 gtid, kmp_task_t *ptask) {
+  // If a regular task depending on a hidden helper task, when the
+  // hidden helper task is done, the regular task should be executed by
+  // its encountering team.
+  if (KMP_HIDDEN_HELPER_THREAD(gtid)) {
+    kmp_taskdata_t *taskdata = KMP_TASK_TO_TASKDATA(ptask);
+    // If the dependent task is a regular task, we need to push to its
+    // encountering thread's queue; otherwise, it can be pushed to its own
+    // queue.
+    if (!taskdata->td_flags.hidden_helper) {
+      kmp_int32 encountering_gtid =
+          taskdata->td_alloc_thread->th.th_info.ds.ds_gtid;
+      kmp_int32 encountering_tid = __kmp_tid_from_gtid(encountering_gtid);
+      __kmpc_give_task(ptask, encountering_tid);
+      return;
+    }
+  }
+  __kmp_omp_task(gtid, ptask, false);
+}
 
 static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
   kmp_info_t *thread = __kmp_threads[gtid];
   kmp_depnode_t *node = task->td_depnode;
 
+  // Hand over the tokens of mutexinoutset sets
+  if (UNLIKELY(node && node->dn.mtx_num_owned > 0))
+    __kmp_mtx_release_tokens(gtid, node);
+
   // Check mutexinoutset dependencies, release locks
   if (UNLIKELY(node && (node->dn.mtx_num_locks < 0))) {
     // negative num_locks means all locks were acquired
@@ -125,7 +175,6 @@ static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
   KMP_RELEASE_DEPNODE(gtid, node);
 
   kmp_depnode_list_t *next;
-  kmp_taskdata_t *next_taskdata;
   for (kmp_depnode_list_t *p = node->dn.successors; p; p = next) {
     kmp_depnode_t *successor = p->node;
 #if USE_ITT_BUILD && USE_ITT_NOTIFY
@@ -144,27 +193,13 @@ static inline void __kmp_release_deps(kmp_int32 gtid, kmp_taskdata_t *task) {
         KA_TRACE(20, ("__kmp_release_deps: T#%d successor %p of %p scheduled "
                       "for execution.\n",
                       gtid, successor->dn.task, task));
-        // If a regular task depending on a hidden helper task, when the
-        // hidden helper task is done, the regular task should be executed by
-        // its encountering team.
-        if (KMP_HIDDEN_HELPER_THREAD(gtid)) {
-          // Hidden helper thread can only execute hidden helper tasks
-          KMP_ASSERT(task->td_flags.hidden_helper);
-          next_taskdata = KMP_TASK_TO_TASKDATA(successor->dn.task);
-          // If the dependent task is a regular task, we need to push to its
-          // encountering thread's queue; otherwise, it can be pushed to its own
-          // queue.
-          if (!next_taskdata->td_flags.hidden_helper) {
-            kmp_int32 encountering_gtid =
-                next_taskdata->td_alloc_thread->th.th_info.ds.ds_gtid;
-            kmp_int32 encountering_tid = __kmp_tid_from_gtid(encountering_gtid);
-            __kmpc_give_task(successor->dn.task, encountering_tid);
-          } else {
-            __kmp_omp_task(gtid, successor->dn.task, false);
-          }
-        } else {
-          __kmp_omp_task(gtid, successor->dn.task, false);
-        }
+        // Hidden helper thread can only execute hidden helper tasks
+        KMP_ASSERT(!KMP_HIDDEN_HELPER_THREAD(gtid) ||
+                   task->td_flags.hidden_helper);
+        // a task waiting for a mutexinoutset token is scheduled by its owner
+        if (successor->dn.mtx_num_tokens == 0 ||
+            __kmp_mtx_acquire_tokens(successor))
+          __kmp_dep_task_ready(gtid, successor->dn.task);
       }
     }
 
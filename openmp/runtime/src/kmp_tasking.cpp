@@ -34,6 +34,10 @@ static void __kmp_alloc_task_deque(kmp_info_t *thread,
 static int __kmp_realloc_task_threads_data(kmp_info_t *thread,
                                            kmp_task_team_t *task_team);
 static void __kmp_bottom_half_finish_proxy(kmp_int32 gtid, kmp_task_t *ptask);
+static bool __kmp_give_task(kmp_info_t *thread, kmp_int32 tid, kmp_task_t *task,
+                            kmp_int32 pass);
+static kmp_uint64 __kmp_taskloop_chunk_iters(kmp_task_t *task,
+                                             const kmp_taskloop_stats_t *stats);
 
 #ifdef BUILD_TIED_TASK_STACK
 
@@ -250,12 +254,12 @@ static void __kmp_pop_task_stack(kmp_int32 gtid, kmp_info_t *thread,
 }
 #endif /* BUILD_TIED_TASK_STACK */
 
-// returns 1 if new task is allowed to execute, 0 otherwise
-// checks Task Scheduling constraint (if requested) and
-// mutexinoutset dependencies if any
-static bool __kmp_task_is_allowed(int gtid, const kmp_int32 is_constrained,
-                                  const kmp_taskdata_t *tasknew,
-                                  const kmp_taskdata_t *taskcurr) {
+// returns true if new task obeys the Task Scheduling constraint (if
+// requested), false otherwise. Unlike __kmp_task_is_allowed, this has no side
+// effects, so it can be used for tasks that are not about to be executed.
+static bool __kmp_task_is_tsc_allowed(const kmp_int32 is_constrained,
+                                      const kmp_taskdata_t *tasknew,
+                                      const kmp_taskdata_t *taskcurr) {
   if (is_constrained && (tasknew->td_flags.tiedness == TASK_TIED)) {
     // Check if the candidate obeys the Task Scheduling Constraints (TSC)
     // only descendant of all deferred tied tasks can be scheduled, checking
@@ -276,6 +280,17 @@ static bool __kmp_task_is_allowed(int gtid, const kmp_int32 is_constrained,
         return false;
     }
   }
+  return true;
+}
+
+// returns 1 if new task is allowed to execute, 0 otherwise
+// checks Task Scheduling constraint (if requested) and
+// mutexinoutset dependencies if any
+static bool __kmp_task_is_allowed(int gtid, const kmp_int32 is_constrained,
+                                  const kmp_taskdata_t *tasknew,
+                                  const kmp_taskdata_t *taskcurr) {
+  if (!__kmp_task_is_tsc_allowed(is_constrained, tasknew, taskcurr))
+    return false;
   // Check mutexinoutset dependencies, acquire locks
   kmp_depnode_t *node = tasknew->td_depnode;
   if (UNLIKELY(node && (node->dn.mtx_num_locks > 0))) {
@@ -324,6 +339,143 @@ static void __kmp_realloc_task_deque(kmp_info_t *thread,
   thread_data->td.td_deque_size = new_size;
 }
 
+// Lock-free task deque (Chase-Lev, with the memory orderings of Le et al.).
+// The owner pushes and pops at td_cl_bottom using plain loads and stores and a
+// single fence on pop; only a pop of the last remaining task races with
+// thieves, who take tasks from td_cl_top with a CAS.
+
+static kmp_task_deque_array_t *__kmp_alloc_cl_deque_array(kmp_int64 size) {
+  kmp_task_deque_array_t *array = (kmp_task_deque_array_t *)__kmp_allocate(
+      sizeof(kmp_task_deque_array_t) +
+      size * sizeof(std::atomic<kmp_taskdata_t *>));
+  array->size = size;
+  array->prev = NULL;
+  array->tasks = (std::atomic<kmp_taskdata_t *> *)(array + 1);
+  return array;
+}
+
+// __kmp_realloc_cl_deque:
+// Doubles the lock-free deque of the owner thread, copying the tasks in
+// [top, bottom). The old array is retired rather than freed because thieves
+// may still read from it. Must be called by the owner only.
+static kmp_task_deque_array_t *
+__kmp_realloc_cl_deque(kmp_info_t *thread, kmp_thread_data_t *thread_data,
+                       kmp_int64 top, kmp_int64 bottom) {
+  kmp_task_deque_array_t *old_array =
+      KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+  kmp_int64 new_size = 2 * old_array->size;
+
+  KE_TRACE(10, ("__kmp_realloc_cl_deque: T#%d reallocating deque[from %d to "
+                "%d] for thread_data %p\n",
+                __kmp_gtid_from_thread(thread), (int)old_array->size,
+                (int)new_size, thread_data));
+
+  kmp_task_deque_array_t *new_array = __kmp_alloc_cl_deque_array(new_size);
+  for (kmp_int64 i = top; i < bottom; ++i) {
+    kmp_taskdata_t *taskdata =
+        KMP_ATOMIC_LD_RLX(&old_array->tasks[i & (old_array->size - 1)]);
+    KMP_ATOMIC_ST_RLX(&new_array->tasks[i & (new_size - 1)], taskdata);
+  }
+  new_array->prev = old_array;
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_cl_array, new_array);
+  return new_array;
+}
+
+// __kmp_cl_deque_ntasks: approximate number of tasks in the lock-free deque
+static inline kmp_int32 __kmp_cl_deque_ntasks(kmp_thread_data_t *thread_data) {
+  kmp_int64 ntasks = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_bottom) -
+                     KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_top);
+  return ntasks > 0 ? (kmp_int32)ntasks : 0;
+}
+
+// __kmp_thread_data_ntasks: number of tasks queued on a thread, in both the
+// locked deque and (if used) the lock-free deque
+static inline kmp_int32
+__kmp_thread_data_ntasks(kmp_thread_data_t *thread_data) {
+  kmp_int32 ntasks = TCR_4(thread_data->td.td_deque_ntasks);
+  if (__kmp_task_deque_lockfree)
+    ntasks += __kmp_cl_deque_ntasks(thread_data);
+  return ntasks;
+}
+
+// __kmp_cl_deque_push: owner pushes a task at the bottom of its lock-free
+// deque. Returns false without pushing if the deque is full and grow is false.
+static bool __kmp_cl_deque_push(kmp_info_t *thread,
+                                kmp_thread_data_t *thread_data,
+                                kmp_taskdata_t *taskdata, bool grow) {
+  kmp_int64 bottom = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_bottom);
+  kmp_int64 top = KMP_ATOMIC_LD_ACQ(&thread_data->td.td_cl_top);
+  kmp_task_deque_array_t *array =
+      KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+  if (bottom - top >= array->size) {
+    if (!grow)
+      return false;
+    array = __kmp_realloc_cl_deque(thread, thread_data, top, bottom);
+  }
+  KMP_ATOMIC_ST_RLX(&array->tasks[bottom & (array->size - 1)], taskdata);
+  std::atomic_thread_fence(std::memory_order_release);
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom + 1);
+  return true;
+}
+
+// __kmp_cl_deque_take: owner pops the most recently pushed task from its
+// lock-free deque, or returns NULL if the deque is empty.
+static kmp_taskdata_t *__kmp_cl_deque_take(kmp_thread_data_t *thread_data) {
+  kmp_task_deque_array_t *array =
+      KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+  kmp_int64 bottom = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_bottom) - 1;
+  // top only grows, so a stale value can only overestimate the task count
+  if (array == NULL || bottom < KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_top))
+    return NULL;
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom);
+  KMP_MB();
+  kmp_int64 top = KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_top);
+  kmp_taskdata_t *taskdata = NULL;
+  if (top <= bottom) {
+    taskdata = KMP_ATOMIC_LD_RLX(&array->tasks[bottom & (array->size - 1)]);
+    if (top == bottom) {
+      // Last task in the deque, race with thieves for it
+      if (!thread_data->td.td_cl_top.compare_exchange_strong(
+              top, top + 1, std::memory_order_seq_cst,
+              std::memory_order_relaxed))
+        taskdata = NULL;
+      KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom + 1);
+    }
+  } else {
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, bottom + 1);
+  }
+  return taskdata;
+}
+
+// __kmp_cl_deque_steal: thief removes the oldest task from the victim's
+// lock-free deque. Retries while it loses races with other thieves or the
+// owner and tasks remain, returns NULL once the deque is seen empty.
+// If *thread_finished is set, the thief is un-marked as a finished thread
+// before it can take a task out of the deque, see __kmp_steal_task.
+static kmp_taskdata_t *
+__kmp_cl_deque_steal(kmp_thread_data_t *victim_td,
+                     std::atomic<kmp_int32> *unfinished_threads,
+                     int *thread_finished) {
+  while (1) {
+    kmp_int64 top = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_cl_top);
+    KMP_MB();
+    kmp_int64 bottom = KMP_ATOMIC_LD_ACQ(&victim_td->td.td_cl_bottom);
+    if (top >= bottom)
+      return NULL;
+    if (*thread_finished) {
+      KMP_ATOMIC_INC(unfinished_threads);
+      *thread_finished = FALSE;
+    }
+    kmp_task_deque_array_t *array =
+        KMP_ATOMIC_LD_ACQ(&victim_td->td.td_cl_array);
+    kmp_taskdata_t *taskdata =
+        KMP_ATOMIC_LD_RLX(&array->tasks[top & (array->size - 1)]);
+    if (victim_td->td.td_cl_top.compare_exchange_strong(
+            top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return taskdata;
+  }
+}
+
 static kmp_task_pri_t *__kmp_alloc_task_pri_list() {
   kmp_task_pri_t *l = (kmp_task_pri_t *)__kmp_allocate(sizeof(kmp_task_pri_t));
   kmp_thread_data_t *thread_data = &l->td;
@@ -387,12 +539,110 @@ __kmp_get_priority_deque_data(kmp_task_team_t *task_team, kmp_int32 pri) {
   return thread_data;
 }
 
+// Returns true if heap entry a should be executed before heap entry b: higher
+// priority first, then in push order.
+static inline bool __kmp_pri_entry_before(const kmp_task_pri_entry_t *a,
+                                          const kmp_task_pri_entry_t *b) {
+  return a->priority > b->priority ||
+         (a->priority == b->priority && (kmp_int32)(a->seq - b->seq) < 0);
+}
+
+static void __kmp_pri_heap_sift_up(kmp_task_pri_entry_t *heap, kmp_int32 i) {
+  kmp_task_pri_entry_t entry = heap[i];
+  while (i > 0) {
+    kmp_int32 parent = (i - 1) / 2;
+    if (!__kmp_pri_entry_before(&entry, &heap[parent]))
+      break;
+    heap[i] = heap[parent];
+    i = parent;
+  }
+  heap[i] = entry;
+}
+
+static void __kmp_pri_heap_sift_down(kmp_task_pri_entry_t *heap, kmp_int32 n,
+                                     kmp_int32 i) {
+  kmp_task_pri_entry_t entry = heap[i];
+  for (;;) {
+    kmp_int32 child = 2 * i + 1;
+    if (child >= n)
+      break;
+    if (child + 1 < n && __kmp_pri_entry_before(&heap[child + 1], &heap[child]))
+      child++;
+    if (!__kmp_pri_entry_before(&heap[child], &entry))
+      break;
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = entry;
+}
+
+// __kmp_push_priority_task_mq: Add a task to the priority heap of the
+// encountering thread (KMP_TASK_PRIORITY_MQ)
+static kmp_int32 __kmp_push_priority_task_mq(kmp_int32 gtid, kmp_info_t *thread,
+                                             kmp_taskdata_t *taskdata,
+                                             kmp_task_team_t *task_team,
+                                             kmp_int32 pri) {
+  kmp_int32 tid = __kmp_tid_from_gtid(gtid);
+  kmp_thread_data_t *thread_data = &task_team->tt.tt_threads_data[tid];
+  KA_TRACE(20, ("__kmp_push_priority_task_mq: T#%d trying to push task %p, "
+                "pri %d.\n",
+                gtid, taskdata, pri));
+
+  // No lock needed since only owner can allocate
+  if (UNLIKELY(thread_data->td.td_deque == NULL)) {
+    __kmp_alloc_task_deque(thread, thread_data);
+  }
+
+  __kmp_acquire_bootstrap_lock(&thread_data->td.td_pri_lock);
+  kmp_int32 ntasks = thread_data->td.td_pri_ntasks;
+  if (ntasks >= thread_data->td.td_pri_heap_size) {
+    if (ntasks > 0 && __kmp_enable_task_throttling &&
+        __kmp_task_is_allowed(gtid, __kmp_task_stealing_constraint, taskdata,
+                              thread->th.th_current_task)) {
+      __kmp_release_bootstrap_lock(&thread_data->td.td_pri_lock);
+      KA_TRACE(20, ("__kmp_push_priority_task_mq: T#%d heap is full; "
+                    "returning TASK_NOT_PUSHED for task %p\n",
+                    gtid, taskdata));
+      return TASK_NOT_PUSHED;
+    }
+    // Allocate the heap, or expand it to push the task which is not allowed
+    // to execute
+    kmp_int32 size = ntasks > 0 ? 2 * ntasks : INITIAL_TASK_DEQUE_SIZE;
+    kmp_task_pri_entry_t *heap = (kmp_task_pri_entry_t *)__kmp_allocate(
+        size * sizeof(kmp_task_pri_entry_t));
+    if (thread_data->td.td_pri_heap != NULL) {
+      KMP_MEMCPY(heap, thread_data->td.td_pri_heap,
+                 ntasks * sizeof(kmp_task_pri_entry_t));
+      __kmp_free(thread_data->td.td_pri_heap);
+    }
+    thread_data->td.td_pri_heap = heap;
+    thread_data->td.td_pri_heap_size = size;
+  }
+  kmp_task_pri_entry_t *heap = thread_data->td.td_pri_heap;
+  heap[ntasks].task = taskdata;
+  heap[ntasks].priority = pri;
+  heap[ntasks].seq = thread_data->td.td_pri_seq++;
+  __kmp_pri_heap_sift_up(heap, ntasks);
+  thread_data->td.td_pri_ntasks = ntasks + 1;
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_pri_top, heap[0].priority);
+  KMP_FSYNC_RELEASING(thread->th.th_current_task); // releasing self
+  KMP_FSYNC_RELEASING(taskdata); // releasing child
+  KA_TRACE(20, ("__kmp_push_priority_task_mq: T#%d returning "
+                "TASK_SUCCESSFULLY_PUSHED: task=%p ntasks=%d top=%d\n",
+                gtid, taskdata, ntasks + 1, heap[0].priority));
+  __kmp_release_bootstrap_lock(&thread_data->td.td_pri_lock);
+  task_team->tt.tt_num_task_pri++; // atomic inc
+  return TASK_SUCCESSFULLY_PUSHED;
+}
+
 //  __kmp_push_priority_task: Add a task to the team's priority task deque
 static kmp_int32 __kmp_push_priority_task(kmp_int32 gtid, kmp_info_t *thread,
                                           kmp_taskdata_t *taskdata,
                                           kmp_task_team_t *task_team,
                                           kmp_int32 pri) {
   kmp_thread_data_t *thread_data = NULL;
+  if (__kmp_task_priority_mq)
+    return __kmp_push_priority_task_mq(gtid, thread, taskdata, task_team, pri);
   KA_TRACE(20,
            ("__kmp_push_priority_task: T#%d trying to push task %p, pri %d.\n",
             gtid, taskdata, pri));
@@ -462,6 +712,26 @@ static kmp_int32 __kmp_push_priority_task(kmp_int32 gtid, kmp_info_t *thread,
   return TASK_SUCCESSFULLY_PUSHED;
 }
 
+// __kmp_get_affinity_target: select the thread of the task team to queue a
+// task whose affinity data lives on the given NUMA node. The calling thread is
+// preferred, then a random thread on that node; returns tid if none is.
+// Threads whose node is not known yet (-1, set at creation) never match.
+static kmp_int32 __kmp_get_affinity_target(kmp_info_t *thread,
+                                           kmp_task_team_t *task_team,
+                                           kmp_int32 tid, kmp_int32 node) {
+  kmp_thread_data_t *threads_data = task_team->tt.tt_threads_data;
+  kmp_int32 nthreads = task_team->tt.tt_nproc;
+  if (thread->th.th_numa_node == node)
+    return tid;
+  kmp_int32 start = __kmp_get_random(thread) % nthreads;
+  for (kmp_int32 i = 0; i < nthreads; ++i) {
+    kmp_int32 k = (start + i) % nthreads;
+    if (threads_data[k].td.td_thr->th.th_numa_node == node)
+      return k;
+  }
+  return tid;
+}
+
 //  __kmp_push_task: Add a task to the thread's deque
 static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
   kmp_info_t *thread = __kmp_threads[gtid];
@@ -520,6 +790,19 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
     return __kmp_push_priority_task(gtid, thread, taskdata, task_team, pri);
   }
 
+  if (UNLIKELY(taskdata->td_numa_node >= 0) && task_team->tt.tt_nproc > 1) {
+    // Queue the task on a thread near its affinity data if there is room,
+    // otherwise fall back to the encountering thread
+    kmp_int32 target = __kmp_get_affinity_target(thread, task_team, tid,
+                                                 taskdata->td_numa_node);
+    if (target != tid && __kmp_give_task(thread, target, task, 1)) {
+      KA_TRACE(20, ("__kmp_push_task: T#%d gave task %p to T#%d on NUMA node "
+                    "%d\n",
+                    gtid, taskdata, target, taskdata->td_numa_node));
+      return TASK_SUCCESSFULLY_PUSHED;
+    }
+  }
+
   // Find tasking deque specific to encountering thread
   thread_data = &task_team->tt.tt_threads_data[tid];
 
@@ -530,6 +813,28 @@ static kmp_int32 __kmp_push_task(kmp_int32 gtid, kmp_task_t *task) {
     __kmp_alloc_task_deque(thread, thread_data);
   }
 
+  if (__kmp_task_deque_lockfree) {
+    // Only the owner pushes to its lock-free deque, no lock needed
+    if (!__kmp_cl_deque_push(thread, thread_data, taskdata, false)) {
+      if (__kmp_enable_task_throttling &&
+          __kmp_task_is_allowed(gtid, __kmp_task_stealing_constraint, taskdata,
+                                thread->th.th_current_task)) {
+        KA_TRACE(20, ("__kmp_push_task: T#%d lock-free deque is full; "
+                      "returning TASK_NOT_PUSHED for task %p\n",
+                      gtid, taskdata));
+        return TASK_NOT_PUSHED;
+      }
+      // expand deque to push the task which is not allowed to execute
+      __kmp_cl_deque_push(thread, thread_data, taskdata, true);
+    }
+    KMP_FSYNC_RELEASING(thread->th.th_current_task); // releasing self
+    KMP_FSYNC_RELEASING(taskdata); // releasing child
+    KA_TRACE(20, ("__kmp_push_task: T#%d returning TASK_SUCCESSFULLY_PUSHED: "
+                  "task=%p lock-free ntasks=%d\n",
+                  gtid, taskdata, __kmp_cl_deque_ntasks(thread_data)));
+    return TASK_SUCCESSFULLY_PUSHED;
+  }
+
   int locked = 0;
   // Check if deque is full
   if (TCR_4(thread_data->td.td_deque_ntasks) >=
@@ -861,6 +1166,35 @@ void __kmpc_omp_task_begin(ident_t *loc_ref, kmp_int32 gtid, kmp_task_t *task) {
 }
 #endif // TASK_UNUSED
 
+// __kmp_alloc_taskdata: allocate a block for a task descriptor and its shareds
+// from the task descriptor cache if it is enabled and the block fits a size
+// class, from the thread's fast memory otherwise
+static inline kmp_taskdata_t *__kmp_alloc_taskdata(kmp_info_t *thread,
+                                                   size_t size) {
+  if (__kmp_task_alloc_cache && size <= KMP_TASK_CACHE_MAX_SIZE)
+    return (kmp_taskdata_t *)__kmp_task_cache_allocate(thread, size);
+#if USE_FAST_MEMORY
+  return (kmp_taskdata_t *)__kmp_fast_allocate(thread, size);
+#else /* ! USE_FAST_MEMORY */
+  return (kmp_taskdata_t *)__kmp_thread_malloc(thread, size);
+#endif /* USE_FAST_MEMORY */
+}
+
+// __kmp_free_taskdata: release a block allocated by __kmp_alloc_taskdata
+static inline void __kmp_free_taskdata(kmp_info_t *thread,
+                                       kmp_taskdata_t *taskdata) {
+  size_t size = taskdata->td_size_alloc;
+  if (__kmp_task_alloc_cache && size <= KMP_TASK_CACHE_MAX_SIZE) {
+    __kmp_task_cache_free(thread, taskdata, size, taskdata->td_alloc_thread);
+    return;
+  }
+#if USE_FAST_MEMORY
+  __kmp_fast_free(thread, taskdata);
+#else /* ! USE_FAST_MEMORY */
+  __kmp_thread_free(thread, taskdata);
+#endif /* USE_FAST_MEMORY */
+}
+
 // __kmp_free_task: free the current task space and the space for shareds
 //
 // gtid: Global thread ID of calling thread
@@ -885,12 +1219,9 @@ static void __kmp_free_task(kmp_int32 gtid, kmp_taskdata_t *taskdata,
   task->data2.priority = 0;
 
   taskdata->td_flags.freed = 1;
-// deallocate the taskdata and shared variable blocks associated with this task
-#if USE_FAST_MEMORY
-  __kmp_fast_free(thread, taskdata);
-#else /* ! USE_FAST_MEMORY */
-  __kmp_thread_free(thread, taskdata);
-#endif
+  // deallocate the taskdata and shared variable blocks associated with this
+  // task
+  __kmp_free_taskdata(thread, taskdata);
   KA_TRACE(20, ("__kmp_free_task: T#%d freed task %p\n", gtid, taskdata));
 }
 
@@ -1293,6 +1624,8 @@ void __kmp_init_implicit_task(ident_t *loc_ref, kmp_info_t *this_thr,
     KMP_ATOMIC_ST_REL(&task->td_allocated_child_tasks, 0);
     task->td_taskgroup = NULL; // An implicit task does not have taskgroup
     task->td_dephash = NULL;
+    task->td_taskgraph = NULL;
+    task->td_taskloop_stats = NULL;
     __kmp_push_current_task_to_thread(this_thr, team, tid);
   } else {
     KMP_DEBUG_ASSERT(task->td_incomplete_child_tasks == 0);
@@ -1472,13 +1805,7 @@ kmp_task_t *__kmp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
                 sizeof_shareds));
 
   // Avoid double allocation here by combining shareds with taskdata
-#if USE_FAST_MEMORY
-  taskdata = (kmp_taskdata_t *)__kmp_fast_allocate(thread, shareds_offset +
-                                                               sizeof_shareds);
-#else /* ! USE_FAST_MEMORY */
-  taskdata = (kmp_taskdata_t *)__kmp_thread_malloc(thread, shareds_offset +
-                                                               sizeof_shareds);
-#endif /* USE_FAST_MEMORY */
+  taskdata = __kmp_alloc_taskdata(thread, shareds_offset + sizeof_shareds);
 
   task = KMP_TASKDATA_TO_TASK(taskdata);
 
@@ -1555,6 +1882,9 @@ kmp_task_t *__kmp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
       parent_task->td_taskgroup; // task inherits taskgroup from the parent task
   taskdata->td_dephash = NULL;
   taskdata->td_depnode = NULL;
+  taskdata->td_taskgraph = NULL;
+  taskdata->td_taskloop_stats = NULL;
+  taskdata->td_numa_node = -1;
   taskdata->td_target_data.async_handle = NULL;
   if (flags->tiedness == TASK_UNTIED)
     taskdata->td_last_tied = NULL; // will be set when the task is scheduled
@@ -1647,6 +1977,22 @@ kmp_int32
 __kmpc_omp_reg_task_with_affinity(ident_t *loc_ref, kmp_int32 gtid,
                                   kmp_task_t *new_task, kmp_int32 naffins,
                                   kmp_task_affinity_info_t *affin_list) {
+  if (!__kmp_task_affinity || naffins <= 0 || affin_list == NULL)
+    return 0;
+  // The largest item is taken as the data the task mostly works on, and its
+  // middle as representative of where that data lives
+  kmp_int32 i, item = 0;
+  for (i = 1; i < naffins; ++i) {
+    if (affin_list[i].len > affin_list[item].len)
+      item = i;
+  }
+  kmp_taskdata_t *taskdata = KMP_TASK_TO_TASKDATA(new_task);
+  void *addr =
+      (void *)(affin_list[item].base_addr + affin_list[item].len / 2);
+  taskdata->td_numa_node = __kmp_get_address_numa_node(addr);
+  KA_TRACE(20, ("__kmpc_omp_reg_task_with_affinity: T#%d task %p: address %p "
+                "on NUMA node %d\n",
+                gtid, taskdata, addr, taskdata->td_numa_node));
   return 0;
 }
 
@@ -1808,7 +2154,20 @@ static void __kmp_invoke_task(kmp_int32 gtid, kmp_task_t *task,
       __tgt_target_nowait_query(&taskdata->td_target_data.async_handle);
     } else
 #endif
-    if (task->routine != NULL) {
+    if (UNLIKELY(taskdata->td_taskloop_stats != NULL)) {
+      // adaptive taskloop chunk: measure its execution time
+      kmp_taskloop_stats_t *stats = taskdata->td_taskloop_stats;
+      kmp_uint64 iters = __kmp_taskloop_chunk_iters(task, stats);
+      kmp_uint64 start = __kmp_now_nsec();
+#ifdef KMP_GOMP_COMPAT
+      if (taskdata->td_flags.native)
+        ((void (*)(void *))(*(task->routine)))(task->shareds);
+      else
+#endif /* KMP_GOMP_COMPAT */
+        (*(task->routine))(gtid, task);
+      stats->nsec += __kmp_now_nsec() - start;
+      stats->iters += iters;
+    } else if (task->routine != NULL) {
 #ifdef KMP_GOMP_COMPAT
       if (taskdata->td_flags.native) {
         ((void (*)(void *))(*(task->routine)))(task->shareds);
@@ -2867,6 +3226,92 @@ void __kmpc_end_taskgroup(ident_t *loc, int gtid) {
 #endif
 }
 
+// Removes the first task of a priority heap that the task scheduling
+// constraint allows the thread to execute. Called under td_pri_lock.
+static kmp_taskdata_t *__kmp_pri_heap_remove(kmp_int32 gtid,
+                                             kmp_thread_data_t *thread_data,
+                                             kmp_int32 is_constrained) {
+  kmp_task_pri_entry_t *heap = thread_data->td.td_pri_heap;
+  kmp_int32 ntasks = thread_data->td.td_pri_ntasks;
+  kmp_taskdata_t *current = __kmp_threads[gtid]->th.th_current_task;
+  kmp_int32 i, tried, target = 0;
+
+  if (ntasks == 0)
+    return NULL;
+  while (!__kmp_task_is_allowed(gtid, is_constrained, heap[target].task,
+                                current)) {
+    // Walk through the heap looking for the best task after the one just tried
+    // that the scheduling constraint allows. Only the task finally picked
+    // acquires its mutexinoutset locks.
+    tried = target;
+    target = -1;
+    for (i = 1; i < ntasks; ++i) {
+      if (__kmp_pri_entry_before(&heap[tried], &heap[i]) &&
+          (target < 0 || __kmp_pri_entry_before(&heap[i], &heap[target])) &&
+          __kmp_task_is_tsc_allowed(is_constrained, heap[i].task, current))
+        target = i;
+    }
+    if (target < 0)
+      return NULL;
+  }
+  kmp_taskdata_t *taskdata = heap[target].task;
+  ntasks--;
+  if (target < ntasks) {
+    heap[target] = heap[ntasks];
+    __kmp_pri_heap_sift_down(heap, ntasks, target);
+    __kmp_pri_heap_sift_up(heap, target);
+  }
+  thread_data->td.td_pri_ntasks = ntasks;
+  KMP_ATOMIC_ST_REL(&thread_data->td.td_pri_top,
+                    ntasks > 0 ? heap[0].priority : 0);
+  return taskdata;
+}
+
+// __kmp_get_priority_task_mq: Get a reserved priority task from the
+// per-thread priority heaps (KMP_TASK_PRIORITY_MQ). As in a MultiQueue, the
+// thread compares the top priority of its own heap with that of a random
+// other heap and removes from the better one, so priorities are followed
+// approximately without any team-wide serialization. If that fails, all the
+// heaps are tried in turn.
+static kmp_taskdata_t *__kmp_get_priority_task_mq(kmp_int32 gtid,
+                                                  kmp_task_team_t *task_team,
+                                                  kmp_int32 is_constrained) {
+  kmp_info_t *thread = __kmp_threads[gtid];
+  kmp_thread_data_t *threads_data = task_team->tt.tt_threads_data;
+  kmp_int32 nthreads = task_team->tt.tt_nproc;
+  kmp_int32 tid = __kmp_tid_from_gtid(gtid);
+  kmp_thread_data_t *thread_data;
+  kmp_taskdata_t *taskdata = NULL;
+  kmp_int32 i, first = tid;
+
+  if (nthreads > 1) {
+    kmp_int32 victim = __kmp_get_random(thread) % nthreads;
+    if (KMP_ATOMIC_LD_ACQ(&threads_data[victim].td.td_pri_top) >
+        KMP_ATOMIC_LD_ACQ(&threads_data[tid].td.td_pri_top))
+      first = victim;
+  }
+  for (i = 0; i < nthreads; ++i) {
+    kmp_int32 k = first + i;
+    if (k >= nthreads)
+      k -= nthreads;
+    thread_data = &threads_data[k];
+    if (KMP_ATOMIC_LD_ACQ(&thread_data->td.td_pri_top) == 0)
+      continue;
+    __kmp_acquire_bootstrap_lock(&thread_data->td.td_pri_lock);
+    taskdata = __kmp_pri_heap_remove(gtid, thread_data, is_constrained);
+    __kmp_release_bootstrap_lock(&thread_data->td.td_pri_lock);
+    if (taskdata != NULL) {
+      KA_TRACE(20, ("__kmp_get_priority_task_mq: T#%d got task %p from T#%d\n",
+                    gtid, taskdata, k));
+      return taskdata;
+    }
+  }
+  KA_TRACE(20, ("__kmp_get_priority_task_mq: T#%d could not get task: "
+                "task_team=%p\n",
+                gtid, task_team));
+  return NULL;
+}
+
 static kmp_task_t *__kmp_get_priority_task(kmp_int32 gtid,
                                            kmp_task_team_t *task_team,
                                            kmp_int32 is_constrained) {
@@ -2892,6 +3337,14 @@ static kmp_task_t *__kmp_get_priority_task(kmp_int32 gtid,
     return NULL;
   }
   // We got a "ticket" to get a "reserved" priority task
+  if (__kmp_task_priority_mq) {
+    taskdata = __kmp_get_priority_task_mq(gtid, task_team, is_constrained);
+    if (taskdata == NULL) {
+      task_team->tt.tt_num_task_pri++; // atomic inc, restore value
+      return NULL;
+    }
+    return KMP_TASKDATA_TO_TASK(taskdata);
+  }
   int deque_ntasks;
   kmp_task_pri_t *list = task_team->tt.tt_task_pri_list;
   do {
@@ -2985,6 +3438,26 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
                 gtid, thread_data->td.td_deque_ntasks,
                 thread_data->td.td_deque_head, thread_data->td.td_deque_tail));
 
+  if (__kmp_task_deque_lockfree) {
+    taskdata = __kmp_cl_deque_take(thread_data);
+    if (taskdata != NULL) {
+      if (__kmp_task_is_allowed(gtid, is_constrained, taskdata,
+                                thread->th.th_current_task)) {
+        KA_TRACE(10, ("__kmp_remove_my_task(exit #0): T#%d task %p removed "
+                      "from lock-free deque\n",
+                      gtid, taskdata));
+        return KMP_TASKDATA_TO_TASK(taskdata);
+      }
+      // The TSC does not allow to execute the task, put it back; there is
+      // room for it since it was just removed. Tasks given to us by other
+      // threads may still be eligible, so check the locked deque below.
+      __kmp_cl_deque_push(thread, thread_data, taskdata, false);
+      KA_TRACE(10, ("__kmp_remove_my_task: T#%d TSC blocks lock-free deque "
+                    "bottom task %p\n",
+                    gtid, taskdata));
+    }
+  }
+
   if (TCR_4(thread_data->td.td_deque_ntasks) == 0) {
     KA_TRACE(10,
              ("__kmp_remove_my_task(exit #1): T#%d No tasks to remove: "
@@ -3036,9 +3509,54 @@ static kmp_task_t *__kmp_remove_my_task(kmp_info_t *thread, kmp_int32 gtid,
   return task;
 }
 
+// Upper bound on the number of extra tasks a thief moves to its own deque in
+// one batch steal (KMP_TASK_STEAL_HALF)
+#define KMP_TASK_STEAL_BATCH_MAX (INITIAL_TASK_DEQUE_SIZE / 2)
+
+// __kmp_push_stolen_tasks: queue the extra tasks taken by a batch steal on
+// the thief's own deque, expanding it if needed. The victim's deque lock must
+// not be held, to avoid lock order inversion between two thieves.
+static void __kmp_push_stolen_tasks(kmp_info_t *thread, kmp_int32 gtid,
+                                    kmp_task_team_t *task_team,
+                                    kmp_taskdata_t **tasks, kmp_int32 ntasks) {
+  kmp_thread_data_t *thread_data =
+      &task_team->tt.tt_threads_data[__kmp_tid_from_gtid(gtid)];
+
+  // No lock needed since only owner can allocate
+  if (UNLIKELY(thread_data->td.td_deque == NULL)) {
+    __kmp_alloc_task_deque(thread, thread_data);
+  }
+
+  if (__kmp_task_deque_lockfree) {
+    for (kmp_int32 i = 0; i < ntasks; ++i)
+      __kmp_cl_deque_push(thread, thread_data, tasks[i], true);
+  } else {
+    __kmp_acquire_bootstrap_lock(&thread_data->td.td_deque_lock);
+    for (kmp_int32 i = 0; i < ntasks; ++i) {
+      if (TCR_4(thread_data->td.td_deque_ntasks) >=
+          TASK_DEQUE_SIZE(thread_data->td)) {
+        __kmp_realloc_task_deque(thread, thread_data);
+      }
+      thread_data->td.td_deque[thread_data->td.td_deque_tail] = tasks[i];
+      // Wrap index.
+      thread_data->td.td_deque_tail = (thread_data->td.td_deque_tail + 1) &
+                                      TASK_DEQUE_MASK(thread_data->td);
+      TCW_4(thread_data->td.td_deque_ntasks,
+            TCR_4(thread_data->td.td_deque_ntasks) + 1);
+    }
+    __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
+  }
+
+  KA_TRACE(10, ("__kmp_push_stolen_tasks: T#%d queued %d stolen tasks on own "
+                "deque: task_team=%p\n",
+                gtid, ntasks, task_team));
+}
+
 // __kmp_steal_task: remove a task from another thread's deque
 // Assume that calling thread has already checked existence of
 // task_team thread_data before calling this routine.
+// With KMP_TASK_STEAL_HALF, up to half of the victim's tasks are taken in one
+// steal; the returned task is executed and the rest go to the thief's deque.
 static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
                                     kmp_task_team_t *task_team,
                                     std::atomic<kmp_int32> *unfinished_threads,
@@ -3050,6 +3568,8 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   kmp_thread_data_t *victim_td, *threads_data;
   kmp_int32 target;
   kmp_int32 victim_tid;
+  kmp_taskdata_t *batch[KMP_TASK_STEAL_BATCH_MAX];
+  kmp_int32 nbatch = 0;
 
   KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
 
@@ -3065,6 +3585,55 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
                 victim_td->td.td_deque_ntasks, victim_td->td.td_deque_head,
                 victim_td->td.td_deque_tail));
 
+  if (__kmp_task_deque_lockfree) {
+    // Unlike the locked path below, the task has to be taken out of the
+    // lock-free deque before the TSC can be checked, as it may be executed
+    // and freed by its owner as soon as it is no longer in the deque.
+    taskdata = __kmp_cl_deque_steal(victim_td, unfinished_threads,
+                                    thread_finished);
+    if (taskdata != NULL) {
+      current = __kmp_threads[gtid]->th.th_current_task;
+      if (__kmp_task_is_allowed(gtid, is_constrained, taskdata, current)) {
+        if (__kmp_task_steal_half) {
+          // Take up to half of the tasks the victim had, one CAS each; a
+          // batched CAS of top could race with the owner's uncontended pop.
+          kmp_int32 nmax = (__kmp_cl_deque_ntasks(victim_td) + 1) / 2 - 1;
+          nmax = KMP_MIN(nmax, KMP_TASK_STEAL_BATCH_MAX);
+          while (nbatch < nmax) {
+            kmp_taskdata_t *next = __kmp_cl_deque_steal(
+                victim_td, unfinished_threads, thread_finished);
+            if (next == NULL)
+              break;
+            if (!__kmp_task_is_tsc_allowed(is_constrained, next, current)) {
+              __kmp_give_task(victim_thr, victim_tid,
+                              KMP_TASKDATA_TO_TASK(next), INT_MAX);
+              break;
+            }
+            batch[nbatch++] = next;
+          }
+          if (nbatch > 0)
+            __kmp_push_stolen_tasks(__kmp_threads[gtid], gtid, task_team,
+                                    batch, nbatch);
+        }
+        KMP_COUNT_BLOCK(TASK_stolen);
+        KA_TRACE(10, ("__kmp_steal_task(exit #0): T#%d stole task %p and %d "
+                      "more from T#%d lock-free deque: task_team=%p\n",
+                      gtid, taskdata, nbatch,
+                      __kmp_gtid_from_thread(victim_thr), task_team));
+        return KMP_TASKDATA_TO_TASK(taskdata);
+      }
+      // The TSC does not allow to steal the task; hand it back to the victim
+      // through its locked deque, which accepts tasks from other threads.
+      bool given = __kmp_give_task(victim_thr, victim_tid,
+                                   KMP_TASKDATA_TO_TASK(taskdata), INT_MAX);
+      KMP_DEBUG_ASSERT(given);
+      KMP_DEBUG_USE_VAR(given);
+      KA_TRACE(10, ("__kmp_steal_task: T#%d TSC blocks task %p stolen from "
+                    "T#%d, returned it to the victim\n",
+                    gtid, taskdata, __kmp_gtid_from_thread(victim_thr)));
+    }
+  }
+
   if (TCR_4(victim_td->td.td_deque_ntasks) == 0) {
     KA_TRACE(10, ("__kmp_steal_task(exit #1): T#%d could not steal from T#%d: "
                   "task_team=%p ntasks=%d head=%u tail=%u\n",
@@ -3094,6 +3663,20 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
     // Bump head pointer and Wrap.
     victim_td->td.td_deque_head =
         (victim_td->td.td_deque_head + 1) & TASK_DEQUE_MASK(victim_td->td);
+    if (__kmp_task_steal_half) {
+      // Move more tasks from the head, up to half of the victim's deque,
+      // stopping at the first one the TSC does not allow us to execute
+      kmp_int32 nmax = KMP_MIN(ntasks / 2 - 1, KMP_TASK_STEAL_BATCH_MAX);
+      while (nbatch < nmax) {
+        kmp_taskdata_t *next =
+            victim_td->td.td_deque[victim_td->td.td_deque_head];
+        if (!__kmp_task_is_tsc_allowed(is_constrained, next, current))
+          break;
+        batch[nbatch++] = next;
+        victim_td->td.td_deque_head =
+            (victim_td->td.td_deque_head + 1) & TASK_DEQUE_MASK(victim_td->td);
+      }
+    }
   } else {
     if (!task_team->tt.tt_untied_task_encountered) {
       // The TSC does not allow to steal victim task
@@ -3152,21 +3735,80 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
          gtid, count + 1, task_team));
     *thread_finished = FALSE;
   }
-  TCW_4(victim_td->td.td_deque_ntasks, ntasks - 1);
+  TCW_4(victim_td->td.td_deque_ntasks, ntasks - 1 - nbatch);
 
   __kmp_release_bootstrap_lock(&victim_td->td.td_deque_lock);
 
+  if (nbatch > 0)
+    __kmp_push_stolen_tasks(__kmp_threads[gtid], gtid, task_team, batch,
+                            nbatch);
+
   KMP_COUNT_BLOCK(TASK_stolen);
   KA_TRACE(10,
-           ("__kmp_steal_task(exit #5): T#%d stole task %p from T#%d: "
-            "task_team=%p ntasks=%d head=%u tail=%u\n",
-            gtid, taskdata, __kmp_gtid_from_thread(victim_thr), task_team,
-            ntasks, victim_td->td.td_deque_head, victim_td->td.td_deque_tail));
+           ("__kmp_steal_task(exit #5): T#%d stole task %p and %d more from "
+            "T#%d: task_team=%p ntasks=%d head=%u tail=%u\n",
+            gtid, taskdata, nbatch, __kmp_gtid_from_thread(victim_thr),
+            task_team, ntasks, victim_td->td.td_deque_head,
+            victim_td->td.td_deque_tail));
 
   task = KMP_TASKDATA_TO_TASK(taskdata);
   return task;
 }
 
+// __kmp_get_steal_victim: select a thread to steal tasks from, excluding the
+// calling thread. With KMP_TASK_STEAL_HIER, threads sharing the locality level
+// the thief is currently at are tried first; see __kmp_steal_done for how the
+// level changes. Otherwise, or at the remote level, pick a random thread.
+static kmp_int32 __kmp_get_steal_victim(kmp_info_t *thread,
+                                        kmp_task_team_t *task_team,
+                                        kmp_int32 tid, kmp_int32 nthreads) {
+  kmp_int32 *locality = task_team->tt.tt_steal_locality;
+  if (locality != NULL) {
+    kmp_thread_data_t *thread_data = &task_team->tt.tt_threads_data[tid];
+    while (thread_data->td.td_steal_level < KMP_TASK_STEAL_LOCAL_LEVELS) {
+      kmp_int32 level = thread_data->td.td_steal_level;
+      kmp_int32 id = locality[tid * KMP_TASK_STEAL_LOCAL_LEVELS + level];
+      if (id >= 0) {
+        kmp_int32 start = __kmp_get_random(thread) % nthreads;
+        for (kmp_int32 i = 0; i < nthreads; ++i) {
+          kmp_int32 victim_tid = (start + i) % nthreads;
+          if (victim_tid != tid &&
+              locality[victim_tid * KMP_TASK_STEAL_LOCAL_LEVELS + level] == id)
+            return victim_tid;
+        }
+      }
+      // Nobody else shares this level with the thief, go up one level
+      thread_data->td.td_steal_level++;
+      thread_data->td.td_steal_attempts = 0;
+    }
+  }
+  kmp_int32 victim_tid = __kmp_get_random(thread) % (nthreads - 1);
+  if (victim_tid >= tid) {
+    ++victim_tid; // Adjusts random distribution to exclude self
+  }
+  return victim_tid;
+}
+
+// __kmp_steal_done: update the thief's hierarchical victim selection state
+// after a steal attempt. A successful steal restarts from the closest level;
+// after KMP_TASK_STEAL_HIER failed attempts the thief moves up one level, and
+// from the remote level back to the closest one.
+static inline void __kmp_steal_done(kmp_task_team_t *task_team, kmp_int32 tid,
+                                    bool success) {
+  if (task_team->tt.tt_steal_locality == NULL)
+    return;
+  kmp_thread_data_t *thread_data = &task_team->tt.tt_threads_data[tid];
+  if (success) {
+    thread_data->td.td_steal_level = 0;
+    thread_data->td.td_steal_attempts = 0;
+  } else if (++thread_data->td.td_steal_attempts >= __kmp_task_steal_hier) {
+    thread_data->td.td_steal_attempts = 0;
+    kmp_int32 level = thread_data->td.td_steal_level + 1;
+    thread_data->td.td_steal_level =
+        level > KMP_TASK_STEAL_LOCAL_LEVELS ? 0 : level;
+  }
+}
+
 // __kmp_execute_tasks_template: Choose and execute tasks until either the
 // condition is statisfied (return true) or there are none left (return false).
 //
@@ -3239,10 +3881,8 @@ static inline int __kmp_execute_tasks_template(
             // Pick a random thread. Initial plan was to cycle through all the
             // threads, and only return if we tried to steal from every thread,
             // and failed.  Arch says that's not such a great idea.
-            victim_tid = __kmp_get_random(thread) % (nthreads - 1);
-            if (victim_tid >= tid) {
-              ++victim_tid; // Adjusts random distribution to exclude self
-            }
+            victim_tid =
+                __kmp_get_steal_victim(thread, task_team, tid, nthreads);
             // Found a potential victim
             other_thread = threads_data[victim_tid].td.td_thr;
             // There is a slight chance that __kmp_enable_tasking() did not wake
@@ -3275,6 +3915,7 @@ static inline int __kmp_execute_tasks_template(
           task = __kmp_steal_task(other_thread, gtid, task_team,
                                   unfinished_threads, thread_finished,
                                   is_constrained);
+          __kmp_steal_done(task_team, tid, task != NULL);
         }
         if (task != NULL) { // set last stolen to victim
           if (threads_data[tid].td.td_deque_last_stolen != victim_tid) {
@@ -3326,7 +3967,7 @@ static inline int __kmp_execute_tasks_template(
       KMP_YIELD(__kmp_library == library_throughput); // Yield before next task
       // If execution of a stolen task results in more tasks being placed on our
       // run queue, reset use_own_tasks
-      if (!use_own_tasks && TCR_4(threads_data[tid].td.td_deque_ntasks) != 0) {
+      if (!use_own_tasks && __kmp_thread_data_ntasks(&threads_data[tid]) != 0) {
         KA_TRACE(20, ("__kmp_execute_tasks_template: T#%d stolen task spawned "
                       "other tasks, restart\n",
                       gtid));
@@ -3577,6 +4218,7 @@ kmp_bootstrap_lock_t __kmp_task_team_lock =
 static void __kmp_alloc_task_deque(kmp_info_t *thread,
                                    kmp_thread_data_t *thread_data) {
   __kmp_init_bootstrap_lock(&thread_data->td.td_deque_lock);
+  __kmp_init_bootstrap_lock(&thread_data->td.td_pri_lock);
   KMP_DEBUG_ASSERT(thread_data->td.td_deque == NULL);
 
   // Initialize last stolen task field to "none"
@@ -3596,6 +4238,12 @@ static void __kmp_alloc_task_deque(kmp_info_t *thread,
   thread_data->td.td_deque = (kmp_taskdata_t **)__kmp_allocate(
       INITIAL_TASK_DEQUE_SIZE * sizeof(kmp_taskdata_t *));
   thread_data->td.td_deque_size = INITIAL_TASK_DEQUE_SIZE;
+
+  if (__kmp_task_deque_lockfree) {
+    KMP_DEBUG_ASSERT(KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array) == NULL);
+    KMP_ATOMIC_ST_REL(&thread_data->td.td_cl_array,
+                      __kmp_alloc_cl_deque_array(INITIAL_TASK_DEQUE_SIZE));
+  }
 }
 
 // __kmp_free_task_deque:
@@ -3610,6 +4258,26 @@ static void __kmp_free_task_deque(kmp_thread_data_t *thread_data) {
     __kmp_release_bootstrap_lock(&thread_data->td.td_deque_lock);
   }
 
+  kmp_task_deque_array_t *array =
+      KMP_ATOMIC_LD_RLX(&thread_data->td.td_cl_array);
+  while (array != NULL) {
+    kmp_task_deque_array_t *prev = array->prev;
+    __kmp_free(array);
+    array = prev;
+  }
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_array,
+                    (kmp_task_deque_array_t *)NULL);
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_bottom, 0);
+  KMP_ATOMIC_ST_RLX(&thread_data->td.td_cl_top, 0);
+
+  if (thread_data->td.td_pri_heap != NULL) {
+    __kmp_free(thread_data->td.td_pri_heap);
+    thread_data->td.td_pri_heap = NULL;
+    thread_data->td.td_pri_heap_size = 0;
+    thread_data->td.td_pri_ntasks = 0;
+    KMP_ATOMIC_ST_RLX(&thread_data->td.td_pri_top, 0);
+  }
+
 #ifdef BUILD_TIED_TASK_STACK
   // GEH: Figure out what to do here for td_susp_tied_tasks
   if (thread_data->td.td_susp_tied_tasks.ts_entries != TASK_STACK_EMPTY) {
@@ -3716,8 +4384,43 @@ static int __kmp_realloc_task_threads_data(kmp_info_t *thread,
         // parallel region will exhibit the same behavior as previous region.
         thread_data->td.td_deque_last_stolen = -1;
       }
+      thread_data->td.td_steal_level = 0;
+      thread_data->td.td_steal_attempts = 0;
+      if (__kmp_task_affinity && thread_data->td.td_deque == NULL) {
+        // Tasks with an affinity clause may be given to any thread before it
+        // queues tasks itself. No thread uses the deques until tt_found_tasks
+        // is set.
+        __kmp_alloc_task_deque(team->t.t_threads[i], thread_data);
+      }
     }
 
+#if KMP_AFFINITY_SUPPORTED
+    if (__kmp_task_steal_hier > 0 && KMP_AFFINITY_CAPABLE()) {
+      // Threads may have moved to other places since the last region, so
+      // recompute their locality for hierarchical victim selection
+      if (task_team->tt.tt_steal_locality == NULL || maxthreads < nthreads) {
+        if (task_team->tt.tt_steal_locality != NULL)
+          __kmp_free(task_team->tt.tt_steal_locality);
+        task_team->tt.tt_steal_locality = (kmp_int32 *)__kmp_allocate(
+            nthreads * KMP_TASK_STEAL_LOCAL_LEVELS * sizeof(kmp_int32));
+      }
+      kmp_int32 *locality = task_team->tt.tt_steal_locality;
+      for (i = 0; i < nthreads; i++) {
+        kmp_info_t *th = team->t.t_threads[i];
+        kmp_int32 id = __kmp_affinity_get_locality_id(th, KMP_HW_L2);
+        if (id < 0)
+          id = __kmp_affinity_get_locality_id(th, KMP_HW_CORE);
+        locality[i * KMP_TASK_STEAL_LOCAL_LEVELS] = id;
+        id = __kmp_affinity_get_locality_id(th, KMP_HW_LLC);
+        if (id < 0)
+          id = __kmp_affinity_get_locality_id(th, KMP_HW_NUMA);
+        if (id < 0)
+          id = __kmp_affinity_get_locality_id(th, KMP_HW_SOCKET);
+        locality[i * KMP_TASK_STEAL_LOCAL_LEVELS + 1] = id;
+      }
+    }
+#endif // KMP_AFFINITY_SUPPORTED
+
     KMP_MB();
     TCW_SYNC_4(task_team->tt.tt_found_tasks, TRUE);
   }
@@ -3738,6 +4441,10 @@ static void __kmp_free_task_threads_data(kmp_task_team_t *task_team) {
     }
     __kmp_free(task_team->tt.tt_threads_data);
     task_team->tt.tt_threads_data = NULL;
+    if (task_team->tt.tt_steal_locality != NULL) {
+      __kmp_free(task_team->tt.tt_steal_locality);
+      task_team->tt.tt_steal_locality = NULL;
+    }
   }
   __kmp_release_bootstrap_lock(&task_team->tt.tt_threads_lock);
 }
@@ -3939,6 +4646,9 @@ void __kmp_wait_to_unref_task_teams(void) {
 void __kmp_task_team_setup(kmp_info_t *this_thr, kmp_team_t *team, int always) {
   KMP_DEBUG_ASSERT(__kmp_tasking_mode != tskm_immediate_exec);
 
+  if (__kmp_task_affinity)
+    this_thr->th.th_numa_node = __kmp_get_thread_numa_node();
+
   // If this task_team hasn't been created yet, allocate it. It will be used in
   // the region after the next.
   // If it exists, it is the current task team and shouldn't be touched yet as
@@ -4024,6 +4734,9 @@ void __kmp_task_team_sync(kmp_info_t *this_thr, kmp_team_t *team) {
   // refers to
   this_thr->th.th_task_state = (kmp_uint8)(1 - this_thr->th.th_task_state);
 
+  if (__kmp_task_affinity)
+    this_thr->th.th_numa_node = __kmp_get_thread_numa_node();
+
   // It is now safe to propagate the task team pointer from the team struct to
   // the current thread.
   TCW_PTR(this_thr->th.th_task_team,
@@ -4445,11 +5158,7 @@ kmp_task_t *__kmp_task_dup_alloc(kmp_info_t *thread, kmp_task_t *task_src) {
   // Allocate a kmp_taskdata_t block and a kmp_task_t block.
   KA_TRACE(30, ("__kmp_task_dup_alloc: Th %p, malloc size %ld\n", thread,
                 task_size));
-#if USE_FAST_MEMORY
-  taskdata = (kmp_taskdata_t *)__kmp_fast_allocate(thread, task_size);
-#else
-  taskdata = (kmp_taskdata_t *)__kmp_thread_malloc(thread, task_size);
-#endif /* USE_FAST_MEMORY */
+  taskdata = __kmp_alloc_taskdata(thread, task_size);
   KMP_MEMCPY(taskdata, taskdata_src, task_size);
 
   task = KMP_TASKDATA_TO_TASK(taskdata);
@@ -4606,6 +5315,62 @@ public:
   }
 };
 
+#define KMP_TASKLOOP_STATS_SIZE 256 // Must be a power of two
+
+// Statistics of the taskloop constructs encountered with adaptive grainsize,
+// in an open addressing table which is never shrunk
+static kmp_taskloop_stats_t __kmp_taskloop_stats[KMP_TASKLOOP_STATS_SIZE];
+static std::atomic<kmp_int32> __kmp_taskloop_stats_full(0);
+
+// __kmp_taskloop_get_stats: find or insert the statistics of the taskloop
+// construct with the given task routine and stride. Returns NULL if the table
+// is full (warning once), or if another thread is still filling in the slot.
+static kmp_taskloop_stats_t *
+__kmp_taskloop_get_stats(kmp_routine_entry_t routine, kmp_int64 st,
+                         const kmp_taskloop_bounds_t &bounds) {
+  kmp_uint32 h = (kmp_uint32)(((kmp_uintptr_t)routine >> 4) * 0x9E3779B1u);
+  for (kmp_uint32 i = 0; i < KMP_TASKLOOP_STATS_SIZE; ++i) {
+    kmp_taskloop_stats_t *stats =
+        &__kmp_taskloop_stats[(h + i) & (KMP_TASKLOOP_STATS_SIZE - 1)];
+    kmp_routine_entry_t cur = KMP_ATOMIC_LD_ACQ(&stats->routine);
+    if (cur == NULL && stats->routine.compare_exchange_strong(cur, routine)) {
+      // claimed a free slot
+      stats->st = st;
+      stats->lower_offset = bounds.get_lower_offset();
+      stats->upper_offset = bounds.get_upper_offset();
+      KMP_ATOMIC_ST_REL(&stats->ready, 1);
+      return stats;
+    }
+    if (cur == routine) {
+      if (!KMP_ATOMIC_LD_ACQ(&stats->ready))
+        return NULL;
+      if (stats->st == st)
+        return stats;
+    }
+  }
+  if (__kmp_taskloop_stats_full.exchange(1) == 0)
+    KMP_WARNING(TaskloopStatsFull, "KMP_TASKLOOP_ADAPTIVE",
+                KMP_TASKLOOP_STATS_SIZE);
+  return NULL;
+}
+
+// __kmp_taskloop_chunk_iters: number of iterations of an adaptive taskloop
+// chunk, computed from its bounds before it executes
+static kmp_uint64 __kmp_taskloop_chunk_iters(kmp_task_t *task,
+                                             const kmp_taskloop_stats_t *stats) {
+  kmp_taskloop_bounds_t bounds(
+      task, (kmp_uint64 *)((char *)task + stats->lower_offset),
+      (kmp_uint64 *)((char *)task + stats->upper_offset));
+  kmp_uint64 lb = bounds.get_lb();
+  kmp_uint64 ub = bounds.get_ub();
+  kmp_int64 st = stats->st;
+  if (KMP_TASK_TO_TASKDATA(task)->td_flags.native)
+    ub -= (st > 0 ? 1 : -1); // GOMP upper bound is exclusive
+  if (st > 0)
+    return (ub - lb) / st + 1;
+  return (lb - ub) / (-st) + 1;
+}
+
 // __kmp_taskloop_linear: Start tasks of the taskloop linearly
 //
 // loc        Source location information
@@ -4998,6 +5763,30 @@ static void __kmp_taskloop(ident_t *loc, int gtid, kmp_task_t *task, int if_val,
   }
 #endif
 
+  if (__kmp_taskloop_adaptive > 0 && sched == 0) {
+    // No schedule clause: choose the grainsize so that tasks run for about
+    // __kmp_taskloop_adaptive microseconds, based on the cost of the tasks of
+    // previous executions of the construct
+    kmp_taskloop_stats_t *stats =
+        __kmp_taskloop_get_stats(task->routine, st, task_bounds);
+    if (stats != NULL) {
+      kmp_uint64 iters = stats->iters;
+      kmp_uint64 nsec = stats->nsec;
+      if (iters > 0 && nsec > 0) {
+        double grain = (double)__kmp_taskloop_adaptive * 1000 * iters / nsec;
+        grainsize = grain < 1.0 ? 1 : grain >= tc ? tc : (kmp_uint64)grain;
+        sched = 1;
+        // age the samples so that the grainsize follows changes of the cost
+        stats->iters = iters / 2;
+        stats->nsec = nsec / 2;
+        KA_TRACE(20, ("__kmp_taskloop: T#%d, adaptive grainsize %llu for "
+                      "%llu iterations in %llu ns\n",
+                      gtid, grainsize, iters, nsec));
+      }
+      taskdata->td_taskloop_stats = stats;
+    }
+  }
+
   if (num_tasks_min == 0)
     // TODO: can we choose better default heuristic?
     num_tasks_min =
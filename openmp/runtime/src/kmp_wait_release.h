@@ -374,6 +374,7 @@ __kmp_wait_template(kmp_info_t *this_thr,
 #if !KMP_USE_MONITOR
   kmp_uint64 poll_count;
   kmp_uint64 hibernate_goal;
+  kmp_uint64 wait_start = 0;
 #else
   kmp_uint32 hibernate;
 #endif
@@ -512,6 +513,14 @@ final_spin=FALSE)
     if (__kmp_pause_status == kmp_soft_paused) {
       // Force immediate suspend
       hibernate_goal = KMP_NOW();
+    } else if (__kmp_adaptive_blocktime && Sleepable) {
+      // Spin only if the recent waits of this kind were shorter than the
+      // blocktime, otherwise suspend right away
+      wait_start = KMP_NOW();
+      hibernate_goal = wait_start;
+      if (this_thr->th.th_bt_wait[final_spin] <
+          this_thr->th.th_team_bt_intervals)
+        hibernate_goal += this_thr->th.th_team_bt_intervals;
     } else
       hibernate_goal = KMP_NOW() + this_thr->th.th_team_bt_intervals;
     poll_count = 0;
@@ -557,7 +566,7 @@ final_spin=FALSE)
     } // if
 
     KMP_FSYNC_SPIN_PREPARE(CCAST(void *, spin));
-    if (TCR_4(__kmp_global.g.g_done)) {
+    if (__kmp_worker_exiting(this_thr)) {
       if (__kmp_global.g.g_abort)
         __kmp_abort_thread();
       break;
@@ -646,7 +655,7 @@ final_spin=FALSE)
     }
 #endif
 
-    if (TCR_4(__kmp_global.g.g_done)) {
+    if (__kmp_worker_exiting(this_thr)) {
       if (__kmp_global.g.g_abort)
         __kmp_abort_thread();
       break;
@@ -657,6 +666,23 @@ final_spin=FALSE)
     // TODO: If thread is done with work and times out, disband/free
   }
 
+#if !KMP_USE_MONITOR
+  if (wait_start) {
+    // Average the wait times, capped so that a single long wait is forgotten
+    // after a few short ones
+    kmp_uint64 bt = this_thr->th.th_team_bt_intervals;
+    kmp_uint64 waited = KMP_NOW() - wait_start;
+    kmp_uint64 *avg = &this_thr->th.th_bt_wait[final_spin];
+    *avg = (3 * *avg + KMP_MIN(waited, 2 * bt)) / 4;
+#if KMP_STATS_ENABLED
+    if (hibernate_goal == wait_start) { // the spin was skipped
+      kmp_uint64 saved = KMP_MIN(waited, bt);
+      KMP_COUNT_VALUE(OMP_blocktime_saved, KMP_NOW_TO_USEC(saved));
+    }
+#endif
+  }
+#endif
+
 #if OMPT_SUPPORT
   ompt_state_t ompt_exit_state = this_thr->th.ompt_thread_info.state;
   if (ompt_enabled.enabled && ompt_exit_state != ompt_state_undefined) {
@@ -48,6 +48,9 @@
 #ifndef FUTEX_WAKE
 #define FUTEX_WAKE 1
 #endif
+#ifndef FUTEX_PRIVATE_FLAG
+#define FUTEX_PRIVATE_FLAG 128
+#endif
 #endif
 #elif KMP_OS_DARWIN
 #include <mach/mach.h>
@@ -1266,7 +1269,12 @@ static void __kmp_atfork_child(void) {
 
   __kmp_thread_pool = NULL;
   __kmp_thread_pool_insert_pt = NULL;
+  KMP_ATOMIC_ST_RLX(&__kmp_pool_reap_time, 0);
   __kmp_team_pool = NULL;
+#if KMP_NESTED_HOT_TEAMS
+  __kmp_hot_teams_lru = NULL;
+  __kmp_hot_teams_lru_tail = NULL;
+#endif
 
   /* Must actually zero all the *cache arguments passed to __kmpc_threadprivate
      here so threadprivate doesn't use stale data */
@@ -1392,6 +1400,38 @@ void __kmp_unlock_suspend_mx(kmp_info_t *th) {
   KMP_CHECK_SYSFAIL("pthread_mutex_unlock", status);
 }
 
+#if KMP_USE_FUTEX
+/* With KMP_FUTEX_SUSPEND, a suspended thread sleeps on th_suspend_futex in
+   place of th_suspend_cv. The word is set while the suspend mutex is held, and
+   __kmp_resume_template clears it before the wake, so a wake-up between the
+   unlock and the wait makes the wait return at once. Called and returns with
+   the suspend mutex held; the status is 0, EINTR or ETIMEDOUT, as for
+   pthread_cond_(timed)wait. */
+static int __kmp_futex_suspend_wait(kmp_info_t *th) {
+  int status = 0;
+  struct timespec *timeout = NULL;
+#if USE_SUSPEND_TIMEOUT
+  struct timespec rel;
+  int msecs = (4 * __kmp_dflt_blocktime) + 200;
+  rel.tv_sec = msecs / 1000;
+  rel.tv_nsec = (msecs % 1000) * 1000000;
+  timeout = &rel;
+#endif
+  KMP_ATOMIC_ST_RLX(&th->th.th_suspend_futex, 1);
+  __kmp_unlock_suspend_mx(th);
+  if (syscall(__NR_futex, &th->th.th_suspend_futex,
+              FUTEX_WAIT | FUTEX_PRIVATE_FLAG, 1, timeout, NULL, 0) != 0) {
+    status = errno;
+    if (status == EAGAIN) // resumed before the wait
+      status = 0;
+    else if (status != EINTR && status != ETIMEDOUT)
+      KMP_SYSFAIL("futex_wait", status);
+  }
+  __kmp_lock_suspend_mx(th);
+  return status;
+}
+#endif // KMP_USE_FUTEX
+
 /* This routine puts the calling thread to sleep after setting the
    sleep bit for the indicated flag variable to true. */
 template <class C>
@@ -1464,31 +1504,41 @@ static inline void __kmp_suspend_template(int th_gtid, C *flag) {
       KMP_DEBUG_ASSERT(th->th.th_sleep_loc);
       KMP_DEBUG_ASSERT(flag->get_type() == th->th.th_sleep_loc_type);
 
+#if KMP_USE_FUTEX
+      if (__kmp_futex_suspend) {
+        KF_TRACE(15, ("__kmp_suspend_template: T#%d about to perform"
+                      " futex_wait\n",
+                      th_gtid));
+        status = __kmp_futex_suspend_wait(th);
+      } else
+#endif
+      {
 #if USE_SUSPEND_TIMEOUT
-      struct timespec now;
-      struct timeval tval;
-      int msecs;
-
-      status = gettimeofday(&tval, NULL);
-      KMP_CHECK_SYSFAIL_ERRNO("gettimeofday", status);
-      TIMEVAL_TO_TIMESPEC(&tval, &now);
-
-      msecs = (4 * __kmp_dflt_blocktime) + 200;
-      now.tv_sec += msecs / 1000;
-      now.tv_nsec += (msecs % 1000) * 1000;
-
-      KF_TRACE(15, ("__kmp_suspend_template: T#%d about to perform "
-                    "pthread_cond_timedwait\n",
-                    th_gtid));
-      status = pthread_cond_timedwait(&th->th.th_suspend_cv.c_cond,
-                                      &th->th.th_suspend_mx.m_mutex, &now);
+        struct timespec now;
+        struct timeval tval;
+        int msecs;
+
+        status = gettimeofday(&tval, NULL);
+        KMP_CHECK_SYSFAIL_ERRNO("gettimeofday", status);
+        TIMEVAL_TO_TIMESPEC(&tval, &now);
+
+        msecs = (4 * __kmp_dflt_blocktime) + 200;
+        now.tv_sec += msecs / 1000;
+        now.tv_nsec += (msecs % 1000) * 1000;
+
+        KF_TRACE(15, ("__kmp_suspend_template: T#%d about to perform "
+                      "pthread_cond_timedwait\n",
+                      th_gtid));
+        status = pthread_cond_timedwait(&th->th.th_suspend_cv.c_cond,
+                                        &th->th.th_suspend_mx.m_mutex, &now);
 #else
-      KF_TRACE(15, ("__kmp_suspend_template: T#%d about to perform"
-                    " pthread_cond_wait\n",
-                    th_gtid));
-      status = pthread_cond_wait(&th->th.th_suspend_cv.c_cond,
-                                 &th->th.th_suspend_mx.m_mutex);
+        KF_TRACE(15, ("__kmp_suspend_template: T#%d about to perform"
+                      " pthread_cond_wait\n",
+                      th_gtid));
+        status = pthread_cond_wait(&th->th.th_suspend_cv.c_cond,
+                                   &th->th.th_suspend_mx.m_mutex);
 #endif // USE_SUSPEND_TIMEOUT
+      }
 
       if ((status != 0) && (status != EINTR) && (status != ETIMEDOUT)) {
         KMP_SYSFAIL("pthread_cond_wait", status);
@@ -1650,6 +1700,21 @@ static inline void __kmp_resume_template(int target_gtid, C *flag) {
     __kmp_printf("__kmp_resume_template: T#%d resuming T#%d: %s\n", gtid,
                  target_gtid, buffer);
   }
+#endif
+#if KMP_USE_FUTEX
+  if (__kmp_futex_suspend) {
+    // Wake after the unlock, so the thread does not block again on the mutex
+    KMP_ATOMIC_ST_REL(&th->th.th_suspend_futex, 0);
+    __kmp_unlock_suspend_mx(th);
+    status = syscall(__NR_futex, &th->th.th_suspend_futex,
+                     FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+    if (status < 0)
+      KMP_SYSFAIL("futex_wake", errno);
+    KF_TRACE(30, ("__kmp_resume_template: T#%d exiting after futex wake up"
+                  " for T#%d\n",
+                  gtid, target_gtid));
+    return;
+  }
 #endif
   status = pthread_cond_signal(&th->th.th_suspend_cv.c_cond);
   KMP_CHECK_SYSFAIL("pthread_cond_signal", status);
@@ -2018,6 +2083,34 @@ void __kmp_initialize_system_tick() {
 }
 #endif
 
+// Flags of the get_mempolicy system call, see <numaif.h>
+#define KMP_MPOL_F_NODE (1 << 0)
+#define KMP_MPOL_F_ADDR (1 << 1)
+
+/* Return the NUMA node of the CPU the calling thread runs on, or -1 if it is
+   unknown. */
+int __kmp_get_thread_numa_node(void) {
+#if KMP_OS_LINUX && defined(SYS_getcpu)
+  unsigned cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+    return (int)node;
+#endif
+  return -1;
+}
+
+/* Return the NUMA node holding the page at the given address, or -1 if it is
+   unknown. A page not allocated yet is allocated as if the calling thread
+   read from it. */
+int __kmp_get_address_numa_node(void *addr) {
+#if KMP_OS_LINUX && defined(SYS_get_mempolicy)
+  int node = -1;
+  if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr,
+              KMP_MPOL_F_NODE | KMP_MPOL_F_ADDR) == 0)
+    return node;
+#endif
+  return -1;
+}
+
 /* Determine whether the given address is mapped into the current address
    space. */
 
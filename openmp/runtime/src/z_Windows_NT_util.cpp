@@ -1516,6 +1516,11 @@ void __kmp_thread_sleep(int millis) {
   }
 }
 
+// NUMA nodes of threads and addresses are not queried on Windows, so tasks
+// with an affinity clause are scheduled as any other task.
+int __kmp_get_thread_numa_node(void) { return -1; }
+int __kmp_get_address_numa_node(void *addr) { return -1; }
+
 // Determine whether the given address is mapped into the current address space.
 int __kmp_is_address_mapped(void *addr) {
   MEMORY_BASIC_INFORMATION lpBuffer;
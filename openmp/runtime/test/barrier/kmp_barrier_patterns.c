@@ -0,0 +1,261 @@
+// RUN: %libomp-compile && env \
+// RUN:   KMP_PLAIN_BARRIER_PATTERN=dissemination,dissemination \
+// RUN:   KMP_REDUCTION_BARRIER_PATTERN=dissemination,dissemination \
+// RUN:   KMP_FORCE_REDUCTION=tree %libomp-run
+// RUN: %libomp-compile && env KMP_PLAIN_BARRIER_PATTERN=dissemination,hyper \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=tournament,tournament \
+// RUN:   KMP_REDUCTION_BARRIER_PATTERN=tournament,tournament \
+// RUN:   KMP_FORCE_REDUCTION=tree %libomp-run
+// RUN: %libomp-compile && env KMP_BLOCKTIME=0 \
+// RUN:   KMP_PLAIN_BARRIER_PATTERN=dissemination,dissemination \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=tournament,tournament \
+// RUN:   KMP_FORCE_REDUCTION=tree %libomp-run
+// RUN: %libomp-compile && env KMP_PLAIN_BARRIER_PATTERN=auto \
+// RUN:   KMP_REDUCTION_BARRIER_PATTERN=auto KMP_BARRIER_AUTO_SAMPLES=2 \
+// RUN:   KMP_FORCE_REDUCTION=tree %libomp-run
+// RUN: %libomp-compile && env KMP_BLOCKTIME=infinite \
+// RUN:   KMP_PLAIN_BARRIER_PATTERN=tournament,dissemination \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=tournament,hyper \
+// RUN:   KMP_REDUCTION_BARRIER_PATTERN=dissemination,tournament \
+// RUN:   KMP_FORCE_REDUCTION=tree %libomp-run
+
+// Test the dissemination, tournament and auto barrier patterns: plain barriers
+// with and without tasks, tree reductions, fork/join of teams of changing sizes
+// and nested teams.
+//
+// Run with an argument, the test is a microbenchmark of the barrier patterns
+// selected in the environment, e.g.
+//   for p in linear tree hyper hierarchical dist dissemination tournament auto
+//   do
+//     KMP_PLAIN_BARRIER_PATTERN=$p,$p KMP_FORKJOIN_BARRIER_PATTERN=$p,$p \
+//     KMP_REDUCTION_BARRIER_PATTERN=$p,$p ./kmp_barrier_patterns $p
+//   done
+// prints the cost of a plain barrier, a tree reduction and a parallel region
+// for each team size up to the number of processors, or the second argument.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define ITERS 500
+#define BENCH_ITERS 20000
+
+// Internal library stuff to emulate compiler's code generation of a
+// reduction(+:sum) clause
+#ifdef __cplusplus
+extern "C" {
+#endif
+typedef struct {
+  int32_t reserved_1;
+  int32_t flags;
+  int32_t reserved_2;
+  int32_t reserved_3;
+  char const *psource;
+} ident_t;
+
+static ident_t dummy_loc = {0, 2, 0, 0, ";dummyFile;dummyFunc;0;0;;"};
+
+typedef union {
+  void *ptr;
+  int32_t data[8];
+} kmp_critical_name;
+static kmp_critical_name crit;
+
+int32_t __kmpc_global_thread_num(ident_t *);
+int32_t __kmpc_reduce(ident_t *, int32_t global_tid, int32_t num_vars,
+                      size_t reduce_size, void *reduce_data, void *reduce_func,
+                      kmp_critical_name *lck);
+void __kmpc_end_reduce(ident_t *, int32_t global_tid, kmp_critical_name *lck);
+#ifdef __cplusplus
+}
+#endif
+
+static void reduce_sum(void *lhs, void *rhs) {
+  *(long *)lhs += *(long *)rhs;
+}
+
+static void reduce(long *sum, long local) {
+  int32_t gtid = __kmpc_global_thread_num(&dummy_loc);
+  switch (__kmpc_reduce(&dummy_loc, gtid, 1, sizeof(long), &local,
+                        (void *)&reduce_sum, &crit)) {
+  case 1:
+    *sum += local;
+    __kmpc_end_reduce(&dummy_loc, gtid, &crit);
+    break;
+  case 2:
+#pragma omp atomic
+    *sum += local;
+    __kmpc_end_reduce(&dummy_loc, gtid, &crit);
+    break;
+  }
+}
+
+static int errors = 0;
+
+static void error(const char *what, int nt, long got, long expected) {
+#pragma omp critical
+  {
+    if (errors++ < 10)
+      fprintf(stderr, "%d threads, %s: %ld, expected %ld\n", nt, what, got,
+              expected);
+  }
+}
+
+static void test_barrier(int nt) {
+  int arrived[3] = {0, 0, 0};
+#pragma omp parallel num_threads(nt)
+  {
+    int i;
+    for (i = 0; i < ITERS; i++) {
+      int a;
+#pragma omp atomic
+      arrived[i % 3]++;
+#pragma omp barrier
+#pragma omp atomic read
+      a = arrived[i % 3];
+      if (a != nt * (i / 3 + 1))
+        error("barrier", nt, a, nt * (i / 3 + 1));
+    }
+  }
+}
+
+static void test_tasks(int nt) {
+  int executed = 0;
+#pragma omp parallel num_threads(nt)
+  {
+    int i, t;
+    for (i = 0; i < ITERS / 10; i++) {
+      for (t = 0; t < 4; t++) {
+#pragma omp task
+        {
+#pragma omp atomic
+          executed++;
+        }
+      }
+#pragma omp barrier
+      // tasks are complete at the barrier
+      if (executed < nt * 4 * (i + 1))
+        error("tasks", nt, executed, nt * 4 * (i + 1));
+#pragma omp barrier
+    }
+  }
+}
+
+static void test_reduction(int nt) {
+#pragma omp parallel num_threads(nt)
+  {
+    int i;
+    for (i = 0; i < ITERS / 10; i++) {
+      static long sum;
+#pragma omp single
+      sum = 0;
+      reduce(&sum, omp_get_thread_num() + 1);
+#pragma omp barrier
+      if (sum != (long)nt * (nt + 1) / 2)
+        error("reduction", nt, sum, (long)nt * (nt + 1) / 2);
+#pragma omp barrier
+    }
+  }
+}
+
+static void test_forkjoin(int nt) {
+  int i;
+  for (i = 0; i < ITERS / 10; i++) {
+    int count = 0, size = i % 2 ? nt : (nt + 1) / 2;
+#pragma omp parallel num_threads(size)
+    {
+#pragma omp atomic
+      count++;
+    }
+    if (count != size)
+      error("fork/join", size, count, size);
+  }
+}
+
+static void test_nested(int nt) {
+  int count = 0;
+#pragma omp parallel num_threads(2)
+  {
+#pragma omp parallel num_threads(nt)
+    {
+      int i;
+      for (i = 0; i < ITERS / 10; i++) {
+#pragma omp barrier
+      }
+#pragma omp atomic
+      count++;
+    }
+#pragma omp barrier
+  }
+  if (count != 2 * nt)
+    error("nested", nt, count, 2 * nt);
+}
+
+static void bench(const char *name, int nt) {
+  double t_bar, t_red, t_par;
+  long sum = 0;
+  int i;
+#pragma omp parallel num_threads(nt)
+  {
+    double start;
+#pragma omp barrier
+    start = omp_get_wtime();
+    for (int j = 0; j < BENCH_ITERS; j++) {
+#pragma omp barrier
+    }
+#pragma omp master
+    t_bar = omp_get_wtime() - start;
+#pragma omp barrier
+    start = omp_get_wtime();
+    for (int j = 0; j < BENCH_ITERS; j++)
+      reduce(&sum, 1);
+#pragma omp master
+    t_red = omp_get_wtime() - start;
+  }
+  t_par = omp_get_wtime();
+  for (i = 0; i < BENCH_ITERS / 10; i++) {
+#pragma omp parallel num_threads(nt)
+    {
+      // keeps the compiler from eliding the region
+      if (omp_get_thread_num() < 0)
+        printf("unexpected thread number\n");
+    }
+  }
+  t_par = omp_get_wtime() - t_par;
+  printf("%-14s %4d threads: barrier %8.3f us, reduction %8.3f us, "
+         "parallel %8.3f us\n",
+         name, nt, t_bar * 1e6 / BENCH_ITERS, t_red * 1e6 / BENCH_ITERS,
+         t_par * 1e7 / BENCH_ITERS);
+}
+
+int main(int argc, char **argv) {
+  static const int sizes[] = {1, 2, 3, 4, 5, 7, 8, 13, 16};
+  unsigned i;
+
+  omp_set_dynamic(0);
+  omp_set_max_active_levels(2);
+
+  if (argc > 1) {
+    int nt, nprocs = argc > 2 ? atoi(argv[2]) : omp_get_num_procs();
+    for (nt = 1; nt <= nprocs; nt = nt < 4 ? nt + 1 : nt * 2)
+      bench(argv[1], nt);
+    return 0;
+  }
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    test_barrier(sizes[i]);
+    test_tasks(sizes[i]);
+    test_reduction(sizes[i]);
+    test_forkjoin(sizes[i]);
+    if (sizes[i] <= 4)
+      test_nested(sizes[i]);
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,108 @@
+// RUN: %libomp-compile-and-run
+// RUN: %libomp-compile && env KMP_PLAIN_BARRIER=0,0 %libomp-run
+// RUN: %libomp-compile && env KMP_BLOCKTIME=0 \
+// RUN:   KMP_PLAIN_BARRIER_PATTERN=dissemination,dissemination %libomp-run
+// RUN: %libomp-compile && env KMP_PLAIN_BARRIER_PATTERN=auto %libomp-run
+// RUN: %libomp-compile && env KMP_PLAIN_BARRIER_PATTERN=hierarchical \
+// RUN:   %libomp-run
+
+// Test the kmp_barrier_arrive/kmp_barrier_wait split barrier: the data
+// written before the arrival of every thread is visible after the wait, tasks
+// created between the two calls are complete after the wait, and a thread that
+// has arrived goes on without waiting for the other threads.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define ITERS 1000
+#define NT 4
+
+static int errors = 0;
+
+static void error(const char *what, int iter, int got, int expected) {
+#pragma omp critical
+  {
+    if (errors++ < 10)
+      fprintf(stderr, "iteration %d, %s: %d, expected %d\n", iter, what, got,
+              expected);
+  }
+}
+
+static void test_data(void) {
+  static int data[2][NT];
+  int tasks = 0;
+#pragma omp parallel num_threads(NT)
+  {
+    int tid = omp_get_thread_num(), nt = omp_get_num_threads();
+    int i, t, sum;
+    for (i = 0; i < ITERS; i++) {
+      data[i % 2][tid] = i + tid;
+      kmp_barrier_arrive();
+      // independent work, including tasks the barrier completes
+      if (i % 10 == 0) {
+#pragma omp task
+        {
+#pragma omp atomic
+          tasks++;
+        }
+      }
+      kmp_barrier_wait();
+      for (t = 0, sum = 0; t < nt; t++)
+        sum += data[i % 2][t] - i - t;
+      if (sum != 0)
+        error("data", i, sum, 0);
+      if (i % 10 == 0) {
+        int done;
+#pragma omp atomic read
+        done = tasks;
+        if (done != nt * (i / 10 + 1))
+          error("tasks", i, done, nt * (i / 10 + 1));
+      }
+    }
+  }
+}
+
+// The thread that arrives first lets the other one go on, which could not
+// happen if the arrival waited for it
+static void test_no_wait(int first) {
+  int go = 0;
+#pragma omp parallel num_threads(2)
+  {
+    int i, g;
+    for (i = 0; i < 10; i++) {
+      if (omp_get_thread_num() == first) {
+        kmp_barrier_arrive();
+#pragma omp atomic write
+        go = i + 1;
+      } else {
+        do {
+#pragma omp atomic read
+          g = go;
+        } while (g != i + 1);
+        kmp_barrier_arrive();
+      }
+      kmp_barrier_wait();
+    }
+  }
+}
+
+int main() {
+  omp_set_dynamic(0);
+
+  // outside of a parallel region and as a full barrier
+  kmp_barrier_arrive();
+  kmp_barrier_wait();
+#pragma omp parallel num_threads(NT)
+  kmp_barrier_wait();
+
+  test_data();
+  test_no_wait(0);
+  test_no_wait(1);
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
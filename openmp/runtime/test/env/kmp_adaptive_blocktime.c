@@ -0,0 +1,77 @@
+// RUN: %libomp-compile && env KMP_ADAPTIVE_BLOCKTIME=1 KMP_BLOCKTIME=50 \
+// RUN:   %libomp-run
+// RUN: %libomp-compile && env KMP_ADAPTIVE_BLOCKTIME=1 KMP_BLOCKTIME=0 \
+// RUN:   %libomp-run
+// RUN: %libomp-compile && env KMP_ADAPTIVE_BLOCKTIME=1 KMP_BLOCKTIME=50 \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=linear,linear %libomp-run
+// REQUIRES: linux
+
+// Test KMP_ADAPTIVE_BLOCKTIME: after a few long gaps between parallel regions
+// the idle threads suspend without spinning through the blocktime, and they
+// still go back to spinning when the regions come back to back.
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+#define NT 4
+#define GAPS 10
+
+static double cpu_time(void) {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+         1e-6 * (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec);
+}
+
+static int region(void) {
+  int count = 0;
+#pragma omp parallel num_threads(NT)
+  {
+#pragma omp atomic
+    count++;
+  }
+  return count != NT;
+}
+
+int main() {
+  int i, errors = 0;
+  double cpu;
+
+  omp_set_dynamic(0);
+
+  // learn the long gaps
+  for (i = 0; i < 5; i++) {
+    errors += region();
+    my_sleep(0.1);
+  }
+  // the workers would spin through 50 ms in each gap without the prediction
+  cpu = cpu_time();
+  for (i = 0; i < GAPS; i++) {
+    errors += region();
+    my_sleep(0.1);
+  }
+  cpu = cpu_time() - cpu;
+  if (cpu > GAPS * 0.05 / 2) {
+    fprintf(stderr, "%.3f s of CPU time in %d gaps\n", cpu, GAPS);
+    errors++;
+  }
+
+  // back to back regions and barriers
+  for (i = 0; i < 1000; i++)
+    errors += region();
+#pragma omp parallel num_threads(NT)
+  {
+    for (int j = 0; j < 1000; j++) {
+#pragma omp barrier
+    }
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
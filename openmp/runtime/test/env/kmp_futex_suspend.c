@@ -0,0 +1,72 @@
+// RUN: %libomp-compile && env KMP_FUTEX_SUSPEND=1 KMP_BLOCKTIME=0 %libomp-run
+// RUN: %libomp-compile && env KMP_FUTEX_SUSPEND=1 KMP_BLOCKTIME=1 %libomp-run
+// RUN: %libomp-compile && env KMP_FUTEX_SUSPEND=1 KMP_BLOCKTIME=0 \
+// RUN:   KMP_PLAIN_BARRIER_PATTERN=linear,linear \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=linear,linear %libomp-run
+// REQUIRES: linux
+
+// Test the suspension of threads on a futex: threads that go to sleep at
+// barriers, at the fork/join barrier, in the thread pool and while waiting for
+// tasks are woken up again.
+
+#include <stdio.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+#define NT 4
+#define ITERS 200
+
+int main() {
+  int i, errors = 0, count = 0, tasks = 0;
+
+  omp_set_dynamic(0);
+  for (i = 0; i < ITERS; i++) {
+    int size = i % 2 ? NT : NT / 2;
+#pragma omp parallel num_threads(size)
+    {
+#pragma omp atomic
+      count++;
+#pragma omp barrier
+#pragma omp single
+      {
+#pragma omp task
+        {
+#pragma omp atomic
+          tasks++;
+        }
+      }
+    }
+    // let the workers go to sleep in the pool, every so often
+    if (i % 50 == 0)
+      my_sleep(0.01);
+  }
+  if (count != ITERS / 2 * (NT + NT / 2) || tasks != ITERS) {
+    fprintf(stderr, "count %d, tasks %d\n", count, tasks);
+    errors++;
+  }
+
+  // workers sleep at the barrier while the primary thread is busy
+  count = 0;
+#pragma omp parallel num_threads(NT)
+  {
+    for (int j = 0; j < 10; j++) {
+#pragma omp master
+      my_sleep(0.005);
+#pragma omp barrier
+#pragma omp atomic
+      count++;
+#pragma omp barrier
+    }
+  }
+  if (count != 10 * NT) {
+    fprintf(stderr, "barrier count %d\n", count);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,170 @@
+// RUN: %libomp-compile && env KMP_POOL_THREAD_TIMEOUT=50 %libomp-run
+// RUN: %libomp-compile && env KMP_POOL_THREAD_TIMEOUT=50 \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=linear,linear %libomp-run
+// RUN: %libomp-compile && env KMP_POOL_THREAD_TIMEOUT=50 \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=dist,dist %libomp-run
+// RUN: %libomp-compile && env KMP_POOL_THREAD_TIMEOUT=50 \
+// RUN:   KMP_TASK_ALLOC_CACHE=1 %libomp-run
+// RUN: %libomp-compile && env KMP_POOL_THREAD_TIMEOUT=50 \
+// RUN:   KMP_HOT_TEAMS_MAX_LEVEL=2 %libomp-run
+// RUN: %libomp-compile && env KMP_POOL_THREAD_TIMEOUT=50 \
+// RUN:   KMP_HOT_TEAMS_MAX_LEVEL=2 KMP_HOT_TEAMS_MAX_THREADS=8 %libomp-run
+// REQUIRES: linux
+
+// Test KMP_POOL_THREAD_TIMEOUT: the threads left in the thread pool after a
+// large parallel region exit once they have been idle for the timeout, and
+// new threads are created when a large parallel region runs again. Tasks
+// created by a reaped thread and freed by other threads are given back safely,
+// and the workers of the nested hot teams of a reaped thread exit with it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <omp.h>
+
+#define BIG 8
+#define SMALL 2
+#define OUTER 4
+#define INNER 2
+#define NTASKS 100
+#define ITERS 3
+
+// Number of OS threads of the process
+static int num_os_threads(void) {
+  char line[256];
+  int n = -1;
+  FILE *f = fopen("/proc/self/status", "r");
+  if (!f)
+    return -1;
+  while (fgets(line, sizeof(line), f))
+    if (strncmp(line, "Threads:", 8) == 0)
+      sscanf(line + 8, "%d", &n);
+  fclose(f);
+  return n;
+}
+
+static int run(int nthreads) {
+  int count = 0;
+#pragma omp parallel num_threads(nthreads) shared(count)
+  {
+#pragma omp atomic
+    count++;
+  }
+  return count;
+}
+
+// The workers create tasks and wait until they have run, so that the primary
+// thread runs and frees them in the barrier
+static int run_tasks(int nthreads) {
+  int done = 0;
+#pragma omp parallel num_threads(nthreads) shared(done)
+  {
+    if (omp_get_thread_num() != 0) {
+      int i, d;
+      for (i = 0; i < NTASKS; i++) {
+#pragma omp task shared(done)
+        {
+#pragma omp atomic
+          done++;
+        }
+      }
+      do {
+        sched_yield();
+#pragma omp atomic read
+        d = done;
+      } while (d < (nthreads - 1) * NTASKS);
+    }
+#pragma omp barrier
+  }
+  return done == (nthreads - 1) * NTASKS;
+}
+
+static int run_nested(void) {
+  int count = 0;
+#pragma omp parallel num_threads(OUTER) shared(count)
+#pragma omp parallel num_threads(INNER) shared(count)
+  {
+#pragma omp atomic
+    count++;
+  }
+  return count;
+}
+
+// Wait for the idle pool threads to time out, let the next fork reap them and
+// check the number of threads left
+static int check_reaped(const char *what, int i, int expected) {
+  int n;
+  usleep(200000);
+  run(SMALL);
+  n = num_os_threads();
+  if (n != expected) {
+    fprintf(stderr, "%s %d: %d threads after the timeout, expected %d\n", what,
+            i, n, expected);
+    return 1;
+  }
+  return 0;
+}
+
+int main() {
+  int i, n, errors = 0;
+  const char *max_level = getenv("KMP_HOT_TEAMS_MAX_LEVEL");
+  int nested_hot = max_level && atoi(max_level) > 1;
+
+  omp_set_dynamic(0);
+  omp_set_max_active_levels(2);
+  for (i = 0; i < ITERS; i++) {
+    if (run(BIG) != BIG) {
+      fprintf(stderr, "iteration %d: large region failed\n", i);
+      errors++;
+    }
+    // The hot team shrinks and its extra threads go to the thread pool
+    if (run(SMALL) != SMALL) {
+      fprintf(stderr, "iteration %d: small region failed\n", i);
+      errors++;
+    }
+    n = num_os_threads();
+    if (n < BIG) {
+      fprintf(stderr, "iteration %d: %d threads before the timeout\n", i, n);
+      errors++;
+    }
+    errors += check_reaped("iteration", i, SMALL);
+
+    // Task descriptors of the reaped threads were freed by the primary thread
+    if (!run_tasks(BIG)) {
+      fprintf(stderr, "tasks %d: large region failed\n", i);
+      errors++;
+    }
+    run(SMALL);
+    errors += check_reaped("tasks", i, SMALL);
+    if (!run_tasks(SMALL)) {
+      fprintf(stderr, "tasks %d: small region failed\n", i);
+      errors++;
+    }
+  }
+
+  for (i = 0; i < ITERS; i++) {
+    if (run_nested() != OUTER * INNER) {
+      fprintf(stderr, "nested %d: nested region failed\n", i);
+      errors++;
+    }
+    run(SMALL);
+    // The workers of inner teams that are not hot may have been reused by
+    // another inner team
+    n = num_os_threads();
+    if (n < (nested_hot ? OUTER * INNER : OUTER)) {
+      fprintf(stderr, "nested %d: %d threads before the timeout\n", i, n);
+      errors++;
+    }
+    // The primary threads of nested hot teams left keep their workers
+    errors += check_reaped("nested", i, nested_hot ? SMALL * INNER : SMALL);
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,83 @@
+// RUN: %libomp-compile && env OMP_DYNAMIC=true KMP_DYNAMIC_MODE=budget \
+// RUN:   KMP_THREAD_BUDGET=4 %libomp-run
+// RUN: %libomp-compile && env OMP_DYNAMIC=true KMP_DYNAMIC_MODE=thread_budget \
+// RUN:   KMP_THREAD_BUDGET=4 KMP_HOT_TEAMS_FAST_FORK=1 %libomp-run
+// RUN: %libomp-compile && env OMP_DYNAMIC=true KMP_DYNAMIC_MODE=budget \
+// RUN:   KMP_THREAD_BUDGET=4 KMP_HOT_TEAMS_MAX_LEVEL=2 %libomp-run
+
+// Test KMP_DYNAMIC_MODE=thread_budget: several root threads and nested
+// parallel regions never have more threads in active parallel regions than
+// KMP_THREAD_BUDGET, and kmp_get_thread_budget_used() reports the threads in
+// use.
+
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+#define BUDGET 4
+#define NROOTS 4
+#define REGIONS 200
+
+static int errors = 0;
+
+static void error(const char *what, int got) {
+#pragma omp critical
+  {
+    if (errors++ < 10)
+      fprintf(stderr, "%s: %d\n", what, got);
+  }
+}
+
+static void check_used(void) {
+  int used = kmp_get_thread_budget_used();
+  if (used < omp_get_num_threads() || used > BUDGET)
+    error("threads in use", used);
+}
+
+static void *root_function(void *arg) {
+  int i;
+  for (i = 0; i < REGIONS; i++) {
+#pragma omp parallel num_threads(BUDGET)
+    check_used();
+  }
+  return NULL;
+}
+
+int main() {
+  pthread_t thread[NROOTS];
+  int i;
+
+  // A single root gets the whole budget.
+#pragma omp parallel num_threads(BUDGET)
+  {
+    if (omp_get_num_threads() != BUDGET)
+      error("num_threads", omp_get_num_threads());
+    check_used();
+  }
+  if (kmp_get_thread_budget_used() != 0)
+    error("threads in use after join", kmp_get_thread_budget_used());
+
+  // Nested teams share the budget with their enclosing team.
+  omp_set_max_active_levels(2);
+#pragma omp parallel num_threads(2)
+  {
+#pragma omp parallel num_threads(BUDGET)
+    check_used();
+  }
+  if (kmp_get_thread_budget_used() != 0)
+    error("threads in use after nested join", kmp_get_thread_budget_used());
+
+  // Root threads running parallel regions at the same time share the budget.
+  for (i = 0; i < NROOTS; i++)
+    pthread_create(&thread[i], NULL, root_function, NULL);
+  for (i = 0; i < NROOTS; i++)
+    pthread_join(thread[i], NULL);
+  if (kmp_get_thread_budget_used() != 0)
+    error("threads in use after roots", kmp_get_thread_budget_used());
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,120 @@
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_FAST_FORK=1 %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_FAST_FORK=1 KMP_BLOCKTIME=0 \
+// RUN:   %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_FAST_FORK=1 \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=linear,linear KMP_HOT_TEAMS_MAX_LEVEL=0 \
+// RUN:   %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_FAST_FORK=1 \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=dist,dist %libomp-run
+
+// Test the fork of the hot team through the KMP_HOT_TEAMS_FAST_FORK path: the
+// arguments, the team size and the ICVs seen inside back to back parallel
+// regions stay right when the number of threads, the ICVs or the nesting
+// change between them. kmp_hot_team_fast_fork_trace.c checks that the path is
+// taken at all.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define NT 4
+#define ITERS 1000
+
+static int errors = 0;
+
+static void error(const char *what, int iter, int got, int expected) {
+#pragma omp critical
+  {
+    if (errors++ < 10)
+      fprintf(stderr, "iteration %d, %s: %d, expected %d\n", iter, what, got,
+              expected);
+  }
+}
+
+// one region, checking everything the fork sets up
+static void region(int iter, int nt, omp_sched_t kind, int chunk) {
+  int a = iter, b = 2 * iter, count = 0, tasks = 0, level = -1;
+#pragma omp parallel shared(a, b, count, tasks)
+  {
+    omp_sched_t k;
+    int c;
+    if (a != iter || b != 2 * iter)
+      error("arguments", iter, a, iter);
+    if (omp_get_num_threads() != nt)
+      error("num_threads", iter, omp_get_num_threads(), nt);
+    omp_get_schedule(&k, &c);
+    if (k != kind || c != chunk)
+      error("schedule", iter, c, chunk);
+#pragma omp atomic
+    count++;
+#pragma omp master
+    level = omp_get_level();
+    // ICVs changed by a worker inside must not leak into the next region
+    if (omp_get_thread_num() == 1)
+      omp_set_num_threads(1);
+#pragma omp single
+    {
+#pragma omp task
+      {
+#pragma omp atomic
+        tasks++;
+      }
+    }
+  }
+  if (count != nt)
+    error("count", iter, count, nt);
+  if (tasks != 1)
+    error("tasks", iter, tasks, 1);
+  if (level != 1)
+    error("level", iter, level, 1);
+}
+
+int main() {
+  int i;
+
+  omp_set_dynamic(0);
+  omp_set_num_threads(NT);
+  for (i = 0; i < ITERS; i++)
+    region(i, NT, omp_sched_static, 0);
+
+  for (i = 0; i < ITERS; i++) {
+    int nt = 2 + i % 3;
+    if (i % 10 == 0)
+      omp_set_num_threads(nt);
+    else
+      nt = 2 + (i - i % 10) % 3;
+    if (i % 7 == 0)
+      omp_set_schedule(omp_sched_dynamic, i % 5 + 1);
+    {
+      omp_sched_t k;
+      int c;
+      omp_get_schedule(&k, &c);
+      region(i, nt, k, c);
+    }
+  }
+
+  // num_threads clause and nesting
+  omp_set_num_threads(NT);
+  omp_set_schedule(omp_sched_static, 0);
+  omp_set_max_active_levels(2);
+  for (i = 0; i < ITERS / 10; i++) {
+    int count = 0;
+#pragma omp parallel num_threads(2 + i % 2)
+    {
+#pragma omp parallel num_threads(2)
+      {
+#pragma omp atomic
+        count++;
+      }
+    }
+    if (count != 2 * (2 + i % 2))
+      error("nested", i, count, 2 * (2 + i % 2));
+    region(i, NT, omp_sched_static, 0);
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
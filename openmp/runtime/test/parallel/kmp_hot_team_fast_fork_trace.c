@@ -0,0 +1,41 @@
+// RUN: %libomp-compile
+// RUN: env KMP_HOT_TEAMS_FAST_FORK=1 KMP_A_DEBUG=20 %libomp-run 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: env KMP_A_DEBUG=20 %libomp-run 2>&1 | FileCheck --check-prefix=OFF %s
+// REQUIRES: kmp-debug
+
+// Test that back to back parallel regions reusing the hot team take the
+// KMP_HOT_TEAMS_FAST_FORK path, and only when it is enabled: the debug trace
+// of the library shows the forks of the hot team it did.
+
+// CHECK: __kmp_fork_hot_team: T#0 reusing hot team
+// CHECK: passed
+// OFF-NOT: __kmp_fork_hot_team
+// OFF: passed
+
+#include <stdio.h>
+#include <omp.h>
+
+#define NT 4
+#define ITERS 10
+
+int main() {
+  int i, count = 0;
+
+  omp_set_dynamic(0);
+  omp_set_num_threads(NT);
+  for (i = 0; i < ITERS; i++) {
+#pragma omp parallel shared(count)
+    {
+#pragma omp atomic
+      count++;
+    }
+  }
+
+  if (count != NT * ITERS) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
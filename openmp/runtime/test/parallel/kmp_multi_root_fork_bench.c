@@ -0,0 +1,81 @@
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_FAST_FORK=1 %libomp-run
+// RUN: %libomp-compile && %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_FAST_FORK=1 \
+// RUN:   KMP_FORKJOIN_BARRIER_PATTERN=linear,linear %libomp-run
+
+// Benchmark for fork/join with many root threads: measures the rate at which
+// independent application threads, each the root of its own OpenMP teams, run
+// back to back parallel regions as the number of roots grows, and checks that
+// every region ran with the whole team.
+
+#include <stdio.h>
+#include "omp_testsuite.h"
+
+#define MAX_ROOTS 8
+#define NT 2
+#define REGIONS 2000
+
+typedef struct root_arg_t {
+  int count;
+  int errors;
+} root_arg_t;
+
+static void *root_function(void *arg) {
+  root_arg_t *targ = (root_arg_t *)arg;
+  int i;
+
+  omp_set_dynamic(0);
+  for (i = 0; i < REGIONS; i++) {
+    int count = 0;
+#pragma omp parallel num_threads(NT) shared(count)
+    {
+#pragma omp atomic
+      count++;
+    }
+    if (count != NT)
+      targ->errors++;
+    targ->count += count;
+  }
+  return NULL;
+}
+
+static int run(int nroots, double *rate) {
+  pthread_t thread[MAX_ROOTS];
+  root_arg_t arg[MAX_ROOTS];
+  int i, errors = 0;
+  double t;
+
+  t = omp_get_wtime();
+  for (i = 0; i < nroots; i++) {
+    arg[i].count = arg[i].errors = 0;
+    pthread_create(&thread[i], NULL, root_function, &arg[i]);
+  }
+  for (i = 0; i < nroots; i++) {
+    pthread_join(thread[i], NULL);
+    if (arg[i].errors || arg[i].count != NT * REGIONS) {
+      fprintf(stderr, "root %d of %d: %d regions failed, count %d\n", i,
+              nroots, arg[i].errors, arg[i].count);
+      errors++;
+    }
+  }
+  t = omp_get_wtime() - t;
+  *rate = (double)nroots * REGIONS / t;
+  return errors;
+}
+
+int main() {
+  int nroots, errors = 0;
+  double rate;
+
+  for (nroots = 1; nroots <= MAX_ROOTS; nroots *= 2) {
+    errors += run(nroots, &rate);
+    printf("%d roots: %.0f parallel regions/s\n", nroots, rate);
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,88 @@
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_MAX_LEVEL=3 \
+// RUN:   KMP_HOT_TEAMS_MAX_THREADS=4 %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_MAX_LEVEL=3 \
+// RUN:   KMP_HOT_TEAMS_MAX_THREADS=1 KMP_HOT_TEAMS_MODE=1 %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_MAX_LEVEL=3 \
+// RUN:   KMP_HOT_TEAMS_MAX_THREADS=100 %libomp-run
+// RUN: %libomp-compile && env KMP_HOT_TEAMS_MAX_LEVEL=3 \
+// RUN:   KMP_HOT_TEAMS_MAX_THREADS=3 KMP_FORKJOIN_BARRIER_PATTERN=dist,dist \
+// RUN:   %libomp-run
+
+// Test the nested hot teams kept under KMP_HOT_TEAMS_MAX_THREADS: three levels
+// of nested parallel regions of changing sizes, with tasks, still get the
+// right teams while the least recently used nested hot teams are evicted.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define ITERS 50
+
+static int errors = 0;
+
+static void error(const char *what, int iter, int got, int expected) {
+#pragma omp critical
+  {
+    if (errors++ < 10)
+      fprintf(stderr, "iteration %d, %s: %d, expected %d\n", iter, what, got,
+              expected);
+  }
+}
+
+int main() {
+  int i;
+
+  omp_set_dynamic(0);
+  omp_set_max_active_levels(3);
+  for (i = 0; i < ITERS; i++) {
+    int n1 = 2, n2 = 2 + i % 2, n3 = 2 + i / 2 % 2;
+    int count = 0, tasks = 0;
+#pragma omp parallel num_threads(n1) shared(count, tasks)
+    {
+#pragma omp parallel num_threads(n2) shared(count, tasks)
+      {
+        if (omp_get_num_threads() != n2)
+          error("level 2 num_threads", i, omp_get_num_threads(), n2);
+#pragma omp parallel num_threads(n3) shared(count, tasks)
+        {
+          if (omp_get_level() != 3)
+            error("level", i, omp_get_level(), 3);
+          if (omp_get_num_threads() != n3)
+            error("level 3 num_threads", i, omp_get_num_threads(), n3);
+#pragma omp atomic
+          count++;
+#pragma omp single
+          {
+#pragma omp task
+            {
+#pragma omp atomic
+              tasks++;
+            }
+          }
+        }
+      }
+    }
+    if (count != n1 * n2 * n3)
+      error("count", i, count, n1 * n2 * n3);
+    if (tasks != n1 * n2)
+      error("tasks", i, tasks, n1 * n2);
+    // a single nested level in between
+    count = 0;
+#pragma omp parallel num_threads(3) shared(count)
+    {
+#pragma omp parallel num_threads(2) shared(count)
+      {
+#pragma omp atomic
+        count++;
+      }
+    }
+    if (count != 6)
+      error("count 2 levels", i, count, 6);
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,118 @@
+// RUN: %libomp-compile && env KMP_TASK_AFFINITY=1 %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_AFFINITY=1 KMP_TASK_STEAL_HIER=2 \
+// RUN:   OMP_PLACES=cores OMP_PROC_BIND=spread %libomp-run
+
+// Test the affinity clause: tasks placed near their data according to its
+// NUMA node are all executed exactly once, whichever thread they were
+// queued on. Emulates compiler codegen of
+//   #pragma omp task affinity(data[b * BLOCK : BLOCK])
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define NUM_BLOCKS 256
+#define BLOCK 4096
+
+typedef struct ident {
+  void *dummy;
+} ident_t;
+
+typedef struct kmp_task_affinity_info {
+  long long base_addr;
+  size_t len;
+  struct {
+    unsigned char flag1 : 1;
+    unsigned char flag2 : 1;
+    int reserved : 30;
+  } flags;
+} kmp_task_affinity_info_t;
+
+typedef struct task {
+  void *shareds;
+  int (*routine)(int, struct task *);
+  int part_id;
+  // privates:
+  int block;
+} kmp_task_t;
+
+typedef int (*task_entry_t)(int, kmp_task_t *);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern int __kmpc_global_thread_num(ident_t *);
+extern kmp_task_t *__kmpc_omp_task_alloc(ident_t *loc, int gtid, int flags,
+                                         size_t sz, size_t shar,
+                                         task_entry_t rtn);
+extern int __kmpc_omp_reg_task_with_affinity(ident_t *loc, int gtid,
+                                             kmp_task_t *new_task, int naffins,
+                                             kmp_task_affinity_info_t *list);
+extern int __kmpc_omp_task(ident_t *loc, int gtid, kmp_task_t *task);
+#ifdef __cplusplus
+}
+#endif
+
+static double *data;
+static double sums[NUM_BLOCKS];
+static int executed[NUM_BLOCKS];
+
+int block_task(int gtid, kmp_task_t *task) {
+  int b = task->block, i;
+  double sum = 0;
+  for (i = 0; i < BLOCK; i++)
+    sum += data[b * BLOCK + i];
+  sums[b] = sum;
+#pragma omp atomic
+  executed[b]++;
+  return 0;
+}
+
+int main() {
+  int b, i, errors = 0;
+
+  data = (double *)malloc(sizeof(double) * NUM_BLOCKS * BLOCK);
+  // first touch in parallel so the blocks spread over the NUMA nodes
+#pragma omp parallel for schedule(static)
+  for (i = 0; i < NUM_BLOCKS * BLOCK; i++)
+    data[i] = i % BLOCK;
+
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    int gtid = __kmpc_global_thread_num(NULL);
+    for (b = 0; b < NUM_BLOCKS; b++) {
+      kmp_task_affinity_info_t affin;
+      kmp_task_t *task = __kmpc_omp_task_alloc(NULL, gtid, 1,
+                                               sizeof(kmp_task_t), 0,
+                                               &block_task);
+      task->block = b;
+      affin.base_addr = (long long)(data + b * BLOCK);
+      affin.len = sizeof(double) * BLOCK;
+      affin.flags.flag1 = 0;
+      affin.flags.flag2 = 0;
+      affin.flags.reserved = 0;
+      __kmpc_omp_reg_task_with_affinity(NULL, gtid, task, 1, &affin);
+      __kmpc_omp_task(NULL, gtid, task);
+    }
+  }
+
+  for (b = 0; b < NUM_BLOCKS; b++) {
+    if (executed[b] != 1) {
+      fprintf(stderr, "task %d executed %d times\n", b, executed[b]);
+      errors++;
+    }
+    if (sums[b] != (double)BLOCK * (BLOCK - 1) / 2) {
+      fprintf(stderr, "block %d: sum %g\n", b, sums[b]);
+      errors++;
+    }
+  }
+  free(data);
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,127 @@
+// RUN: %libomp-compile && env KMP_TASK_ALLOC_CACHE=1 %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_ALLOC_CACHE=1 \
+// RUN:   KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+
+// Test the task descriptor cache: descriptors of several size classes (and one
+// too large for the cache) allocated by a single producer and freed by the
+// executing threads, descriptors reused across regions, and taskloop task
+// duplication. Foreign root threads exit while their former workers may still
+// hold batches of their descriptors, and the workers go on with other roots.
+
+#include <stdio.h>
+#include <string.h>
+#include "omp_testsuite.h"
+
+#define N_TASKS 5000
+#define NUM_ITERS 4
+#define BIG 2048
+#define NUM_ROOTS 4
+
+typedef struct {
+  char data[BIG];
+} big_t;
+
+// Tasks of a foreign root thread, executed and freed by its workers
+static void *foreign_root(void *arg) {
+  int *count = (int *)arg;
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    int k;
+    for (k = 0; k < N_TASKS / 10; k++) {
+#pragma omp task
+      {
+#pragma omp atomic
+        (*count)++;
+      }
+    }
+  }
+  return NULL;
+}
+
+int main() {
+  int i, iter, errors = 0;
+  int root_count = 0;
+  int count = 0, big_count = 0, loop_count = 0;
+  static int executed[N_TASKS];
+
+  for (iter = 0; iter < NUM_ITERS; iter++) {
+    memset(executed, 0, sizeof(executed));
+#pragma omp parallel num_threads(4)
+#pragma omp single
+    {
+      for (i = 0; i < N_TASKS; i++) {
+        // firstprivate data of different sizes lands in different classes
+        char pad[64 * (1 + i % 8)];
+        big_t big;
+        pad[0] = (char)i;
+        pad[sizeof(pad) - 1] = (char)i;
+        if (i % 50 == 0) {
+          big.data[0] = big.data[BIG - 1] = (char)i;
+#pragma omp task firstprivate(i, big)
+          {
+            if (big.data[0] == (char)i && big.data[BIG - 1] == (char)i) {
+#pragma omp atomic
+              big_count++;
+            }
+          }
+        }
+#pragma omp task firstprivate(i, pad)
+        {
+          if (pad[0] == (char)i && pad[sizeof(pad) - 1] == (char)i) {
+#pragma omp atomic
+            executed[i]++;
+#pragma omp atomic
+            count++;
+          }
+        }
+      }
+#pragma omp taskloop grainsize(1)
+      for (i = 0; i < 100; i++) {
+#pragma omp atomic
+        loop_count++;
+      }
+    }
+    for (i = 0; i < N_TASKS; i++) {
+      if (executed[i] != 1) {
+        fprintf(stderr, "task %d executed %d times\n", i, executed[i]);
+        errors++;
+      }
+    }
+  }
+
+  // each root exits before the next one takes over the thread pool
+  for (i = 0; i < NUM_ROOTS; i++) {
+    pthread_t root;
+    pthread_create(&root, NULL, foreign_root, &root_count);
+    pthread_join(root, NULL);
+  }
+  if (root_count != N_TASKS / 10 * NUM_ROOTS) {
+    fprintf(stderr, "executed %d foreign root tasks, expected %d\n",
+            root_count, N_TASKS / 10 * NUM_ROOTS);
+    errors++;
+  }
+
+  if (count != N_TASKS * NUM_ITERS) {
+    fprintf(stderr, "executed %d tasks, expected %d\n", count,
+            N_TASKS * NUM_ITERS);
+    errors++;
+  }
+  if (big_count != N_TASKS / 50 * NUM_ITERS) {
+    fprintf(stderr, "executed %d big tasks, expected %d\n", big_count,
+            N_TASKS / 50 * NUM_ITERS);
+    errors++;
+  }
+  if (loop_count != 100 * NUM_ITERS) {
+    fprintf(stderr, "executed %d iterations, expected %d\n", loop_count,
+            100 * NUM_ITERS);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,74 @@
+// RUN: %libomp-compile && env KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_DEQUE_LOCKFREE=1 \
+// RUN:   KMP_ENABLE_TASK_THROTTLING=0 %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_DEQUE_LOCKFREE=1 \
+// RUN:   KMP_TASK_STEALING_CONSTRAINT=0 %libomp-run
+
+// Test the lock-free task deque: owner push/pop, stealing, deque growth
+// (with throttling disabled) and the tied task scheduling constraint.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define NUM_TASKS 10000
+#define FIB_N 22
+
+static int fib(int n) {
+  int x, y;
+  if (n < 2)
+    return n;
+#pragma omp task shared(x)
+  x = fib(n - 1);
+#pragma omp task shared(y)
+  y = fib(n - 2);
+#pragma omp taskwait
+  return x + y;
+}
+
+int main() {
+  int i, errors = 0;
+  int count = 0, result = 0;
+  int executed[NUM_TASKS] = {0};
+
+  // One producer fans out many tasks: exercises growth and stealing
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    for (i = 0; i < NUM_TASKS; i++) {
+#pragma omp task firstprivate(i)
+      {
+#pragma omp atomic
+        executed[i]++;
+#pragma omp atomic
+        count++;
+      }
+    }
+  }
+  for (i = 0; i < NUM_TASKS; i++) {
+    if (executed[i] != 1) {
+      fprintf(stderr, "task %d executed %d times\n", i, executed[i]);
+      errors++;
+    }
+  }
+  if (count != NUM_TASKS) {
+    fprintf(stderr, "executed %d tasks, expected %d\n", count, NUM_TASKS);
+    errors++;
+  }
+
+  // Nested tied tasks with taskwait: exercises owner pops racing with thieves
+  // under the task scheduling constraint
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  result = fib(FIB_N);
+  if (result != 17711) {
+    fprintf(stderr, "fib(%d) = %d, expected 17711\n", FIB_N, result);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
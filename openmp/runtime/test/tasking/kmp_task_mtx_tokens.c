@@ -0,0 +1,113 @@
+// RUN: %libomp-compile && env KMP_TASK_MTX_TOKENS=1 %libomp-run
+// UNSUPPORTED: gcc-4, gcc-5, gcc-6, gcc-7, gcc-8
+// UNSUPPORTED: clang-3, clang-4, clang-5, clang-6, clang-7, clang-8
+
+// Test mutexinoutset sets scheduled through ownership tokens: tasks in several
+// overlapping sets never run together with another task of one of their sets,
+// tasks that wait for a token are handed over by the owner, and inout
+// dependences on the same variables still order the tasks.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define NUM_SETS 6
+#define NUM_TASKS 2000
+#define NUM_ROUNDS 4
+
+static int sets[NUM_SETS];
+static int in_use[NUM_SETS];
+static int errors = 0;
+static int executed = 0;
+
+static void enter(int s) {
+  int n;
+#pragma omp atomic capture
+  n = ++in_use[s];
+  if (n != 1) {
+#pragma omp atomic
+    errors++;
+  }
+}
+
+static void leave(int s) {
+#pragma omp atomic
+  in_use[s]--;
+}
+
+static void work(int a, int b, int c) {
+  int i;
+  volatile int x = 0;
+  enter(a);
+  if (b != a)
+    enter(b);
+  if (c != a && c != b)
+    enter(c);
+  for (i = 0; i < 1000; i++)
+    x += i;
+  sets[a]++;
+  if (b != a)
+    sets[b]++;
+  if (c != a && c != b)
+    sets[c]++;
+  if (c != a && c != b)
+    leave(c);
+  if (b != a)
+    leave(b);
+  leave(a);
+#pragma omp atomic
+  executed++;
+}
+
+int main() {
+  int r, i, s, expected[NUM_SETS] = {0};
+
+  srand(1);
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    for (r = 0; r < NUM_ROUNDS; r++) {
+      for (i = 0; i < NUM_TASKS; i++) {
+        int a = rand() % NUM_SETS;
+        int b = rand() % NUM_SETS;
+        int c = rand() % NUM_SETS;
+        expected[a]++;
+        if (b != a)
+          expected[b]++;
+        if (c != a && c != b)
+          expected[c]++;
+#pragma omp task firstprivate(a, b, c)                                        \
+    depend(mutexinoutset : sets[a], sets[b], sets[c])
+        work(a, b, c);
+      }
+      // orders the round with the next one for the first set
+#pragma omp task depend(inout : sets[0])
+      {
+        if (in_use[0] != 0) {
+#pragma omp atomic
+          errors++;
+        }
+      }
+    }
+  }
+
+  for (s = 0; s < NUM_SETS; s++) {
+    if (sets[s] != expected[s]) {
+      fprintf(stderr, "set %d: %d updates, expected %d\n", s, sets[s],
+              expected[s]);
+      errors++;
+    }
+  }
+  if (executed != NUM_ROUNDS * NUM_TASKS) {
+    fprintf(stderr, "executed %d tasks, expected %d\n", executed,
+            NUM_ROUNDS * NUM_TASKS);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
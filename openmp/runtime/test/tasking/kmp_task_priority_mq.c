@@ -0,0 +1,135 @@
+// RUN: %libomp-compile && env OMP_MAX_TASK_PRIORITY=4 \
+// RUN:   KMP_TASK_PRIORITY_MQ=1 %libomp-run
+// RUN: %libomp-compile && env OMP_MAX_TASK_PRIORITY=4 \
+// RUN:   KMP_TASK_PRIORITY_MQ=1 KMP_ENABLE_TASK_THROTTLING=0 %libomp-run
+
+// Test the per-thread priority task heaps: tasks with priorities above the
+// maximum, heap growth, removal by other threads, nested tied priority
+// tasks with taskwait under the task scheduling constraint, and mutexinoutset
+// tasks of mixed priorities, where the tasks passed over for a better one must
+// not keep their locks.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define NUM_TASKS 20000
+#define NUM_PRIORITIES 8
+#define FIB_N 20
+#define NUM_MTX_TASKS 2000
+#define NUM_MTX 4
+
+static int fib(int n) {
+  int x, y;
+  if (n < 2)
+    return n;
+#pragma omp task shared(x) priority(n % NUM_PRIORITIES)
+  x = fib(n - 1);
+#pragma omp task shared(y) priority((n + 3) % NUM_PRIORITIES)
+  y = fib(n - 2);
+#pragma omp taskwait
+  return x + y;
+}
+
+int main() {
+  int i, errors = 0;
+  int count = 0, result = 0, mtx_count = 0, mtx_errors = 0;
+  static int executed[NUM_TASKS];
+  int mtx[NUM_MTX] = {0}, in_use[NUM_MTX] = {0};
+
+  if (omp_get_max_task_priority() != 4) {
+    printf("failed\n");
+    return 1;
+  }
+
+  // One producer fans out many tasks of mixed priorities
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    for (i = 0; i < NUM_TASKS; i++) {
+#pragma omp task firstprivate(i) priority(i % NUM_PRIORITIES)
+      {
+#pragma omp atomic
+        executed[i]++;
+#pragma omp atomic
+        count++;
+      }
+    }
+  }
+  for (i = 0; i < NUM_TASKS; i++) {
+    if (executed[i] != 1) {
+      fprintf(stderr, "task %d executed %d times\n", i, executed[i]);
+      errors++;
+    }
+  }
+  if (count != NUM_TASKS) {
+    fprintf(stderr, "executed %d tasks, expected %d\n", count, NUM_TASKS);
+    errors++;
+  }
+
+  // Nested producers: tasks are removed from the heaps of other threads
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  result = fib(FIB_N);
+  if (result != 6765) {
+    fprintf(stderr, "fib(%d) = %d, expected 6765\n", FIB_N, result);
+    errors++;
+  }
+
+  // Tasks on different variables run concurrently, the ones on the same
+  // variable one at a time. While the first task holds the lock of mtx[0], the
+  // best tasks in the heaps cannot run and the others are searched.
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    int started = 0;
+#pragma omp task shared(started) depend(mutexinoutset : mtx[0])               \
+    priority(NUM_PRIORITIES - 1)
+    {
+      double start = omp_get_wtime();
+#pragma omp atomic write
+      started = 1;
+      while (omp_get_wtime() - start < 0.1)
+        ;
+#pragma omp atomic
+      mtx_count++;
+    }
+    do {
+#pragma omp atomic read
+      i = started;
+    } while (!i);
+    for (i = 0; i < NUM_MTX_TASKS; i++) {
+      int v = i % NUM_MTX;
+#pragma omp task firstprivate(v) depend(mutexinoutset : mtx[v])               \
+    priority(v == 0 ? NUM_PRIORITIES - 1 : i % NUM_PRIORITIES)
+      {
+        int busy, k;
+        volatile int work = 0;
+#pragma omp atomic capture
+        busy = in_use[v]++;
+        if (busy) {
+#pragma omp atomic
+          mtx_errors++;
+        }
+        for (k = 0; k < 100; k++)
+          work += k;
+        mtx[v]++;
+#pragma omp atomic
+        in_use[v]--;
+#pragma omp atomic
+        mtx_count++;
+      }
+    }
+  }
+  if (mtx_errors || mtx_count != NUM_MTX_TASKS + 1) {
+    fprintf(stderr, "mutexinoutset: %d tasks overlapped, %d executed\n",
+            mtx_errors, mtx_count);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
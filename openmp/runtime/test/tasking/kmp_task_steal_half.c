@@ -0,0 +1,67 @@
+// RUN: %libomp-compile && env KMP_TASK_STEAL_HALF=1 %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_STEAL_HALF=1 \
+// RUN:   KMP_TASK_DEQUE_LOCKFREE=1 %libomp-run
+
+// Test batch (steal-half) stealing: a single producer fans out many tasks
+// which are consumed by the other threads, some of which spawn nested tied
+// tasks so the task scheduling constraint applies to the moved tasks.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define NUM_TASKS 20000
+#define NUM_CHILDREN 4
+
+int main() {
+  int i, errors = 0;
+  int count = 0, children = 0;
+  static int executed[NUM_TASKS];
+
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  {
+    for (i = 0; i < NUM_TASKS; i++) {
+#pragma omp task firstprivate(i)
+      {
+        int j;
+#pragma omp atomic
+        executed[i]++;
+#pragma omp atomic
+        count++;
+        if (i % 100 == 0) {
+          for (j = 0; j < NUM_CHILDREN; j++) {
+#pragma omp task
+            {
+#pragma omp atomic
+              children++;
+            }
+          }
+#pragma omp taskwait
+        }
+      }
+    }
+  }
+
+  for (i = 0; i < NUM_TASKS; i++) {
+    if (executed[i] != 1) {
+      fprintf(stderr, "task %d executed %d times\n", i, executed[i]);
+      errors++;
+    }
+  }
+  if (count != NUM_TASKS) {
+    fprintf(stderr, "executed %d tasks, expected %d\n", count, NUM_TASKS);
+    errors++;
+  }
+  if (children != NUM_TASKS / 100 * NUM_CHILDREN) {
+    fprintf(stderr, "executed %d child tasks, expected %d\n", children,
+            NUM_TASKS / 100 * NUM_CHILDREN);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,55 @@
+// RUN: %libomp-compile && env KMP_TASK_STEAL_HIER=2 %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_STEAL_HIER=1 OMP_PLACES=threads \
+// RUN:   OMP_PROC_BIND=close %libomp-run
+// RUN: %libomp-compile && env KMP_TASK_STEAL_HIER=4 OMP_PLACES=cores \
+// RUN:   OMP_PROC_BIND=spread KMP_TASK_STEAL_HALF=1 %libomp-run
+// REQUIRES: affinity
+
+// Test hierarchical (topology-aware) victim selection for task stealing:
+// every task must be executed exactly once whatever the places of the
+// threads, including when no other thread shares a locality level.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define NUM_TASKS 10000
+
+int main() {
+  int i, r, errors = 0;
+  static int executed[NUM_TASKS];
+
+  for (r = 0; r < 3; r++) {
+    int count = 0;
+#pragma omp parallel num_threads(r + 2)
+    {
+#pragma omp for nowait
+      for (i = 0; i < NUM_TASKS; i++) {
+#pragma omp task firstprivate(i)
+        {
+#pragma omp atomic
+          executed[i]++;
+#pragma omp atomic
+          count++;
+        }
+      }
+    }
+    if (count != NUM_TASKS) {
+      fprintf(stderr, "round %d: executed %d tasks, expected %d\n", r, count,
+              NUM_TASKS);
+      errors++;
+    }
+  }
+  for (i = 0; i < NUM_TASKS; i++) {
+    if (executed[i] != 3) {
+      fprintf(stderr, "task %d executed %d times\n", i, executed[i]);
+      errors++;
+    }
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
@@ -0,0 +1,144 @@
+// RUN: %libomp-compile-and-run
+
+// Test task graph record and replay: a DAG of writer and reader tasks is
+// recorded on the first iteration and replayed afterwards. One iteration
+// creates an extra task in the middle of the graph, which must stop the replay
+// (waiting for the tasks replayed so far) and cause the graph to be recorded
+// again. A graph with mutexinoutset dependences is never replayed. Tasks of a
+// region wait for the conflicting sibling tasks created before it.
+
+#include <stdio.h>
+#include <omp.h>
+#include "omp_my_sleep.h"
+
+#define N 64
+#define NREADERS 2
+#define ITERS 20
+#define ODD_ITER 10
+#define OUTER_ITERS 4
+
+int a[N + 1], readers[N], extra, mtx_count, outer_x, outer_y;
+
+int main() {
+  int it, i, r, errors = 0;
+  int replayed[ITERS], mtx_replayed = 0, outer_errors = 0;
+
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  for (it = 0; it < ITERS; it++) {
+    int base = 2 * it;
+    replayed[it] = kmp_taskgraph_begin(1);
+    // writers form a chain: a[i] is updated after a[i - 1]
+    for (i = 0; i < N; i++) {
+#pragma omp task firstprivate(i, base) depend(in : a[i]) depend(inout : a[i + 1])
+      {
+        if (a[i] != (i == 0 ? 0 : base + 1) || a[i + 1] != base) {
+#pragma omp atomic
+          errors++;
+        }
+        a[i + 1] = base + 1;
+      }
+    }
+    if (it == ODD_ITER) {
+#pragma omp task depend(inout : extra)
+      extra++;
+    }
+    // readers of a[i] run after its writer
+    for (i = 0; i < N; i++) {
+      for (r = 0; r < NREADERS; r++) {
+#pragma omp task firstprivate(i, base) depend(in : a[i + 1])
+        {
+          if (a[i + 1] != base + 1) {
+#pragma omp atomic
+            errors++;
+          }
+#pragma omp atomic
+          readers[i]++;
+        }
+      }
+    }
+    // second writers run after all readers of the same element
+    for (i = 0; i < N; i++) {
+#pragma omp task firstprivate(i, base) depend(inout : a[i + 1])
+      {
+        if (readers[i] != NREADERS) {
+#pragma omp atomic
+          errors++;
+        }
+        readers[i] = 0;
+        a[i + 1] = base + 2;
+      }
+    }
+    kmp_taskgraph_end();
+    // the region completes at kmp_taskgraph_end
+    for (i = 0; i < N; i++)
+      if (a[i + 1] != base + 2)
+        errors++;
+  }
+
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  for (it = 0; it < 4; it++) {
+    mtx_replayed += kmp_taskgraph_begin(2);
+    for (i = 0; i < 8; i++) {
+#pragma omp task depend(mutexinoutset : mtx_count)
+      mtx_count++;
+    }
+    kmp_taskgraph_end();
+  }
+
+  // the writer of outer_x is created outside of the region and runs late
+#pragma omp parallel num_threads(4)
+#pragma omp single
+  for (it = 0; it < OUTER_ITERS; it++) {
+#pragma omp task firstprivate(it) depend(out : outer_x)
+    {
+      my_sleep(0.05);
+      outer_x = it + 1;
+    }
+    kmp_taskgraph_begin(3);
+#pragma omp task firstprivate(it) depend(in : outer_x) depend(out : outer_y)
+    {
+      if (outer_x != it + 1) {
+#pragma omp atomic
+        outer_errors++;
+      }
+      outer_y = it + 1;
+    }
+#pragma omp task firstprivate(it) depend(in : outer_y)
+    {
+      if (outer_y != it + 1) {
+#pragma omp atomic
+        outer_errors++;
+      }
+    }
+    kmp_taskgraph_end();
+  }
+
+  for (it = 0; it < ITERS; it++) {
+    int expected = !(it == 0 || it == ODD_ITER + 1);
+    if (replayed[it] != expected) {
+      fprintf(stderr, "iteration %d: replayed %d, expected %d\n", it,
+              replayed[it], expected);
+      errors++;
+    }
+  }
+  if (extra != 1 || mtx_count != 32 || mtx_replayed != 0) {
+    fprintf(stderr, "extra %d, mtx_count %d, mtx_replayed %d\n", extra,
+            mtx_count, mtx_replayed);
+    errors++;
+  }
+
+  if (outer_errors) {
+    fprintf(stderr, "%d tasks ran before the writer outside of the region\n",
+            outer_errors);
+    errors++;
+  }
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
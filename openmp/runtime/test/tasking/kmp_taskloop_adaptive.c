@@ -0,0 +1,141 @@
+// RUN: %libomp-compile && env KMP_TASKLOOP_ADAPTIVE=200 %libomp-run
+#include <stdio.h>
+#include <omp.h>
+
+// Test adaptive taskloop grainsize: with no grainsize or num_tasks clause the
+// chunks of later executions of a construct follow the observed iteration
+// cost, cheap loops get fewer tasks than the default and expensive loops more.
+
+#define N 4
+#define RUNS 5
+#define CHEAP_ITERS 4000
+#define COSTLY_ITERS 400
+#define COSTLY_USEC 50
+
+// Compiler-generated code (emulation)
+typedef struct ident {
+    void* dummy;
+} ident_t;
+
+typedef struct shar {
+    int *pcounter;
+    int *pchunks;
+    int usec;
+} *pshareds;
+
+typedef struct task {
+    pshareds shareds;
+    int(* routine)(int,struct task*);
+    int part_id;
+// privates:
+    unsigned long long lb; // library always uses ULONG
+    unsigned long long ub;
+    int st;
+    int last;
+    int i;
+} *ptask, kmp_task_t;
+
+typedef int(* task_entry_t)( int, ptask );
+
+// OpenMP RTL interfaces
+typedef unsigned long long kmp_uint64;
+typedef long long kmp_int64;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void
+__kmpc_taskloop(ident_t *loc, int gtid, kmp_task_t *task, int if_val,
+                kmp_uint64 *lb, kmp_uint64 *ub, kmp_int64 st,
+                int nogroup, int sched, kmp_int64 grainsize, void *task_dup );
+ptask
+__kmpc_omp_task_alloc( ident_t *loc, int gtid, int flags,
+                  size_t sizeof_kmp_task_t, size_t sizeof_shareds,
+                  task_entry_t task_entry );
+void __kmpc_atomic_fixed4_add(void *id_ref, int gtid, int * lhs, int rhs);
+int  __kmpc_global_thread_num(void *id_ref);
+#ifdef __cplusplus
+}
+#endif
+
+// User's code
+int task_entry(int gtid, ptask task)
+{
+    pshareds pshar = task->shareds;
+    __kmpc_atomic_fixed4_add(NULL,gtid,pshar->pchunks,1);
+    for( task->i = task->lb; task->i <= (int)task->ub; task->i += task->st ) {
+        __kmpc_atomic_fixed4_add(NULL,gtid,pshar->pcounter,1);
+        if (pshar->usec) {
+            double end = omp_get_wtime() + pshar->usec * 1e-6;
+            while (omp_get_wtime() < end)
+                ;
+        }
+    }
+    return 0;
+}
+
+// Execute a taskloop without schedule clause, return the number of chunks
+int run_taskloop(task_entry_t entry, int niters, int usec, int *counter)
+{
+    int chunks = 0;
+    *counter = 0;
+    #pragma omp parallel num_threads(N)
+    {
+      #pragma omp master
+      {
+        int gtid = __kmpc_global_thread_num(NULL);
+        ptask task = __kmpc_omp_task_alloc(NULL,gtid,1,sizeof(struct task),
+                                           sizeof(struct shar),entry);
+        pshareds psh = task->shareds;
+        psh->pcounter = counter;
+        psh->pchunks = &chunks;
+        psh->usec = usec;
+        task->lb = 0;
+        task->ub = niters-1;
+        task->st = 1;
+        __kmpc_taskloop(NULL, gtid, task, 1, &task->lb, &task->ub, 1,
+                        0, 0, 0, NULL);
+      } // end master
+    } // end parallel
+    return chunks;
+}
+
+// Distinct task routines, so the two loops are distinct constructs
+int cheap_entry(int gtid, ptask task) { return task_entry(gtid, task); }
+int costly_entry(int gtid, ptask task) { return task_entry(gtid, task); }
+
+int main()
+{
+    int r, counter, first, chunks = 0;
+    omp_set_dynamic(0);
+
+    first = run_taskloop(&cheap_entry, CHEAP_ITERS, 0, &counter);
+    for (r = 0; r < RUNS; ++r) {
+        chunks = run_taskloop(&cheap_entry, CHEAP_ITERS, 0, &counter);
+        if (counter != CHEAP_ITERS) {
+            printf("Error, counter %d != %d\n", counter, CHEAP_ITERS);
+            return 1;
+        }
+    }
+    if (chunks >= first) {
+        printf("Error, cheap loop: %d chunks, first run %d\n", chunks, first);
+        return 1;
+    }
+
+    first = run_taskloop(&costly_entry, COSTLY_ITERS, COSTLY_USEC, &counter);
+    for (r = 0; r < RUNS; ++r) {
+        chunks = run_taskloop(&costly_entry, COSTLY_ITERS, COSTLY_USEC,
+                              &counter);
+        if (counter != COSTLY_ITERS) {
+            printf("Error, counter %d != %d\n", counter, COSTLY_ITERS);
+            return 1;
+        }
+    }
+    if (chunks <= first) {
+        printf("Error, costly loop: %d chunks, first run %d\n", chunks, first);
+        return 1;
+    }
+
+    printf("passed\n");
+    return 0;
+}
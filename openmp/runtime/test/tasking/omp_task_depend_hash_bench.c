@@ -0,0 +1,80 @@
+// RUN: %libomp-compile && %libomp-run
+// RUN: %libomp-compile && env KMP_ENABLE_TASK_THROTTLING=0 %libomp-run
+
+// Benchmark for the dependence hash: measures the rate at which tasks with
+// dependences are created (__kmpc_omp_task_with_deps) as the number of
+// distinct dependence addresses tracked by the parent task grows, and checks
+// that dependences on every address are honored across table resizes. The
+// largest number of addresses (default 256K) can be given as argument, e.g.
+// 2097152 to measure up to 2M addresses.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define MAX_ADDRS (1 << 18)
+#define NUM_PASSES 2
+
+static int run(int *deps, int naddrs, double *rate) {
+  int i, pass, errors = 0;
+  double t;
+
+  for (i = 0; i < naddrs; i++)
+    deps[i] = 0;
+  t = omp_get_wtime();
+#pragma omp parallel num_threads(2)
+#pragma omp single
+  {
+    for (pass = 0; pass < NUM_PASSES; pass++) {
+      for (i = 0; i < naddrs; i++) {
+#pragma omp task firstprivate(i, pass) depend(inout : deps[i])
+        {
+          if (deps[i] != pass)
+#pragma omp atomic
+            errors++;
+          deps[i] = pass + 1;
+        }
+      }
+    }
+  }
+  t = omp_get_wtime() - t;
+  *rate = (double)naddrs * NUM_PASSES / t;
+
+  for (i = 0; i < naddrs; i++)
+    if (deps[i] != NUM_PASSES)
+      errors++;
+  return errors;
+}
+
+int main(int argc, char **argv) {
+  int naddrs, errors = 0;
+  int max_addrs = argc > 1 ? atoi(argv[1]) : MAX_ADDRS;
+  int *deps;
+
+  if (max_addrs < 1 << 10)
+    max_addrs = 1 << 10;
+  deps = (int *)malloc(max_addrs * sizeof(int));
+  for (naddrs = 1 << 10;; naddrs <<= 2) {
+    double rate;
+    int err;
+    if (naddrs > max_addrs)
+      naddrs = max_addrs;
+    err = run(deps, naddrs, &rate);
+    printf("%7d addresses: %10.0f tasks/s\n", naddrs, rate);
+    if (err) {
+      fprintf(stderr, "%d dependence violations with %d addresses\n", err,
+              naddrs);
+      errors += err;
+    }
+    if (naddrs == max_addrs)
+      break;
+  }
+  free(deps);
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
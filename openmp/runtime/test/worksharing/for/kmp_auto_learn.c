@@ -0,0 +1,74 @@
+// RUN: %libomp-compile && env KMP_AUTO_LEARN=1 %libomp-run
+// RUN: %libomp-compile && env KMP_AUTO_LEARN=1 KMP_AUTO_LEARN_REPORT=1 \
+// RUN:   %libomp-run
+
+// Test KMP_AUTO_LEARN: schedule(auto) loops switch between the candidate
+// schedules from one execution to the next while learning and every
+// execution still runs each iteration exactly once.
+
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+
+#define N 4000
+#define NT 4
+#define REPS 40
+
+static int count[N];
+
+// Uneven work in the second half of the iterations
+static void work(int i) {
+  volatile int k;
+  for (k = 0; k < (i < N / 2 ? 1 : 50); ++k)
+    ;
+}
+
+static int check(const char *name, int n, int times) {
+  int i, err = 0;
+  for (i = 0; i < n; ++i) {
+    if (count[i] != times) {
+      if (err++ < 5)
+        printf("%s: iteration %d executed %d times\n", name, i, count[i]);
+    }
+  }
+  memset(count, 0, sizeof(count));
+  return err;
+}
+
+int main() {
+  int rep, err = 0;
+
+  omp_set_dynamic(0);
+  omp_set_schedule(omp_sched_auto, 0);
+  for (rep = 0; rep < REPS; ++rep) {
+    int i, n = rep % 2 ? N : N / 8;
+    long long j;
+#pragma omp parallel num_threads(NT)
+    {
+#pragma omp for schedule(runtime)
+      for (i = 0; i < n; ++i) {
+#pragma omp atomic
+        count[i]++;
+        work(i);
+      }
+#pragma omp for schedule(auto) nowait
+      for (i = n - 1; i >= 0; i -= 2) {
+#pragma omp atomic
+        count[i]++;
+      }
+#pragma omp for schedule(runtime) nowait
+      for (j = 0; j < n; j += 2) {
+#pragma omp atomic
+        count[j]++;
+      }
+    }
+    // each iteration runs once in the first loop and once in one of the others
+    err += check("auto", n, 2);
+  }
+  if (err > 0) {
+    printf("Failed, err = %d\n", err);
+    return 1;
+  }
+  printf("Passed\n");
+  return 0;
+}
@@ -0,0 +1,93 @@
+// RUN: %libomp-compile && env KMP_DYNAMIC_BATCH=8 %libomp-run
+// RUN: %libomp-compile && env KMP_DYNAMIC_BATCH=64 OMP_SCHEDULE=dynamic,3 \
+// RUN:   %libomp-run
+// RUN: %libomp-compile && env KMP_DYNAMIC_BATCH=1024 OMP_SCHEDULE=dynamic \
+// RUN:   %libomp-run
+
+// Test KMP_DYNAMIC_BATCH: dynamic loops whose threads claim several chunks at
+// once still execute every iteration exactly once, in chunk order for each
+// thread, and give the lastprivate value of the last iteration.
+
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+
+#define N 12345
+#define NT 4
+#define REPS 30
+
+static int count[N];
+
+static void work(long long i) {
+  volatile int k;
+  for (k = 0; k < (i % 11 == 0 ? 50 : 1); ++k)
+    ;
+}
+
+static int check(const char *name, int n, int times) {
+  int i, err = 0;
+  for (i = 0; i < n; ++i) {
+    if (count[i] != times) {
+      if (err++ < 5)
+        printf("%s: iteration %d executed %d times\n", name, i, count[i]);
+    }
+  }
+  memset(count, 0, sizeof(count));
+  return err;
+}
+
+int main() {
+  int rep, err = 0;
+
+  omp_set_dynamic(0);
+  for (rep = 0; rep < REPS; ++rep) {
+    int i, last = -1, n = rep % 3 ? N : rep + 1;
+    long long j;
+    unsigned u;
+    int order_err = 0;
+#pragma omp parallel num_threads(NT) reduction(+ : order_err)
+    {
+      int prev = -1;
+#pragma omp for schedule(dynamic, 2) lastprivate(last)
+      for (i = 0; i < n; ++i) {
+#pragma omp atomic
+        count[i]++;
+        work(i);
+        // the chunks of a thread come in increasing order
+        if (i <= prev)
+          order_err++;
+        prev = i;
+        last = i;
+      }
+#pragma omp for schedule(runtime)
+      for (j = n - 1; j >= 0; j -= 2) {
+#pragma omp atomic
+        count[j]++;
+        work(j);
+      }
+#pragma omp for schedule(runtime) nowait
+      for (u = 0; u < (unsigned)n; ++u) {
+        if (u % 2 != (unsigned)(n - 1) % 2) {
+#pragma omp atomic
+          count[u]++;
+        }
+      }
+    }
+    if (last != n - 1) {
+      printf("lastprivate: got %d, expected %d\n", last, n - 1);
+      err++;
+    }
+    if (order_err) {
+      printf("%d chunks out of order\n", order_err);
+      err++;
+    }
+    // each iteration runs once in the first loop and once in one of the others
+    err += check("batch", n, 2);
+  }
+  if (err > 0) {
+    printf("Failed, err = %d\n", err);
+    return 1;
+  }
+  printf("Passed\n");
+  return 0;
+}
@@ -0,0 +1,89 @@
+// RUN: %libomp-compile && env KMP_ORDERED_TICKETS=1 %libomp-run
+// RUN: %libomp-compile && env KMP_ORDERED_TICKETS=1 OMP_SCHEDULE=dynamic,3 \
+// RUN:   %libomp-run
+// RUN: %libomp-compile && env KMP_ORDERED_TICKETS=1 OMP_SCHEDULE=guided,2 \
+// RUN:   KMP_DISP_NUM_BUFFERS=2 %libomp-run
+
+// Test KMP_ORDERED_TICKETS: ordered regions of loops with different schedules
+// still run in iteration order when threads hand the ordered construct over
+// through their ticket slots, including iterations that skip the ordered
+// region, nowait loops sharing the dispatch buffers and nested teams.
+
+#include <stdio.h>
+#include <omp.h>
+
+#define N 2000
+#define NT 6
+#define REPS 20
+
+static int errors = 0;
+
+static void error(const char *what, long long got, long long expected) {
+#pragma omp critical
+  {
+    if (errors++ < 10)
+      printf("%s: got %lld, expected %lld\n", what, got, expected);
+  }
+}
+
+// Runs loops whose ordered regions record the order of the iterations in
+// *next and checks that order
+static void run(int nthreads) {
+  int i, next = 0, next2 = 0;
+  long long j, nextj = N - 1;
+#pragma omp parallel num_threads(nthreads)
+  {
+#pragma omp for schedule(dynamic, 2) ordered
+    for (i = 0; i < N; ++i) {
+#pragma omp ordered
+      {
+        if (i != next)
+          error("dynamic", i, next);
+        next++;
+      }
+    }
+#pragma omp for schedule(runtime) ordered nowait
+    for (j = N - 1; j >= 0; --j) {
+      // every third iteration skips the ordered region
+      if (j % 3 == 0)
+        continue;
+#pragma omp ordered
+      {
+        if (j > nextj)
+          error("runtime", j, nextj);
+        nextj = j - 1;
+      }
+    }
+#pragma omp for schedule(static, 5) ordered nowait
+    for (i = 0; i < N; i += 2) {
+#pragma omp ordered
+      {
+        if (i != next2)
+          error("static", i, next2);
+        next2 += 2;
+      }
+    }
+  }
+  if (next != N)
+    error("dynamic iterations", next, N);
+  if (next2 != N)
+    error("static iterations", next2, N);
+}
+
+int main() {
+  int rep;
+
+  omp_set_dynamic(0);
+  omp_set_max_active_levels(2);
+  for (rep = 0; rep < REPS; ++rep)
+    run(rep % NT + 1);
+#pragma omp parallel num_threads(2)
+  run(3);
+
+  if (errors) {
+    printf("failed\n");
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
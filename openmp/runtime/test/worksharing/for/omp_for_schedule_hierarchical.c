@@ -0,0 +1,91 @@
+// RUN: %libomp-compile && env OMP_SCHEDULE=hierarchical %libomp-run
+// RUN: %libomp-compile && env OMP_SCHEDULE=hierarchical,4 \
+// RUN:   OMP_PROC_BIND=close %libomp-run
+// RUN: %libomp-compile && env OMP_SCHEDULE=hierarchical,3 %libomp-run
+// REQUIRES: hier-sched, affinity
+
+// Test OMP_SCHEDULE=hierarchical: schedule(runtime) loops with layers taken
+// from the machine topology execute every iteration exactly once, for
+// different loop types, strides and numbers of threads.  The kind must be
+// accepted: without hierarchical scheduling support it would be rejected and
+// replaced by the default static schedule.
+
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+
+#define N 10000
+#define REPS 20
+
+static int count[N];
+
+// Uneven work so that the threads and units run out of chunks at different
+// times
+static void work(long long i) {
+  volatile int k;
+  for (k = 0; k < (i % 5 == 0 ? 100 : 1); ++k)
+    ;
+}
+
+static int check(const char *name, int nthreads, int times) {
+  int i, err = 0;
+  for (i = 0; i < N; ++i) {
+    if (count[i] != times) {
+      if (err++ < 5)
+        printf("%s, %d threads: iteration %d executed %d times\n", name,
+               nthreads, i, count[i]);
+    }
+  }
+  memset(count, 0, sizeof(count));
+  return err;
+}
+
+int main() {
+  int rep, err = 0;
+
+  omp_sched_t kind;
+  int chunk;
+
+  omp_set_dynamic(0);
+  // the threads of the hierarchy take dynamic chunks
+  omp_get_schedule(&kind, &chunk);
+  if ((kind & ~omp_sched_monotonic) != omp_sched_dynamic) {
+    printf("Failed, hierarchical schedule not in effect (kind %d)\n",
+           (int)kind);
+    return 1;
+  }
+  for (rep = 0; rep < REPS; ++rep) {
+    int i, nthreads = rep % 8 + 1;
+    long long j;
+    unsigned u;
+#pragma omp parallel num_threads(nthreads)
+    {
+#pragma omp for schedule(runtime)
+      for (i = 0; i < N; ++i) {
+#pragma omp atomic
+        count[i]++;
+        work(i);
+      }
+#pragma omp for schedule(runtime)
+      for (j = N - 1; j >= 0; j -= 3) {
+#pragma omp atomic
+        count[j]++;
+      }
+#pragma omp for schedule(runtime) nowait
+      for (u = 0; u < N; ++u) {
+        if (u % 3 != (N - 1) % 3) {
+#pragma omp atomic
+          count[u]++;
+        }
+      }
+    }
+    // each iteration runs once in the first loop and once in one of the others
+    err += check("hierarchical", nthreads, 2);
+  }
+  if (err > 0) {
+    printf("Failed, err = %d\n", err);
+    return 1;
+  }
+  printf("Passed\n");
+  return 0;
+}
@@ -0,0 +1,81 @@
+// RUN: %libomp-compile
+// RUN: env OMP_SCHEDULE=nonmonotonic:dynamic,2 %libomp-run
+// RUN: env OMP_SCHEDULE=nonmonotonic:dynamic %libomp-run
+
+// The test checks that nonmonotonic:dynamic (static_steal) loops with 64-bit
+// induction variables execute every iteration exactly once when threads
+// steal chunks from each other.
+
+#include <stdio.h>
+#include <string.h>
+#include <omp.h>
+
+#define N 20000
+#define NT 8
+#define REPS 50
+
+static int count[N];
+
+// Uneven work so that threads run out of own chunks at different times
+static void work(long long i) {
+  volatile int k;
+  for (k = 0; k < (i % 7 == 0 ? 200 : 1); ++k)
+    ;
+}
+
+static int check(const char *name, int rep) {
+  int i, err = 0;
+  for (i = 0; i < N; ++i) {
+    if (count[i] != 1) {
+      if (err++ < 5)
+        printf("%s rep %d: iteration %d executed %d times\n", name, rep, i,
+               count[i]);
+    }
+  }
+  memset(count, 0, sizeof(count));
+  return err;
+}
+
+int main() {
+  int rep, err = 0;
+
+  omp_set_dynamic(0);
+  for (rep = 0; rep < REPS; ++rep) {
+    long long i;
+    unsigned long long u;
+#pragma omp parallel num_threads(NT)
+    {
+#pragma omp for schedule(runtime)
+      for (i = 0; i < N; ++i) {
+#pragma omp atomic
+        count[i]++;
+        work(i);
+      }
+    }
+    err += check("signed", rep);
+#pragma omp parallel num_threads(NT)
+    {
+#pragma omp for schedule(runtime) nowait
+      for (u = 0; u < N; ++u) {
+#pragma omp atomic
+        count[u]++;
+        work((long long)u);
+      }
+#pragma omp for schedule(runtime) nowait
+      for (i = N - 1; i >= 0; --i) {
+#pragma omp atomic
+        count[i]++;
+      }
+    }
+    // each iteration runs once in each of the two loops
+    for (i = 0; i < N; ++i)
+      count[i]--;
+    err += check("unsigned", rep);
+  }
+  if (err > 0) {
+    printf("Failed, err = %d\n", err);
+    return 1;
+  }
+  printf("Passed\n");
+  return 0;
+}